@@ -0,0 +1,63 @@
+// Description: unlit shader covering DoColor, DoTransform and DoTexture, features are picked per permutation
+// @keywords USE_TRANSFORM USE_COLOR USE_TEXTURE
+
+cbuffer ConstantBuffer : register(b0)
+{
+    matrix wvp; // World View Projection
+};
+
+#if USE_TEXTURE
+Texture2D textureMap : register(t0);
+SamplerState textureSampler : register(s0);
+#endif
+
+struct VS_INPUT
+{
+    float3 position : POSITION;
+#if USE_COLOR
+    float4 color : COLOR;
+#endif
+#if USE_TEXTURE
+    float2 texCoord : TEXCOORD;
+#endif
+};
+
+struct VS_OUTPUT
+{
+    float4 position : SV_Position;
+#if USE_COLOR
+    float4 color : COLOR;
+#endif
+#if USE_TEXTURE
+    float2 texCoord : TEXCOORD;
+#endif
+};
+
+VS_OUTPUT VS(VS_INPUT input)
+{
+    VS_OUTPUT output;
+#if USE_TRANSFORM
+    output.position = mul(float4(input.position, 1.0f), wvp);
+#else
+    output.position = float4(input.position, 1.0f);
+#endif
+#if USE_COLOR
+    output.color = input.color;
+#endif
+#if USE_TEXTURE
+    output.texCoord = input.texCoord;
+#endif
+    return output;
+}
+
+float4 PS(VS_OUTPUT input) : SV_Target
+{
+    float4 color = 1.0f;
+#if USE_COLOR
+    color *= input.color;
+#endif
+#if USE_TEXTURE
+    color *= textureMap.Sample(textureSampler, input.texCoord);
+#endif
+    return color;
+}
\ No newline at end of file
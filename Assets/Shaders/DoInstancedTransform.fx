@@ -0,0 +1,46 @@
+// Description: instanced version of DoTransform, each instance brings its own world matrix and color
+
+static const uint MaxInstances = 256;
+
+cbuffer TransformBuffer : register(b0)
+{
+    matrix viewProj;
+};
+
+struct InstanceData
+{
+    matrix world;
+    float4 color;
+};
+
+cbuffer InstanceBuffer : register(b1)
+{
+    InstanceData instances[MaxInstances];
+};
+
+struct VS_INPUT
+{
+    float3 position : POSITION;
+    uint instanceId : SV_InstanceID;
+};
+
+struct VS_OUTPUT
+{
+    float4 position : SV_Position;
+    float4 color : COLOR;
+};
+
+VS_OUTPUT VS(VS_INPUT input)
+{
+    InstanceData instance = instances[input.instanceId];
+
+    VS_OUTPUT output;
+    output.position = mul(mul(float4(input.position, 1.0f), instance.world), viewProj);
+    output.color = instance.color;
+    return output;
+}
+
+float4 PS(VS_OUTPUT input) : SV_Target
+{
+    return input.color;
+}
\ No newline at end of file
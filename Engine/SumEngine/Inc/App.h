@@ -8,7 +8,14 @@ namespace SumEngine
 		std::wstring appname = L"AppName";
 		uint32_t winWidth = 1280;
 		uint32_t winHeight = 720;
-		uint32_t maxDrawLines = 100000;
+		uint32_t debugDrawBatchVertices = 12 * 1024;
+		std::filesystem::path shaderCachePath = L"../../Cache/Shaders";
+		std::filesystem::path assetPath = L"../../Assets";
+#if defined(_DEBUG)
+		bool hotReload = true;
+#else
+		bool hotReload = false;
+#endif
 	};
 
 	class App final
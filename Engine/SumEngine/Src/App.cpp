@@ -21,9 +21,14 @@ void App::Run(const AppConfig& config)
 	// init singletons
 	auto handle = myWindow.GetWindowHandle();
 	GraphicsSystem::StaticInitialize(handle, false);
+	ShaderCache::StaticInitialize(config.shaderCachePath);
+	if (config.hotReload)
+	{
+		HotReload::StaticInitialize(config.assetPath);
+	}
 	InputSystem::StaticInitialize(handle);
 	DebugUI::StaticInitialize(handle, false, true);
-	SimpleDraw::StaticInitialize(config.maxDrawLines);
+	SimpleDraw::StaticInitialize(config.debugDrawBatchVertices);
 
 
 	// start state
@@ -53,6 +58,9 @@ void App::Run(const AppConfig& config)
 			mCurrentState->Initialize();
 		}
 
+		// swap in reloaded assets before anything of this frame uses them
+		HotReload::Update();
+
 		float deltaTime = TimeUtil::GetDeltaTime();
 
 #ifdef _DEBUG
@@ -78,6 +86,8 @@ void App::Run(const AppConfig& config)
 	SimpleDraw::StaticTerminate();
 	DebugUI::StaticTerminate();
 	InputSystem::StaticTerminate();
+	HotReload::StaticTerminate();
+	ShaderCache::StaticTerminate();
 	GraphicsSystem::StaticTerminate();
 	
 	myWindow.Terminate();
@@ -3,6 +3,10 @@
 #include "Common.h"
 
 #include "DebugUtil.h"
+#include "FileWatcher.h"
+#include "MappedFile.h"
+#include "ParallelUtil.h"
+#include "Span.h"
 #include "TimeUtil.h"
 #include "Window.h"
 #include "WindowMessageHandler.h"
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace SumEngine::Core
+{
+	// Watches a directory tree on a background thread and reports files that were created or
+	// modified. Editors tend to write a file several times per save, so a change is only reported
+	// once the file has been quiet for SettleTime.
+	class FileWatcher final
+	{
+	public:
+		// called on the watcher thread with the absolute path of the changed file
+		using Callback = std::function<void(const std::filesystem::path& filePath)>;
+
+		static constexpr std::chrono::milliseconds SettleTime{ 100 };
+
+		FileWatcher() = default;
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		bool Initialize(const std::filesystem::path& directory, Callback callback);
+		void Terminate();
+
+		bool IsWatching() const { return mThread.joinable(); }
+
+	private:
+		void Run();
+
+		std::filesystem::path mDirectory;
+		Callback mCallback;
+		std::thread mThread;
+		HANDLE mDirectoryHandle = INVALID_HANDLE_VALUE;
+		HANDLE mStopEvent = nullptr;
+	};
+}
\ No newline at end of file
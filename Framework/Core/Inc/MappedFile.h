@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Span.h"
+
+namespace SumEngine::Core
+{
+	// read only memory mapped view of a file, pages are faulted in by the OS on first touch
+	// so cooked data can be handed to decoders and GPU uploads without staging copies
+	class MappedFile
+	{
+	public:
+		enum class Access
+		{
+			Sequential,	// read front to back once, e.g. a texture upload
+			Random		// sparse lookups, e.g. an archive table of contents
+		};
+
+		MappedFile() = default;
+		~MappedFile();
+
+		// delete copy
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// allow move
+		MappedFile(MappedFile&& rhs) noexcept;
+		MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+		bool Open(const std::filesystem::path& filePath, Access access = Access::Sequential);
+		void Close();
+
+		// asks the OS to start reading the range in the background so the first touch does not stall
+		void Prefetch(size_t offset, size_t size) const;
+		void Prefetch() const { Prefetch(0, mSize); }
+
+		bool IsOpen() const { return mFile != INVALID_HANDLE_VALUE; }
+		size_t GetSize() const { return mSize; }
+		Span<const uint8_t> GetData() const { return { mData, mSize }; }
+
+	private:
+		HANDLE mFile = INVALID_HANDLE_VALUE;
+		HANDLE mMapping = nullptr;
+		const uint8_t* mData = nullptr;
+		size_t mSize = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace SumEngine::Core::ParallelUtil
+{
+	// [begin, end) range of work items handed to a worker
+	using RangeFunc = std::function<void(uint32_t begin, uint32_t end)>;
+
+	uint32_t GetWorkerCount();
+
+	// splits [0, count) into batches of batchSize and runs them across the worker threads,
+	// the calling thread participates and the call returns once every batch is done
+	void ParallelFor(uint32_t count, uint32_t batchSize, const RangeFunc& func);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+namespace SumEngine::Core
+{
+	// non owning view over contiguous memory, mirrors the std::span interface (C++20)
+	// so it can be swapped out once the projects move to a newer standard
+	template<class T>
+	class Span
+	{
+	public:
+		using element_type = T;
+		using value_type = std::remove_cv_t<T>;
+		using iterator = T*;
+
+		constexpr Span() = default;
+		constexpr Span(T* data, size_t size)
+			: mData(data)
+			, mSize(size)
+		{
+		}
+		template<class Container>
+		constexpr Span(Container& container)
+			: mData(std::data(container))
+			, mSize(std::size(container))
+		{
+		}
+		// allow Span<T> -> Span<const T>
+		template<class U, class = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+		constexpr Span(const Span<U>& other)
+			: mData(other.data())
+			, mSize(other.size())
+		{
+		}
+
+		constexpr T* data() const { return mData; }
+		constexpr size_t size() const { return mSize; }
+		constexpr size_t size_bytes() const { return mSize * sizeof(T); }
+		constexpr bool empty() const { return mSize == 0; }
+
+		constexpr T* begin() const { return mData; }
+		constexpr T* end() const { return mData + mSize; }
+
+		constexpr T& operator[](size_t index) const { return mData[index]; }
+		constexpr T& front() const { return mData[0]; }
+		constexpr T& back() const { return mData[mSize - 1]; }
+
+		constexpr Span first(size_t count) const { return { mData, count }; }
+		constexpr Span last(size_t count) const { return { mData + (mSize - count), count }; }
+		constexpr Span subspan(size_t offset, size_t count = SIZE_MAX) const
+		{
+			return { mData + offset, (count == SIZE_MAX) ? mSize - offset : count };
+		}
+
+	private:
+		T* mData = nullptr;
+		size_t mSize = 0;
+	};
+
+	// reinterprets a byte range as an array of U, the caller guarantees size and alignment
+	template<class U>
+	Span<const U> AsSpanOf(Span<const uint8_t> bytes)
+	{
+		return { reinterpret_cast<const U*>(bytes.data()), bytes.size() / sizeof(U) };
+	}
+}
\ No newline at end of file
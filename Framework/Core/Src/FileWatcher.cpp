@@ -0,0 +1,154 @@
+#include "Precompiled.h"
+#include "FileWatcher.h"
+
+#include "DebugUtil.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Core;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr DWORD NotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+	constexpr size_t BufferSize = 64 * 1024;
+}
+
+FileWatcher::~FileWatcher()
+{
+	Terminate();
+}
+
+bool FileWatcher::Initialize(const std::filesystem::path& directory, Callback callback)
+{
+	Terminate();
+
+	std::error_code ec;
+	mDirectory = std::filesystem::absolute(directory, ec);
+	mCallback = std::move(callback);
+
+	mDirectoryHandle = CreateFileW(
+		mDirectory.c_str(),
+		FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		nullptr);
+	if (mDirectoryHandle == INVALID_HANDLE_VALUE)
+	{
+		LOG("FileWatcher: failed to open %ls", mDirectory.c_str());
+		return false;
+	}
+
+	mStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	mThread = std::thread(&FileWatcher::Run, this);
+	return true;
+}
+
+void FileWatcher::Terminate()
+{
+	if (mThread.joinable())
+	{
+		SetEvent(mStopEvent);
+		mThread.join();
+	}
+	if (mStopEvent != nullptr)
+	{
+		CloseHandle(mStopEvent);
+		mStopEvent = nullptr;
+	}
+	if (mDirectoryHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mDirectoryHandle);
+		mDirectoryHandle = INVALID_HANDLE_VALUE;
+	}
+	mCallback = nullptr;
+}
+
+void FileWatcher::Run()
+{
+	OVERLAPPED overlapped{};
+	overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+	// ReadDirectoryChangesW needs a DWORD aligned buffer
+	std::vector<DWORD> buffer(BufferSize / sizeof(DWORD));
+	std::map<std::filesystem::path, Clock::time_point> pending;
+	bool readPending = false;
+
+	while (true)
+	{
+		if (!readPending)
+		{
+			ResetEvent(overlapped.hEvent);
+			if (!ReadDirectoryChangesW(mDirectoryHandle, buffer.data(), BufferSize, TRUE, NotifyFilter, nullptr, &overlapped, nullptr))
+			{
+				LOG("FileWatcher: failed to watch %ls (%u)", mDirectory.c_str(), GetLastError());
+				break;
+			}
+			readPending = true;
+		}
+
+		HANDLE handles[] = { mStopEvent, overlapped.hEvent };
+		const DWORD timeout = pending.empty() ? INFINITE : static_cast<DWORD>(SettleTime.count());
+		const DWORD result = WaitForMultipleObjects(static_cast<DWORD>(std::size(handles)), handles, FALSE, timeout);
+		if (result == WAIT_OBJECT_0 + 1)
+		{
+			readPending = false;
+
+			// zero bytes means the buffer overflowed and the changes were lost
+			DWORD bytes = 0;
+			if (GetOverlappedResult(mDirectoryHandle, &overlapped, &bytes, FALSE) && bytes > 0)
+			{
+				const auto now = Clock::now();
+				const uint8_t* cursor = reinterpret_cast<const uint8_t*>(buffer.data());
+				while (true)
+				{
+					const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+					if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME)
+					{
+						const std::wstring fileName(info->FileName, info->FileNameLength / sizeof(wchar_t));
+						pending[mDirectory / fileName] = now;
+					}
+					if (info->NextEntryOffset == 0)
+					{
+						break;
+					}
+					cursor += info->NextEntryOffset;
+				}
+			}
+		}
+		else if (result != WAIT_TIMEOUT)
+		{
+			// stop requested
+			break;
+		}
+
+		const auto now = Clock::now();
+		for (auto iter = pending.begin(); iter != pending.end();)
+		{
+			if (now - iter->second >= SettleTime)
+			{
+				// the file may be gone or locked by now, that must not throw on this thread
+				std::error_code ec;
+				if (std::filesystem::is_regular_file(iter->first, ec))
+				{
+					mCallback(iter->first);
+				}
+				iter = pending.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	if (readPending)
+	{
+		DWORD bytes = 0;
+		CancelIoEx(mDirectoryHandle, &overlapped);
+		GetOverlappedResult(mDirectoryHandle, &overlapped, &bytes, TRUE);
+	}
+	CloseHandle(overlapped.hEvent);
+}
\ No newline at end of file
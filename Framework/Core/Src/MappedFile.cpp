@@ -0,0 +1,112 @@
+#include "Precompiled.h"
+#include "MappedFile.h"
+
+#include "DebugUtil.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Core;
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+	: mFile(std::exchange(rhs.mFile, INVALID_HANDLE_VALUE))
+	, mMapping(std::exchange(rhs.mMapping, nullptr))
+	, mData(std::exchange(rhs.mData, nullptr))
+	, mSize(std::exchange(rhs.mSize, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		Close();
+		mFile = std::exchange(rhs.mFile, INVALID_HANDLE_VALUE);
+		mMapping = std::exchange(rhs.mMapping, nullptr);
+		mData = std::exchange(rhs.mData, nullptr);
+		mSize = std::exchange(rhs.mSize, 0);
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& filePath, Access access)
+{
+	Close();
+
+	const DWORD accessFlags = (access == Access::Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	mFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | accessFlags, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(mFile, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	// mapping a zero sized file fails, an empty view is still a valid result
+	mSize = static_cast<size_t>(fileSize.QuadPart);
+	if (mSize == 0)
+	{
+		return true;
+	}
+
+	mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	mData = static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mData == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (mData != nullptr)
+	{
+		UnmapViewOfFile(mData);
+		mData = nullptr;
+	}
+	if (mMapping != nullptr)
+	{
+		CloseHandle(mMapping);
+		mMapping = nullptr;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	mSize = 0;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const
+{
+	if (mData == nullptr || offset >= mSize)
+	{
+		return;
+	}
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<uint8_t*>(mData + offset);
+	range.NumberOfBytes = std::min(size, mSize - offset);
+
+	// only a hint, the pages are still faulted in on demand if this fails
+	if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0))
+	{
+		LOG("MappedFile: prefetch failed (%u)", GetLastError());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "Precompiled.h"
+#include "ParallelUtil.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Core;
+
+uint32_t ParallelUtil::GetWorkerCount()
+{
+	static const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+	return workerCount;
+}
+
+void ParallelUtil::ParallelFor(uint32_t count, uint32_t batchSize, const RangeFunc& func)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	batchSize = std::max(batchSize, 1u);
+	const uint32_t batchCount = (count + batchSize - 1) / batchSize;
+	const uint32_t threadCount = std::min(GetWorkerCount(), batchCount);
+	if (threadCount <= 1)
+	{
+		func(0, count);
+		return;
+	}
+
+	std::atomic<uint32_t> nextBatch = 0;
+	auto worker = [&]()
+	{
+		for (uint32_t batch = nextBatch++; batch < batchCount; batch = nextBatch++)
+		{
+			const uint32_t begin = batch * batchSize;
+			const uint32_t end = std::min(begin + batchSize, count);
+			func(begin, end);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (uint32_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
@@ -40,6 +40,7 @@ namespace SumEngine::Graphics
 		// return values
 		const Math::Vector3& GetPosition() const;
 		const Math::Vector3& GetDirection() const;
+		float GetFov() const;
 
 		Math::Matrix4 GetViewMatrix() const;
 		Math::Matrix4 GetProjectionMatrix() const;
@@ -0,0 +1,63 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	// Draw work recorded off the main thread and replayed on it in submission order. While Record
+	// runs, GraphicsSystem::GetContext returns this list's context on the calling thread, so the
+	// usual Bind / Render calls record instead of drawing.
+	//
+	// Deferred mode records into a D3D11 deferred context. Replay mode only stores the work and
+	// runs it on the immediate context in Execute, for devices without deferred contexts and for
+	// capturing in tools that don't follow command lists.
+	//
+	// Recording starts from the render target and viewport bound at Begin, every other state is
+	// at the D3D defaults. Streamed data (DynamicRingBuffer, ConstantBufferRing, SimpleDraw) has
+	// to be written on the main thread before recording, binding it inside a list is fine.
+	class CommandList final
+	{
+	public:
+		enum class Mode
+		{
+			Deferred,
+			Replay
+		};
+
+		using RecordFunc = std::function<void()>;
+
+		CommandList() = default;
+		~CommandList();
+
+		CommandList(const CommandList&) = delete;
+		CommandList& operator=(const CommandList&) = delete;
+
+		// falls back to Replay when the device can't create a deferred context
+		void Initialize(Mode mode = Mode::Deferred);
+		void Terminate();
+
+		// main thread, takes the current render target and viewport
+		void Begin();
+
+		// any thread, one at a time per list. Replay mode keeps func until Execute, so everything
+		// it captures has to live that long.
+		void Record(const RecordFunc& func);
+
+		// main thread, lists run in the order Execute is called on them
+		void Execute();
+
+		Mode GetMode() const { return mMode; }
+		uint32_t GetRecordCount() const { return mRecordCount; }
+
+	private:
+		void ReleaseTargets();
+
+		ID3D11DeviceContext* mDeferredContext = nullptr;
+		ID3D11DeviceContext1* mDeferredContext1 = nullptr;
+		ID3D11RenderTargetView* mRenderTargetView = nullptr;
+		ID3D11DepthStencilView* mDepthStencilView = nullptr;
+		D3D11_VIEWPORT mViewport{};
+		std::vector<RecordFunc> mReplayFuncs;
+		Mode mMode = Mode::Deferred;
+		uint32_t mRecordCount = 0;
+		bool mIsInitialized = false;
+	};
+}
\ No newline at end of file
@@ -20,4 +20,81 @@ namespace SumEngine::Graphics
 	private:
 		ID3D11Buffer* mConstantBuffer = nullptr;
 	};
+
+	// Constant buffer holding one T with a CPU copy of what was last uploaded. Set only marks
+	// the buffer dirty when the bytes differ, and the upload waits for the next bind, so staging
+	// the same view / projection every pass, or several values before a draw, costs one memcmp
+	// each and at most one UpdateSubresource.
+	template<class T>
+	class TypedConstantBuffer final
+	{
+		static_assert(sizeof(T) % 16 == 0, "TypedConstantBuffer: size must be a multiple of 16 bytes, pad the struct");
+		static_assert(alignof(T) <= 16, "TypedConstantBuffer: alignment must not exceed 16 bytes");
+		static_assert(std::is_trivially_copyable_v<T>, "TypedConstantBuffer: data must be trivially copyable");
+
+	public:
+		void Initialize()
+		{
+			mBuffer.Initialize(sizeof(T));
+			mHasData = false;
+			mIsDirty = false;
+			mUploadCount = 0;
+		}
+
+		void Terminate()
+		{
+			mBuffer.Terminate();
+		}
+
+		void Set(const T& data)
+		{
+			if (mHasData && memcmp(&mData, &data, sizeof(T)) == 0)
+			{
+				return;
+			}
+			mData = data;
+			mHasData = true;
+			mIsDirty = true;
+		}
+
+		// Set and upload right away
+		void Update(const T& data)
+		{
+			Set(data);
+			Flush();
+		}
+
+		void Flush()
+		{
+			if (mIsDirty)
+			{
+				mBuffer.Update(&mData);
+				mIsDirty = false;
+				++mUploadCount;
+			}
+		}
+
+		void BindVS(uint32_t slot)
+		{
+			Flush();
+			mBuffer.BindVS(slot);
+		}
+
+		void BindPS(uint32_t slot)
+		{
+			Flush();
+			mBuffer.BindPS(slot);
+		}
+
+		const T& GetData() const { return mData; }
+		bool IsDirty() const { return mIsDirty; }
+		uint32_t GetUploadCount() const { return mUploadCount; }
+
+	private:
+		ConstantBuffer mBuffer;
+		T mData{};
+		bool mHasData = false;
+		bool mIsDirty = false;
+		uint32_t mUploadCount = 0;
+	};
 }
\ No newline at end of file
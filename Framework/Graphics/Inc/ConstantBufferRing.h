@@ -0,0 +1,58 @@
+#pragma once
+
+#include "DynamicRingBuffer.h"
+
+namespace SumEngine::Graphics
+{
+	// Per draw constants bump allocated from one large dynamic buffer and bound by offset, so
+	// thousands of small updates cost a memcpy each instead of a buffer rename. Devices without
+	// D3D11.1 constant buffer offsetting fall back to a few small dynamic buffers that take
+	// turns and are discarded on every write.
+	class ConstantBufferRing final
+	{
+	public:
+		static constexpr uint32_t ConstantAlignment = 256;	// offsets must be multiples of 16 constants
+		static constexpr uint32_t MaxConstantSize = 4096;
+		static constexpr uint32_t FallbackBufferCount = 16;
+
+		// valid for binding until EndFrame, on the fallback path only until
+		// FallbackBufferCount more writes
+		struct Allocation
+		{
+			uint32_t offset = 0;	// into the ring, or the fallback buffer index
+			uint32_t size = 0;		// rounded up to ConstantAlignment
+		};
+
+		ConstantBufferRing() = default;
+		~ConstantBufferRing();
+
+		ConstantBufferRing(const ConstantBufferRing&) = delete;
+		ConstantBufferRing& operator=(const ConstantBufferRing&) = delete;
+
+		void Initialize(uint32_t capacity);
+		void Terminate();
+
+		void BeginFrame();
+		void EndFrame();
+
+		Allocation Write(const void* data, uint32_t size);
+
+		template<class T>
+		Allocation Write(const T& data)
+		{
+			static_assert(sizeof(T) % 16 == 0, "ConstantBufferRing: constant data must be a multiple of 16 bytes");
+			return Write(&data, sizeof(T));
+		}
+
+		void BindVS(const Allocation& allocation, uint32_t slot) const;
+		void BindPS(const Allocation& allocation, uint32_t slot) const;
+
+		bool IsOffsetBindingSupported() const { return mUseOffsets; }
+
+	private:
+		DynamicRingBuffer mRing;
+		ID3D11Buffer* mFallbackBuffers[FallbackBufferCount] = {};
+		uint32_t mNextFallbackBuffer = 0;
+		bool mUseOffsets = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	class DepthStencilState final
+	{
+	public:
+		static void ClearState();
+
+		enum class Mode
+		{
+			ReadWrite,	// depth test and depth write
+			ReadOnly,	// depth test only, for translucent geometry
+			Disabled	// drawn on top of everything
+		};
+
+		DepthStencilState() = default;
+		~DepthStencilState();
+
+		DepthStencilState(const DepthStencilState&) = delete;
+		DepthStencilState& operator=(const DepthStencilState&) = delete;
+
+		void Initialize(Mode mode);
+		void Terminate();
+
+		void Set();
+
+	private:
+		ID3D11DepthStencilState* mDepthStencilState = nullptr;
+	};
+}
\ No newline at end of file
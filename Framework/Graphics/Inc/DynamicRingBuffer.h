@@ -0,0 +1,72 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "RingAllocator.h"
+
+namespace SumEngine::Graphics
+{
+	// Dynamic vertex, index or constant buffer for data streamed every frame. Writes are mapped
+	// with NO_OVERWRITE, wrapping to the front included. BeginFrame and EndFrame fence each frame
+	// with an event query, so the allocator never hands out space the GPU may still be reading.
+	// Only an overflow, when frames in flight hold the whole ring, maps with DISCARD.
+	class DynamicRingBuffer final
+	{
+	public:
+		enum class Usage
+		{
+			Vertex,
+			Index,
+			Constant	// needs D3D11.1 constant buffer offsetting, see ConstantBufferRing
+		};
+
+		// DISCARD renames the whole buffer, so everything written earlier in the frame is gone
+		// for draws issued after it. Discard is for users that draw right after each Write,
+		// Assert for those that write ahead, e.g. all constants of a frame before its draws.
+		enum class Overflow
+		{
+			Discard,
+			Assert
+		};
+
+		static constexpr uint32_t MaxFramesInFlight = 3;
+
+		DynamicRingBuffer() = default;
+		~DynamicRingBuffer();
+
+		DynamicRingBuffer(const DynamicRingBuffer&) = delete;
+		DynamicRingBuffer& operator=(const DynamicRingBuffer&) = delete;
+
+		void Initialize(Usage usage, uint32_t capacity, Overflow overflow = Overflow::Assert);
+		void Terminate();
+
+		// releases the space of frames the GPU has finished
+		void BeginFrame();
+		void EndFrame();
+
+		// copies size bytes into the ring and returns their offset, a multiple of alignment.
+		// Draw vertices with a start location of offset / vertexSize.
+		uint32_t Write(const void* data, uint32_t size, uint32_t alignment);
+
+		void BindVertices(uint32_t vertexSize) const;
+		void BindIndices(IndexFormat indexFormat) const;
+
+		// size bytes at offset, both multiples of 256 for constant rings
+		void BindConstantsVS(uint32_t slot, uint32_t offset, uint32_t size) const;
+		void BindConstantsPS(uint32_t slot, uint32_t offset, uint32_t size) const;
+
+		uint32_t GetCapacity() const { return mAllocator.GetCapacity(); }
+		uint32_t GetUsedSize() const { return mAllocator.GetUsedSize(); }
+
+		// times the GPU was still on the whole ring and it had to be discarded early
+		uint32_t GetOverflowCount() const { return mOverflowCount; }
+
+	private:
+		ID3D11Buffer* mBuffer = nullptr;
+		ID3D11Query* mFrameQueries[MaxFramesInFlight] = {};
+		RingAllocator mAllocator;
+		uint64_t mFrameFence = 1;		// fence of the frame being recorded
+		uint64_t mCompletedFence = 0;	// last frame the GPU finished
+		uint32_t mOverflowCount = 0;
+		Overflow mOverflow = Overflow::Assert;
+	};
+}
\ No newline at end of file
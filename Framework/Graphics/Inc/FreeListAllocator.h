@@ -0,0 +1,34 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	// Allocation policy for sub-ranges of a fixed size buffer, no GPU involved. Free ranges are
+	// kept sorted by offset, Allocate takes the smallest one that fits and Free merges a range
+	// back with its free neighbours so the space doesn't splinter.
+	class FreeListAllocator
+	{
+	public:
+		static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+		void Initialize(uint32_t capacity);
+		// no capacity left, Allocate fails until the next Initialize
+		void Terminate();
+
+		// everything free again
+		void Reset();
+
+		// InvalidOffset when no free range is big enough
+		uint32_t Allocate(uint32_t size);
+		void Free(uint32_t offset, uint32_t size);
+
+		uint32_t GetCapacity() const { return mCapacity; }
+		uint32_t GetUsedSize() const { return mUsedSize; }
+		uint32_t GetLargestFreeSize() const;
+		uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(mFreeRanges.size()); }
+
+	private:
+		std::map<uint32_t, uint32_t> mFreeRanges;	// offset -> size
+		uint32_t mCapacity = 0;
+		uint32_t mUsedSize = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	// Planes of the clip volume (0 <= z <= w) of a row vector matrix, normals point inside.
+	// Built from view * proj the planes are in world space, from world * view * proj in object space.
+	class Frustum
+	{
+	public:
+		struct Plane
+		{
+			Math::Vector3 normal;
+			float d = 0.0f;
+		};
+
+		Frustum() = default;
+		explicit Frustum(const Math::Matrix4& matrix);
+
+		// false only when the sphere is fully behind one of the planes
+		bool IsSphereVisible(const Math::Vector3& center, float radius) const;
+
+		const std::array<Plane, 6>& GetPlanes() const { return mPlanes; }
+
+	private:
+		std::array<Plane, 6> mPlanes;
+	};
+}
\ No newline at end of file
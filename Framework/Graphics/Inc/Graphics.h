@@ -5,16 +5,39 @@
 #include "BlendState.h"
 #include "Camera.h"
 #include "Color.h"
+#include "CommandList.h"
 #include "ConstantBuffer.h"
+#include "ConstantBufferRing.h"
 #include "DebugUI.h"
+#include "DepthStencilState.h"
+#include "DynamicRingBuffer.h"
+#include "FreeListAllocator.h"
+#include "Frustum.h"
 #include "GraphicsSystem.h"
+#include "Heightmap.h"
+#include "HotReload.h"
+#include "Image.h"
 #include "MeshBuffer.h"
 #include "MeshBuilder.h"
+#include "MeshFile.h"
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+#include "MeshPool.h"
+#include "MeshSimplifier.h"
 #include "MeshTypes.h"
 #include "PixelShader.h"
 #include "RenderTarget.h"
+#include "RingAllocator.h"
 #include "Sampler.h"
+#include "ShaderArchive.h"
+#include "ShaderArchiveFile.h"
+#include "ShaderCache.h"
+#include "ShaderPermutation.h"
 #include "SimpleDraw.h"
+#include "TangentSpace.h"
+#include "Terrain.h"
 #include "Texture.h"
+#include "TextureFile.h"
+#include "VertexPacking.h"
 #include "VertexShader.h"
 #include "VertexTypes.h"
\ No newline at end of file
@@ -40,13 +40,21 @@ namespace SumEngine::Graphics
 		float GetBackBufferAspectRatio() const;
 
 		ID3D11Device* GetDevice();
+		// the context of the CommandList this thread is recording into, otherwise the immediate one
 		ID3D11DeviceContext* GetContext();
+		// same for the D3D11.1 interface, null when the runtime doesn't have it
+		ID3D11DeviceContext1* GetContext1();
+		ID3D11DeviceContext* GetImmediateContext();
 
 	private:
+		friend class CommandList;
+		static void SetRecordingContext(ID3D11DeviceContext* context, ID3D11DeviceContext1* context1);
+
 		static LRESULT CALLBACK GraphicsSystemMessageHandler(HWND handle, UINT message, WPARAM wparam, LPARAM lParam);
 
 		ID3D11Device* mD3DDevice = nullptr;
 		ID3D11DeviceContext* mImmediateContext = nullptr;
+		ID3D11DeviceContext1* mImmediateContext1 = nullptr;
 
 		IDXGISwapChain* mSwapChain = nullptr;
 		ID3D11RenderTargetView* mRenderTargetView = nullptr;
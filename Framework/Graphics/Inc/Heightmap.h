@@ -0,0 +1,28 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	// Grid of heights in [0, 1] read from the red channel of a greyscale image
+	class Heightmap
+	{
+	public:
+		bool Initialize(const std::filesystem::path& filePath);
+		void Terminate();
+
+		bool IsValid() const { return !mHeights.empty(); }
+
+		uint32_t GetColumns() const { return mColumns; }
+		uint32_t GetRows() const { return mRows; }
+
+		// texel lookup, coordinates are clamped to the edges
+		float GetHeight(int32_t x, int32_t z) const;
+
+		// bilinear lookup, u and v in [0, 1] span the whole map
+		float Sample(float u, float v) const;
+
+	private:
+		std::vector<float> mHeights;
+		uint32_t mColumns = 0;
+		uint32_t mRows = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+// Reloads shaders and textures when their source files change on disk.
+//
+// Resources register a reload function for the files they were built from. When one of those
+// files changes, the reload function runs on a background thread and builds a replacement.
+// The replacement is swapped in by Update() on the main thread at a frame boundary. A reload
+// that fails (e.g. a shader with a syntax error) leaves the current resource untouched.
+
+namespace SumEngine::Graphics::HotReload
+{
+	// runs on the main thread, commit is false when the owner was unregistered while the
+	// reload was in flight, the function then only releases what the reload created
+	using ApplyFunc = std::function<void(bool commit)>;
+
+	// runs on the reload thread, returns an empty function when the reload failed
+	using ReloadFunc = std::function<ApplyFunc()>;
+
+	void StaticInitialize(const std::filesystem::path& watchDirectory);
+	void StaticTerminate();
+
+	// both are no-ops while hot reload is not initialized
+	void Register(const void* owner, const std::vector<std::filesystem::path>& filePaths, ReloadFunc reload);
+	void Unregister(const void* owner);
+
+	// swaps in every resource that finished reloading since the last call
+	void Update();
+}
\ No newline at end of file
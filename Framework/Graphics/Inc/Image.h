@@ -0,0 +1,25 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	// CPU side RGBA8 pixels decoded from an image file (jpg, png, bmp, ...)
+	class Image
+	{
+	public:
+		bool Load(const std::filesystem::path& filePath);
+		void Initialize(uint32_t width, uint32_t height);
+
+		uint32_t GetWidth() const { return mWidth; }
+		uint32_t GetHeight() const { return mHeight; }
+
+		const uint8_t* GetPixels() const { return mPixels.data(); }
+		uint8_t* GetPixels() { return mPixels.data(); }
+
+		const uint8_t* GetPixel(uint32_t x, uint32_t y) const { return &mPixels[(y * mWidth + x) * 4]; }
+
+	private:
+		std::vector<uint8_t> mPixels;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+	};
+}
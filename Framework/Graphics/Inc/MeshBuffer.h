@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MeshTypes.h"
+
 namespace SumEngine::Graphics
 {
 	class MeshBuffer final
@@ -24,25 +26,36 @@ namespace SumEngine::Graphics
 		
 
 		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount);
+		// indices are uploaded in the format they come in. Null indices create a dynamic index buffer
+		// with room for indexCount that UpdateIndices fills, 16 bit when vertexCount allows it
 		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+		void Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount);
+		// cooked .summesh file, see MeshFile.h
+		void Initialize(const std::filesystem::path& filePath);
 		void Terminate();
 
 		void SetTopology(Topology topology);
 
 		void Update(const void* vertices, uint32_t vertexCount);
+		void UpdateIndices(const uint32_t* indices, uint32_t indexCount);
 
 		void Render() const;
+		// per instance data comes from the shader side, indexed by SV_InstanceID
+		void RenderInstanced(uint32_t instanceCount) const;
 
 	private:
 		void CreateVertexBuffer(const void* vertices, uint32_t vertexSize, uint32_t vertexCount);
-		void CreateIndexBuffer(const uint32_t* indices, uint32_t indexCount);
+		void CreateIndexBuffer(const void* indices, uint32_t indexCount, IndexFormat indexFormat);
 
 		ID3D11Buffer* mVertexBuffer = nullptr;
 		ID3D11Buffer* mIndexBuffer = nullptr;
 		D3D11_PRIMITIVE_TOPOLOGY mTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+		DXGI_FORMAT mIndexFormat = DXGI_FORMAT_R32_UINT;
 
-		uint32_t mVertexSize;
-		uint32_t mVertexCount;
-		uint32_t mIndexCount;
+		uint32_t mVertexSize = 0;
+		uint32_t mVertexCount = 0;
+		uint32_t mIndexCount = 0;
+		uint32_t mIndexCapacity = 0;
+		bool mDynamicIndices = false;
 	};
 }
\ No newline at end of file
@@ -7,6 +7,18 @@ namespace SumEngine::Graphics
 	class MeshBuilder
 	{
 	public:
+		struct MeshSize
+		{
+			uint32_t vertexCount = 0;
+			uint32_t indexCount = 0;
+		};
+
+		// Exact output sizes of the grid based meshes. The overloads taking spans write into caller
+		// owned storage of at least this size, large grids are generated across the worker threads.
+		static MeshSize GetPlaneSize(int numRows, int numCols);
+		static MeshSize GetCylinderSize(int slices, int rings);
+		static MeshSize GetSphereSize(int slices, int rings);
+
 		// Cube
 		static MeshPC CreateCubePC(float size);
 		static MeshPX CreateCubePX(float size);
@@ -14,6 +26,7 @@ namespace SumEngine::Graphics
 		// SkyStuff
 		static MeshPX CreateSkyboxPX(float size);
 		static MeshPX CreateSkySpherePX(int slices, int rings, float radius);
+		static void CreateSkySpherePX(int slices, int rings, float radius, Core::Span<VertexPX> vertices, Core::Span<uint32_t> indices);
 
 		// Rectangle
 		static MeshPC CreateRectPC(float width, float length, float height);
@@ -21,12 +34,19 @@ namespace SumEngine::Graphics
 		// Plane
 		static MeshPC CreatePlanePC(int numRows, int numCols, float spacing);
 		static MeshPX CreatePlanePX(int numRows, int numCols, float spacing);
+		static void CreatePlanePC(int numRows, int numCols, float spacing, Core::Span<VertexPC> vertices, Core::Span<uint32_t> indices);
+		static void CreatePlanePX(int numRows, int numCols, float spacing, Core::Span<VertexPX> vertices, Core::Span<uint32_t> indices);
+		static Mesh CreatePlane(int numRows, int numCols, float spacing);
 
 		// Cylinder
 		static MeshPC CreateCylinderPC(int slices, int rings);
+		static void CreateCylinderPC(int slices, int rings, Core::Span<VertexPC> vertices, Core::Span<uint32_t> indices);
 
 		// Sphere
 		static MeshPC CreateSpherePC(int slices, int rings, float radius);
 		static MeshPX CreateSpherePX(int slices, int rings, float radius);
+		static void CreateSpherePC(int slices, int rings, float radius, Core::Span<VertexPC> vertices, Core::Span<uint32_t> indices);
+		static void CreateSpherePX(int slices, int rings, float radius, Core::Span<VertexPX> vertices, Core::Span<uint32_t> indices);
+		static Mesh CreateSphere(int slices, int rings, float radius);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+// Binary mesh container, written by MeshFile::Write and the AssetCooker tool:
+//
+// [Header][vertices][padding][indices]
+//
+// The vertex blob is stored in the layout of the vertex type named by vertexFormat and the
+// index blob is already narrowed to 16 bit when the vertex count allows it. Both start on a
+// DataAlignment boundary, so a mapped file goes to MeshBuffer::Initialize as is.
+
+namespace SumEngine::Graphics::MeshFile
+{
+	constexpr uint32_t Magic = 0x484D4D53;	// 'SMMH'
+	constexpr uint32_t Version = 1;
+	constexpr uint32_t DataAlignment = 16;
+	constexpr const wchar_t* Extension = L".summesh";
+
+	struct Header
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		uint32_t vertexFormat = 0;	// VE_* flags
+		uint32_t vertexSize = 0;
+		uint32_t vertexCount = 0;
+		IndexFormat indexFormat = IndexFormat::UInt16;
+		uint32_t indexCount = 0;
+		uint32_t reserved0 = 0;
+		uint64_t vertexOffset = 0;	// from the start of the file
+		uint64_t indexOffset = 0;
+		Math::Vector3 boundsMin = Math::Vector3::Zero;
+		Math::Vector3 boundsMax = Math::Vector3::Zero;
+		uint32_t reserved1[2] = {};
+	};
+	static_assert(sizeof(Header) % DataAlignment == 0, "MeshFile: header must keep the vertex data aligned");
+
+	inline uint32_t GetIndexSize(IndexFormat indexFormat)
+	{
+		return (indexFormat == IndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	inline uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + DataAlignment - 1) & ~static_cast<uint64_t>(DataAlignment - 1);
+	}
+
+	// cooked file that sits next to the source mesh, e.g. Models/rock.obj -> Models/rock.summesh
+	inline std::filesystem::path GetCookedPath(const std::filesystem::path& sourcePath)
+	{
+		std::filesystem::path cookedPath = sourcePath;
+		return cookedPath.replace_extension(Extension);
+	}
+
+	// header and blob ranges only, cheap enough for every load. Returns nullptr when the
+	// data is usable, otherwise what is wrong with it.
+	const char* CheckHeader(const uint8_t* data, size_t size);
+
+	// CheckHeader plus a scan of the blobs: index ranges and the stored bounds
+	const char* Validate(const uint8_t* data, size_t size);
+
+	// indices are narrowed to 16 bit when vertexCount allows it, bounds come from the
+	// position at the start of every vertex
+	bool Write(const std::filesystem::path& filePath, const void* vertices, uint32_t vertexSize, uint32_t vertexCount, uint32_t vertexFormat, const uint32_t* indices, uint32_t indexCount);
+
+	template<class MeshT>
+	bool Write(const std::filesystem::path& filePath, const MeshT& mesh)
+	{
+		using VertexType = typename MeshT::VertexType;
+		return Write(filePath,
+			mesh.vertices.data(),
+			static_cast<uint32_t>(sizeof(VertexType)),
+			static_cast<uint32_t>(mesh.vertices.size()),
+			VertexType::Format,
+			mesh.indices.data(),
+			static_cast<uint32_t>(mesh.indices.size()));
+	}
+
+	// copies a cooked mesh back into a MeshBase for CPU side work, fails when the
+	// file holds a different vertex type
+	template<class MeshT>
+	bool Read(const std::filesystem::path& filePath, MeshT& mesh)
+	{
+		using VertexType = typename MeshT::VertexType;
+
+		Core::MappedFile file;
+		if (!file.Open(filePath))
+		{
+			return false;
+		}
+
+		const uint8_t* data = file.GetData().data();
+		if (CheckHeader(data, file.GetSize()) != nullptr)
+		{
+			return false;
+		}
+
+		const Header* header = reinterpret_cast<const Header*>(data);
+		if (header->vertexFormat != VertexType::Format || header->vertexSize != sizeof(VertexType))
+		{
+			return false;
+		}
+
+		const VertexType* vertices = reinterpret_cast<const VertexType*>(data + header->vertexOffset);
+		mesh.vertices.assign(vertices, vertices + header->vertexCount);
+		if (header->indexFormat == IndexFormat::UInt16)
+		{
+			const uint16_t* indices = reinterpret_cast<const uint16_t*>(data + header->indexOffset);
+			mesh.indices.assign(indices, indices + header->indexCount);
+		}
+		else
+		{
+			const uint32_t* indices = reinterpret_cast<const uint32_t*>(data + header->indexOffset);
+			mesh.indices.assign(indices, indices + header->indexCount);
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace SumEngine::Graphics
+{
+	struct VertexCacheStats
+	{
+		float acmr = 0.0f;	// vertex shader invocations per triangle (0.5 is ideal on a grid, 3.0 is worst case)
+		float atvr = 0.0f;	// vertex shader invocations per referenced vertex (1.0 is ideal)
+	};
+
+	struct MeshOptimizeReport
+	{
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	struct MeshWeldReport
+	{
+		uint32_t vertexCountBefore = 0;
+		uint32_t vertexCountAfter = 0;
+	};
+
+	// Offline mesh optimizations, meant to run once after building or loading a mesh:
+	// - OptimizeVertexCache reorders triangles (Forsyth) for post transform cache hits
+	// - OptimizeOverdraw splits the result into clusters and draws outward facing clusters first
+	// - OptimizeVertexFetch reorders vertices into first use order for fetch locality
+	// - WeldVertices merges vertices with matching attributes, best run before the others
+	class MeshOptimizer
+	{
+	public:
+		static constexpr uint32_t DefaultCacheSize = 16;
+		static constexpr float DefaultOverdrawThreshold = 1.05f;
+
+		// simulates a FIFO post transform cache of cacheSize entries
+		static VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+
+		static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+		// expects indices already optimized for the vertex cache, threshold is how much worse
+		// than the input the ACMR of a cluster may get in exchange for finer clusters
+		static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Math::Vector3>& positions, float threshold = DefaultOverdrawThreshold);
+
+		// returns the new index of every vertex, vertices no triangle references map to UnusedVertex
+		static constexpr uint32_t UnusedVertex = ~0u;
+		static std::vector<uint32_t> GetVertexFetchRemap(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+		// maps every vertex to a compacted index shared by all vertices whose VE_* attributes match, new indices
+		// are handed out in order of first occurrence. An epsilon of 0 compares exactly, otherwise a vertex joins
+		// the first group whose first vertex has every float component within epsilon and the rest equal.
+		static std::vector<uint32_t> GetWeldRemap(const void* vertices, uint32_t vertexSize, size_t vertexCount, uint32_t vertexFormat, float epsilon, size_t& uniqueCount);
+
+		// a mesh without indices is treated as a triangle list and gets an index buffer
+		template<class MeshT>
+		static MeshWeldReport WeldVertices(MeshT& mesh, float epsilon = 0.0f)
+		{
+			using VertexType = typename MeshT::VertexType;
+
+			MeshWeldReport report;
+			report.vertexCountBefore = static_cast<uint32_t>(mesh.vertices.size());
+			if (mesh.indices.empty())
+			{
+				mesh.indices.resize(mesh.vertices.size());
+				for (size_t i = 0; i < mesh.indices.size(); ++i)
+				{
+					mesh.indices[i] = static_cast<uint32_t>(i);
+				}
+			}
+
+			size_t uniqueCount = 0;
+			const std::vector<uint32_t> remap = GetWeldRemap(mesh.vertices.data(), static_cast<uint32_t>(sizeof(VertexType)), mesh.vertices.size(), VertexType::Format, epsilon, uniqueCount);
+
+			// the first vertex of every group is kept
+			std::vector<VertexType> vertices;
+			vertices.reserve(uniqueCount);
+			for (size_t i = 0; i < remap.size(); ++i)
+			{
+				if (remap[i] == vertices.size())
+				{
+					vertices.push_back(mesh.vertices[i]);
+				}
+			}
+			for (uint32_t& index : mesh.indices)
+			{
+				index = remap[index];
+			}
+			mesh.vertices = std::move(vertices);
+
+			report.vertexCountAfter = static_cast<uint32_t>(mesh.vertices.size());
+			return report;
+		}
+
+		// runs all three stages, unreferenced vertices are dropped
+		template<class MeshT>
+		static MeshOptimizeReport Optimize(MeshT& mesh, float overdrawThreshold = DefaultOverdrawThreshold)
+		{
+			MeshOptimizeReport report;
+			report.before = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+			OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+
+			std::vector<Math::Vector3> positions;
+			positions.reserve(mesh.vertices.size());
+			for (const auto& vertex : mesh.vertices)
+			{
+				positions.push_back(vertex.position);
+			}
+			OptimizeOverdraw(mesh.indices, positions, overdrawThreshold);
+
+			OptimizeVertexFetch(mesh);
+
+			report.after = AnalyzeVertexCache(mesh.indices, mesh.vertices.size());
+			return report;
+		}
+
+		template<class MeshT>
+		static void OptimizeVertexFetch(MeshT& mesh)
+		{
+			const std::vector<uint32_t> remap = GetVertexFetchRemap(mesh.indices, mesh.vertices.size());
+
+			std::vector<typename MeshT::VertexType> vertices;
+			vertices.resize(mesh.vertices.size());
+			size_t usedCount = 0;
+			for (size_t i = 0; i < remap.size(); ++i)
+			{
+				if (remap[i] != UnusedVertex)
+				{
+					vertices[remap[i]] = mesh.vertices[i];
+					usedCount = std::max<size_t>(usedCount, remap[i] + 1);
+				}
+			}
+			vertices.resize(usedCount);
+
+			for (uint32_t& index : mesh.indices)
+			{
+				index = remap[index];
+			}
+			mesh.vertices = std::move(vertices);
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "FreeListAllocator.h"
+#include "MeshTypes.h"
+
+namespace SumEngine::Graphics
+{
+	// Many meshes of one vertex format packed into a shared vertex and index buffer. Bind sets
+	// both buffers once, after that every mesh is a single DrawIndexed at its own base vertex and
+	// start index. Indices stay local to their mesh, so 16 bit pools hold any number of meshes
+	// as long as each one has no more than MaxShortIndexVertexCount vertices.
+	class MeshPool final
+	{
+	public:
+		struct Mesh
+		{
+			uint32_t baseVertex = FreeListAllocator::InvalidOffset;
+			uint32_t vertexCount = 0;
+			uint32_t startIndex = FreeListAllocator::InvalidOffset;
+			uint32_t indexCount = 0;
+
+			bool IsValid() const { return indexCount > 0; }
+		};
+
+		MeshPool() = default;
+		~MeshPool();
+
+		MeshPool(const MeshPool&) = delete;
+		MeshPool& operator=(const MeshPool&) = delete;
+
+		void Initialize(uint32_t vertexSize, uint32_t vertexCapacity, uint32_t indexCapacity, IndexFormat indexFormat = IndexFormat::UInt16);
+		void Terminate();
+
+		// returns an invalid mesh when the pool has no room left, the indices must match the pool's format
+		Mesh Add(const void* vertices, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount);
+		Mesh Add(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+		void Remove(Mesh& mesh);
+
+		template<class MeshType>
+		Mesh Add(const MeshType& mesh)
+		{
+			ASSERT(sizeof(typename MeshType::VertexType) == mVertexSize, "MeshPool: vertex size doesn't match the pool");
+			return Add(mesh.vertices.data(),
+				static_cast<uint32_t>(mesh.vertices.size()),
+				mesh.indices.data(),
+				static_cast<uint32_t>(mesh.indices.size()));
+		}
+
+		// binds the shared buffers, needed again after anything else set the input assembler
+		void Bind() const;
+		void Render(const Mesh& mesh) const;
+
+		uint32_t GetUsedVertexCount() const { return mVertexAllocator.GetUsedSize(); }
+		uint32_t GetUsedIndexCount() const { return mIndexAllocator.GetUsedSize(); }
+		uint32_t GetMeshCount() const { return mMeshCount; }
+
+	private:
+		Mesh Add(const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount);
+
+		FreeListAllocator mVertexAllocator;
+		FreeListAllocator mIndexAllocator;
+		ID3D11Buffer* mVertexBuffer = nullptr;
+		ID3D11Buffer* mIndexBuffer = nullptr;
+		DXGI_FORMAT mIndexFormat = DXGI_FORMAT_R16_UINT;
+		uint32_t mVertexSize = 0;
+		uint32_t mIndexSize = 0;
+		uint32_t mMeshCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "MeshOptimizer.h"
+
+namespace SumEngine::Graphics
+{
+	template<class MeshT>
+	struct MeshLod
+	{
+		MeshT mesh;
+		float error = 0.0f;		// object space distance the surface moved from the full detail mesh
+	};
+
+	// Quadric error metric edge collapse simplification (Garland and Heckbert).
+	//
+	// Vertices collapse onto one of their neighbours, so a simplified mesh only needs new indices.
+	// Open borders only collapse along themselves. A uv or normal seam (two vertices at one
+	// position) collapses both copies together along the seam so the sides stay attached, while
+	// seam ends, corners and non-manifold vertices are locked. This keeps textures and silhouettes intact.
+	class MeshSimplifier
+	{
+	public:
+		// returns indices with at most targetIndexCount entries, or as close as it gets without
+		// exceeding targetError. The error actually reached is written to resultError.
+		static std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<Math::Vector3>& positions, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+		// lod 0 is the input, each following level keeps reduction of the triangles of the previous one.
+		// The chain goes on until a level has minTriangleCount triangles or less, and ends early once
+		// maxError is reached or the mesh stops getting smaller.
+		template<class MeshT>
+		static std::vector<MeshLod<MeshT>> BuildLodChain(const MeshT& mesh, size_t minTriangleCount, float reduction = 0.5f, float maxError = std::numeric_limits<float>::max())
+		{
+			std::vector<Math::Vector3> positions;
+			positions.reserve(mesh.vertices.size());
+			for (const auto& vertex : mesh.vertices)
+			{
+				positions.push_back(vertex.position);
+			}
+
+			std::vector<MeshLod<MeshT>> lods;
+			lods.push_back({ mesh, 0.0f });
+
+			size_t targetTriangleCount = mesh.indices.size() / 3;
+			while (lods.back().mesh.indices.size() / 3 > minTriangleCount)
+			{
+				targetTriangleCount = std::max(static_cast<size_t>(static_cast<float>(targetTriangleCount) * reduction), minTriangleCount);
+				const size_t previousIndexCount = lods.back().mesh.indices.size();
+
+				// always simplify the original so the error is measured against full detail
+				float error = 0.0f;
+				std::vector<uint32_t> indices = Simplify(mesh.indices, positions, targetTriangleCount * 3, maxError, &error);
+				if (indices.empty() || indices.size() >= previousIndexCount)
+				{
+					break;
+				}
+
+				MeshLod<MeshT>& lod = lods.emplace_back();
+				lod.mesh.vertices = mesh.vertices;
+				lod.mesh.indices = std::move(indices);
+				lod.error = error;
+				MeshOptimizer::OptimizeVertexFetch(lod.mesh);
+			}
+			return lods;
+		}
+
+		// pixels covered by one world unit at distance, for a perspective projection
+		static float GetScreenScale(float distance, float fov, float screenHeight)
+		{
+			return screenHeight / (2.0f * tanf(fov * 0.5f) * std::max(distance, 0.0001f));
+		}
+
+		// screen height in pixels of a bounding sphere
+		static float GetProjectedSize(float radius, float distance, float fov, float screenHeight)
+		{
+			return 2.0f * radius * GetScreenScale(distance, fov, screenHeight);
+		}
+
+		// coarsest lod whose error stays under maxPixelError on screen, lodErrors holds MeshLod::error per level
+		static uint32_t SelectLod(const std::vector<float>& lodErrors, float screenScale, float maxPixelError = 1.0f)
+		{
+			uint32_t selected = 0;
+			for (uint32_t i = 1; i < static_cast<uint32_t>(lodErrors.size()); ++i)
+			{
+				if (lodErrors[i] * screenScale > maxPixelError)
+				{
+					break;
+				}
+				selected = i;
+			}
+			return selected;
+		}
+	};
+}
\ No newline at end of file
@@ -4,16 +4,57 @@
 
 namespace SumEngine::Graphics
 {
-	template<class VertexT>
+	enum class IndexFormat : uint32_t
+	{
+		UInt16,
+		UInt32
+	};
+
+	// 16 bit indices address up to 65536 vertices, anything bigger needs 32 bits
+	constexpr uint32_t MaxShortIndexVertexCount = 0xFFFF + 1;
+
+	inline IndexFormat GetIndexFormat(size_t vertexCount)
+	{
+		return (vertexCount <= MaxShortIndexVertexCount) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+	}
+
+	// the index type is part of the mesh, buffers upload the indices as they are.
+	// Meshes are built with 32 bit indices and narrowed once with NarrowIndices.
+	template<class VertexT, class IndexT = uint32_t>
 	struct MeshBase
 	{
 		using VertexType = VertexT;
+		using IndexType = IndexT;
 		std::vector<VertexType> vertices;
-		std::vector<uint32_t> indices;
+		std::vector<IndexType> indices;
+
+		IndexFormat GetIndexFormat() const
+		{
+			return (sizeof(IndexType) == sizeof(uint16_t)) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+		}
 	};
 
+	template<class VertexT>
+	using ShortIndexMesh = MeshBase<VertexT, uint16_t>;
+
+	// 16 bit copy of a mesh with no more than MaxShortIndexVertexCount vertices
+	template<class VertexT>
+	ShortIndexMesh<VertexT> NarrowIndices(const MeshBase<VertexT>& mesh)
+	{
+		ASSERT(mesh.vertices.size() <= MaxShortIndexVertexCount, "MeshBase: %zu vertices need 32 bit indices", mesh.vertices.size());
+		ShortIndexMesh<VertexT> shortMesh;
+		shortMesh.vertices = mesh.vertices;
+		shortMesh.indices.assign(mesh.indices.begin(), mesh.indices.end());
+		return shortMesh;
+	}
+
 	using MeshP = MeshBase<VertexP>;
 	using MeshPC = MeshBase<VertexPC>;
 	using MeshPX = MeshBase<VertexPX>;
 	using Mesh = MeshBase<Vertex>;
+
+	using PackedMeshPC = MeshBase<PackedVertexPC>;
+	using PackedMeshPX = MeshBase<PackedVertexPX>;
+	using PackedMeshPXUNorm = MeshBase<PackedVertexPXUNorm>;
+	using PackedMesh = MeshBase<PackedVertex>;
 }
\ No newline at end of file
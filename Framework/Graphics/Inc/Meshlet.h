@@ -0,0 +1,80 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace SumEngine::Graphics
+{
+	class Camera;
+
+	struct Meshlet
+	{
+		uint32_t vertexOffset = 0;		// first entry in MeshletMesh::vertices
+		uint32_t triangleOffset = 0;	// first triangle in MeshletMesh::triangles, 3 local indices each
+		uint32_t vertexCount = 0;
+		uint32_t triangleCount = 0;
+	};
+
+	struct MeshletBounds
+	{
+		Math::Vector3 center = Math::Vector3::Zero;
+		float radius = 0.0f;
+
+		// every triangle normal is within the cone around coneAxis, a coneCutoff of 1 means the
+		// triangles face too many ways for the cluster to ever be back facing as a whole
+		Math::Vector3 coneAxis = Math::Vector3::ZAxis;
+		float coneCutoff = 1.0f;
+	};
+
+	// mesh split into small clusters, each with its own local vertex list so the triangles
+	// only need 8 bit indices
+	struct MeshletMesh
+	{
+		std::vector<Meshlet> meshlets;
+		std::vector<MeshletBounds> bounds;
+		std::vector<uint32_t> vertices;		// indices into the source mesh vertices
+		std::vector<uint8_t> triangles;		// indices into the meshlet's vertex list
+
+		uint32_t GetTriangleCount() const { return static_cast<uint32_t>(triangles.size() / 3); }
+	};
+
+	struct MeshletCullStats
+	{
+		uint32_t visibleMeshlets = 0;
+		uint32_t frustumCulled = 0;
+		uint32_t backfaceCulled = 0;
+		uint32_t visibleTriangles = 0;
+	};
+
+	// Greedy cluster building: a meshlet grows by the unused triangle that needs the fewest new
+	// vertices among those touching it, so clusters stay compact and their bounds tight.
+	// Feed it indices optimized for the vertex cache (MeshOptimizer) for the best results.
+	class MeshletBuilder
+	{
+	public:
+		static constexpr uint32_t MaxVertices = 64;
+		static constexpr uint32_t MaxTriangles = 124;
+
+		static MeshletMesh Build(const std::vector<uint32_t>& indices, const std::vector<Math::Vector3>& positions);
+
+		template<class MeshT>
+		static MeshletMesh Build(const MeshT& mesh)
+		{
+			std::vector<Math::Vector3> positions;
+			positions.reserve(mesh.vertices.size());
+			for (const auto& vertex : mesh.vertices)
+			{
+				positions.push_back(vertex.position);
+			}
+			return Build(mesh.indices, positions);
+		}
+	};
+
+	// CPU cluster culling against the camera frustum and the meshlet normal cones. The surviving
+	// triangles are written to indices as a plain triangle list over the source mesh vertices,
+	// ready for MeshBuffer::UpdateIndices.
+	class MeshletCuller
+	{
+	public:
+		static MeshletCullStats Cull(const MeshletMesh& mesh, const Math::Matrix4& world, const Camera& camera, std::vector<uint32_t>& indices);
+	};
+}
\ No newline at end of file
@@ -2,10 +2,21 @@
 
 namespace SumEngine::Graphics
 {
+	class ShaderArchive;
+
 	class PixelShader final
 	{
 	public:
-		void Initialize(const std::filesystem::path& filePath);
+		PixelShader() = default;
+
+		// HotReload holds on to the address, so shaders stay where they were initialized
+		PixelShader(const PixelShader&) = delete;
+		PixelShader(PixelShader&&) = delete;
+		PixelShader& operator=(const PixelShader&) = delete;
+		PixelShader& operator=(PixelShader&&) = delete;
+
+		void Initialize(const std::filesystem::path& filePath, uint32_t permutation = 0);
+		void Initialize(const ShaderArchive& archive, uint32_t permutation);
 		void Terminate();
 		void Bind();
 
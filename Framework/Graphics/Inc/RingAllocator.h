@@ -0,0 +1,51 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	// Allocation policy of a ring buffer, no GPU involved. Allocations are appended at the head,
+	// EndFrame tags everything since the last call with a fence value and Release frees the
+	// frames whose fence the GPU has passed, so live data is never handed out twice.
+	class RingAllocator
+	{
+	public:
+		static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+		struct Allocation
+		{
+			uint32_t offset = InvalidOffset;
+			bool wrapped = false;	// restarted at the front of the ring
+		};
+
+		void Initialize(uint32_t capacity);
+
+		// everything free again, e.g. once the whole buffer has been discarded
+		void Reset();
+
+		// offset is a multiple of alignment, which doesn't have to be a power of 2, or
+		// InvalidOffset when the ring has no room left that isn't in flight
+		Allocation Allocate(uint32_t size, uint32_t alignment);
+
+		void EndFrame(uint64_t fence);
+		void Release(uint64_t completedFence);
+
+		uint32_t GetCapacity() const { return mCapacity; }
+		uint32_t GetUsedSize() const { return mUsedSize; }
+		uint32_t GetFrameSize() const { return mFrameSize; }
+		uint32_t GetFramesInFlight() const { return static_cast<uint32_t>(mFrames.size()); }
+
+	private:
+		struct Frame
+		{
+			uint64_t fence = 0;
+			uint32_t end = 0;	// head when the frame ended
+			uint32_t size = 0;	// bytes the frame took, padding included
+		};
+
+		std::deque<Frame> mFrames;	// oldest first
+		uint32_t mCapacity = 0;
+		uint32_t mHead = 0;			// next free byte
+		uint32_t mTail = 0;			// oldest byte still in use
+		uint32_t mUsedSize = 0;
+		uint32_t mFrameSize = 0;	// bytes taken since the last EndFrame
+	};
+}
\ No newline at end of file
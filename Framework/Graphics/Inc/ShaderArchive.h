@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ShaderArchiveFile.h"
+
+namespace SumEngine::Graphics
+{
+	// all precompiled permutations of one shader, cooked offline by the AssetCooker tool.
+	// The archive stays mapped while it is initialized and bytecode is handed out without copies.
+	class ShaderArchive final
+	{
+	public:
+		void Initialize(const std::filesystem::path& filePath);
+		void Terminate();
+
+		bool IsValid() const { return !mEntries.empty(); }
+
+		uint32_t GetPermutation(std::initializer_list<std::string_view> keywords) const;
+		Core::Span<const uint8_t> GetBytecode(ShaderArchiveFile::Stage stage, uint32_t permutation) const;
+
+		const std::vector<std::string>& GetKeywords() const { return mKeywords; }
+
+	private:
+		Core::MappedFile mFile;
+		Core::Span<const ShaderArchiveFile::Entry> mEntries;
+		std::vector<std::string> mKeywords;
+	};
+}
\ No newline at end of file
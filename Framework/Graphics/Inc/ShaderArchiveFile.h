@@ -0,0 +1,56 @@
+#pragma once
+
+// Shader permutation archive written by the AssetCooker tool:
+//
+// [Header][Keyword * keywordCount][Entry * entryCount][padding][bytecode]...
+//
+// Entries are sorted by stage then permutation so a lookup is a binary search, and every
+// bytecode blob starts on a DataAlignment boundary so it can be used straight from a mapping.
+
+namespace SumEngine::Graphics::ShaderArchiveFile
+{
+	constexpr uint32_t Magic = 0x41534D53;	// 'SMSA'
+	constexpr uint32_t Version = 1;
+	constexpr uint32_t DataAlignment = 16;
+	constexpr uint32_t MaxKeywordLength = 32;
+	constexpr const wchar_t* Extension = L".sumfx";
+
+	enum class Stage : uint32_t
+	{
+		Vertex,
+		Pixel
+	};
+
+	struct Header
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		uint32_t keywordCount = 0;
+		uint32_t entryCount = 0;
+	};
+
+	struct Keyword
+	{
+		char name[MaxKeywordLength] = {};
+	};
+
+	struct Entry
+	{
+		Stage stage = Stage::Vertex;
+		uint32_t permutation = 0;
+		uint64_t offset = 0;	// from the start of the file
+		uint64_t size = 0;
+	};
+
+	inline bool operator<(const Entry& lhs, const Entry& rhs)
+	{
+		return std::tie(lhs.stage, lhs.permutation) < std::tie(rhs.stage, rhs.permutation);
+	}
+
+	// archive that sits next to the shader source, e.g. Shaders/DoBasic.fx -> Shaders/DoBasic.sumfx
+	inline std::filesystem::path GetArchivePath(const std::filesystem::path& sourcePath)
+	{
+		std::filesystem::path archivePath = sourcePath;
+		return archivePath.replace_extension(Extension);
+	}
+}
\ No newline at end of file
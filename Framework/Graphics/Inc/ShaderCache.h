@@ -0,0 +1,57 @@
+#pragma once
+
+namespace SumEngine::Graphics
+{
+	struct ShaderDefine
+	{
+		std::string name;
+		std::string value = "1";
+	};
+
+	struct ShaderCompileDesc
+	{
+		std::filesystem::path filePath;
+		std::string entryPoint;
+		std::string profile;
+		std::vector<ShaderDefine> defines;
+		uint32_t permutation = 0;	// keyword mask, see ShaderPermutation.h
+		uint32_t flags = 0;
+	};
+
+	// Persistent cache of compiled shader bytecode. Entries are keyed by a hash of the source
+	// (including quoted #include files), entry point, profile, defines, compile flags and compiler
+	// version, and stored as one file per key. Only a miss goes through D3DCompile.
+	class ShaderCache final
+	{
+	public:
+		static void StaticInitialize(const std::filesystem::path& cacheDirectory);
+		static void StaticTerminate();
+		static ShaderCache* Get();
+
+		// looks the shader up in the cache when it is initialized, otherwise compiles from source
+		static bool Compile(const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode);
+
+		// debug builds keep debug info, release builds get full optimization
+		static uint32_t GetDefaultFlags();
+
+		static uint64_t ComputeKey(Core::Span<const uint8_t> source, const ShaderCompileDesc& desc);
+
+		void Initialize(const std::filesystem::path& cacheDirectory);
+		void Terminate();
+
+		// storage only, no device or compiler needed
+		bool Load(uint64_t key, std::vector<uint8_t>& bytecode) const;
+		bool Store(uint64_t key, Core::Span<const uint8_t> bytecode) const;
+		std::filesystem::path GetEntryPath(uint64_t key) const;
+
+		bool GetBytecode(const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode);
+
+		uint32_t GetHitCount() const { return mHitCount; }
+		uint32_t GetMissCount() const { return mMissCount; }
+
+	private:
+		std::filesystem::path mCacheDirectory;
+		std::atomic<uint32_t> mHitCount = 0;
+		std::atomic<uint32_t> mMissCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ShaderCache.h"
+
+// Shaders opt into permutations by declaring their feature keywords in a comment:
+//
+//   // @keywords USE_TRANSFORM USE_COLOR USE_TEXTURE
+//
+// Bit i of a permutation mask enables keyword i. Every keyword is passed to the compiler as a
+// define set to 1 or 0, so the shader selects features with #if and no runtime branches.
+
+namespace SumEngine::Graphics::ShaderPermutation
+{
+	constexpr uint32_t MaxKeywords = 16;
+
+	std::vector<std::string> ParseKeywords(Core::Span<const uint8_t> source);
+	std::vector<ShaderDefine> GetDefines(const std::vector<std::string>& keywords, uint32_t permutation);
+
+	inline uint32_t GetPermutationCount(const std::vector<std::string>& keywords)
+	{
+		return 1u << static_cast<uint32_t>(keywords.size());
+	}
+
+	// mask for the named keywords, unknown names are ignored
+	uint32_t GetPermutation(const std::vector<std::string>& keywords, std::initializer_list<std::string_view> enabled);
+}
\ No newline at end of file
@@ -6,11 +6,42 @@ namespace SumEngine::Graphics
 {
 	class Camera;
 
+	// Immediate mode debug drawing. The Add functions can be called from any thread, each one
+	// records into its own buffer and Render merges them, so Render must not overlap recording.
+	// Recording grows as needed and Render draws it in batches of batchVertexCount.
+	// Spheres, ovals, cones and AABBs only record a transform and a color, Render draws them
+	// instanced from unit shapes built once per tessellation.
 	namespace SimpleDraw
 	{
-		void StaticInitialize(uint32_t maxVertexCount);
+		struct Stats
+		{
+			uint32_t lineCount = 0;			// drawn by the last Render
+			uint32_t faceCount = 0;
+			uint32_t translucentFaceCount = 0;	// part of faceCount
+			uint32_t peakLineCount = 0;		// high water marks since StaticInitialize
+			uint32_t peakFaceCount = 0;
+			uint32_t droppedLineCount = 0;	// over the per frame limit in the last Render
+			uint32_t droppedFaceCount = 0;
+			uint32_t instanceCount = 0;		// instanced shapes, see below
+			uint32_t peakInstanceCount = 0;
+			uint32_t droppedInstanceCount = 0;
+			uint32_t retainedLineCount = 0;
+			uint32_t retainedFaceCount = 0;
+			uint32_t batchCount = 0;		// draw calls the last Render took
+		};
+
+		enum class Layer
+		{
+			Scene,		// depth tested, faces with alpha below 1 are drawn after the rest back to front
+			Overlay		// on top of everything in submission order
+		};
+
+		void StaticInitialize(uint32_t batchVertexCount);
 		void StaticTerminate();
 
+		// layer for what the calling thread adds from now on, retained geometry is always Scene
+		void SetLayer(Layer layer);
+
 		void AddLine(const Math::Vector3& v0, const Math::Vector3& v1, const Color& color);
 		void AddFace(const Math::Vector3& v0, const Math::Vector3& v1, const Math::Vector3& v2, const Color& color);
 
@@ -34,6 +65,20 @@ namespace SumEngine::Graphics
 
 		void AddTransform(const Math::Matrix4& m);
 
+		// Retained geometry stays on the GPU until it is removed or its lifetime in seconds runs
+		// out, so static overlays are built once. Everything the calling thread adds between
+		// BeginRetained and EndRetained goes into the item instead of the current frame, passing
+		// an id returned earlier replaces that item.
+		using RetainedId = uint32_t;
+		constexpr RetainedId InvalidRetainedId = 0;
+
+		RetainedId BeginRetained(RetainedId id = InvalidRetainedId, float lifetime = 0.0f);
+		void EndRetained();
+		void RemoveRetained(RetainedId id);
+		void ClearRetained();
+
 		void Render(const Camera& camera);
+
+		const Stats& GetStats();
 	}
 }
\ No newline at end of file
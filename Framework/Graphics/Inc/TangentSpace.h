@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+namespace SumEngine::Graphics
+{
+	// Normal and tangent generation for indexed triangle meshes of the full Vertex type.
+	//
+	// Smoothing follows the index buffer, vertices split at a seam keep separate normals, so weld
+	// first (MeshOptimizer::WeldVertices) to smooth across them. Tangents follow the MikkTSpace
+	// rules: face tangents from the uv gradient, projected onto the vertex normal and weighted by
+	// the corner angle. Vertex has no handedness slot, so the shader rebuilds the bitangent as
+	// cross(normal, tangent), which holds for meshes without mirrored uvs.
+	class TangentSpace
+	{
+	public:
+		// area weighted smooth normals
+		static void ComputeNormals(Mesh& mesh);
+
+		// expects normals and uvs, triangles with degenerate uvs don't contribute
+		static void ComputeTangents(Mesh& mesh);
+
+		static void Compute(Mesh& mesh)
+		{
+			ComputeNormals(mesh);
+			ComputeTangents(mesh);
+		}
+	};
+}
\ No newline at end of file
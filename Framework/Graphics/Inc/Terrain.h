@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Heightmap.h"
+#include "VertexTypes.h"
+
+namespace SumEngine::Graphics
+{
+	class Camera;
+
+	// Heightmap terrain split into square chunks of chunkSize quads, centered on the origin.
+	//
+	// Every chunk shares one index buffer holding each LOD in 16 stitching variants. LOD l skips
+	// 2^l vertices, and an edge next to a chunk one LOD coarser snaps its odd vertices onto the
+	// coarser grid so no cracks open. Update picks LODs by distance, keeps neighbours within one
+	// LOD of each other, tests each chunk's bounds against the camera frustum and streams in the
+	// vertex buffers of visible chunks around the viewer. Only visible chunks are drawn.
+	class Terrain final
+	{
+	public:
+		struct Desc
+		{
+			uint32_t chunkSize = 32;			// quads per chunk side, power of two
+			uint32_t lodCount = 4;				// 2^(lodCount - 1) must not exceed chunkSize
+			float cellSize = 1.0f;				// world size of one quad at LOD 0
+			float heightScale = 30.0f;			// world height of a white heightmap texel
+			float lodDistance = 48.0f;			// LOD l is used up to lodDistance * 2^l
+			float residentDistance = 400.0f;	// visible chunks within are loaded, chunks further away release their vertices
+			uint32_t maxLoadsPerFrame = 8;		// chunk vertex buffers created per Update, nearest visible first
+		};
+
+		void Initialize(const std::filesystem::path& heightmapPath, const Desc& desc);
+		void Terminate();
+
+		void Update(const Camera& camera);
+
+		// the caller binds shaders, textures and constants for PackedVertexPXUNorm
+		void Render() const;
+
+		// world height below x, z
+		float GetHeight(float x, float z) const;
+
+		uint32_t GetChunkCount() const { return static_cast<uint32_t>(mChunks.size()); }
+		uint32_t GetResidentChunkCount() const { return mResidentCount; }
+		uint32_t GetVisibleChunkCount() const { return mVisibleCount; }	// resident and inside the frustum, what Render draws
+		uint32_t GetTriangleCount() const { return mTriangleCount; }
+
+	private:
+		struct Chunk
+		{
+			uint32_t column = 0;
+			uint32_t row = 0;
+			Math::Vector3 center;
+			float radius = 0.0f;
+			float distance = 0.0f;
+			uint32_t lod = 0;
+			uint32_t edgeMask = 0;	// edges that border a coarser chunk
+			bool visible = false;	// bounds intersect the frustum of the last Update
+			ID3D11Buffer* vertexBuffer = nullptr;
+		};
+
+		struct IndexRange
+		{
+			uint32_t startIndex = 0;
+			uint32_t indexCount = 0;
+		};
+
+		void CreateIndexBuffer();
+		VertexPX GetGridVertex(uint32_t x, uint32_t z) const;
+		void LoadChunk(Chunk& chunk);
+		void UnloadChunk(Chunk& chunk);
+		void SelectLods();
+
+		Chunk* GetChunk(int32_t column, int32_t row);
+		const IndexRange& GetIndexRange(uint32_t lod, uint32_t edgeMask) const;
+
+		Heightmap mHeightmap;
+		Desc mDesc;
+
+		std::vector<Chunk> mChunks;
+		uint32_t mChunkColumns = 0;
+		uint32_t mChunkRows = 0;
+		float mWidth = 0.0f;
+		float mLength = 0.0f;
+
+		ID3D11Buffer* mIndexBuffer = nullptr;
+		std::vector<IndexRange> mIndexRanges;
+
+		uint32_t mResidentCount = 0;
+		uint32_t mVisibleCount = 0;
+		uint32_t mTriangleCount = 0;
+	};
+}
\ No newline at end of file
@@ -36,6 +36,11 @@ namespace SumEngine::Graphics
 	protected:
 		DXGI_FORMAT GetDXGIFormat(Format format);
 
+		// loads a .sumtex container produced by the AssetCooker tool
+		void InitializeCooked(const std::filesystem::path& fileName);
+		void RegisterHotReload();
+
 		ID3D11ShaderResourceView* mShaderResourceView = nullptr;
+		std::filesystem::path mFileName;
 	};
 }
\ No newline at end of file
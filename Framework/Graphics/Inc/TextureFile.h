@@ -0,0 +1,110 @@
+#pragma once
+
+// Cooked texture container written by the AssetCooker tool:
+//
+// [Header][MipDesc * mipCount][padding][mip 0][mip 1]...[mip n]
+//
+// Every mip is stored in its final GPU layout (block compressed or RGBA8) and starts on a
+// DataAlignment boundary, so the data can be handed to CreateTexture2D as is.
+
+namespace SumEngine::Graphics::TextureFile
+{
+	constexpr uint32_t Magic = 0x54584D53;	// 'SMXT'
+	constexpr uint32_t Version = 1;
+	constexpr uint32_t DataAlignment = 16;
+	constexpr const wchar_t* Extension = L".sumtex";
+
+	enum class Compression : uint32_t
+	{
+		None,	// RGBA8
+		BC1,	// RGB + 1 bit alpha, 4 bpp
+		BC3,	// RGBA, 8 bpp
+		BC5,	// two channels (RG), 8 bpp
+		BC7		// high quality RGBA, 8 bpp
+	};
+
+	struct Header
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		Compression compression = Compression::None;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipCount = 0;
+		uint32_t reserved[2] = {};
+	};
+
+	struct MipDesc
+	{
+		uint64_t offset = 0;	// from the start of the file
+		uint32_t size = 0;
+		uint32_t rowPitch = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	inline bool IsBlockCompressed(Compression compression)
+	{
+		return compression != Compression::None;
+	}
+
+	// bytes per 4x4 block, or per pixel for uncompressed data
+	inline uint32_t GetBlockSize(Compression compression)
+	{
+		switch (compression)
+		{
+		case Compression::BC1: return 8;
+		case Compression::BC3: return 16;
+		case Compression::BC5: return 16;
+		case Compression::BC7: return 16;
+		default: break;
+		}
+		return 4;
+	}
+
+	inline uint32_t GetRowPitch(Compression compression, uint32_t width)
+	{
+		if (IsBlockCompressed(compression))
+		{
+			return std::max(1u, (width + 3) / 4) * GetBlockSize(compression);
+		}
+		return width * GetBlockSize(compression);
+	}
+
+	inline uint32_t GetRowCount(Compression compression, uint32_t height)
+	{
+		return IsBlockCompressed(compression) ? std::max(1u, (height + 3) / 4) : height;
+	}
+
+	inline uint32_t GetMipCount(uint32_t width, uint32_t height)
+	{
+		uint32_t mipCount = 1;
+		while (width > 1 || height > 1)
+		{
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+			++mipCount;
+		}
+		return mipCount;
+	}
+
+	inline DXGI_FORMAT GetDXGIFormat(Compression compression)
+	{
+		switch (compression)
+		{
+		case Compression::BC1: return DXGI_FORMAT_BC1_UNORM;
+		case Compression::BC3: return DXGI_FORMAT_BC3_UNORM;
+		case Compression::BC5: return DXGI_FORMAT_BC5_UNORM;
+		case Compression::BC7: return DXGI_FORMAT_BC7_UNORM;
+		default: break;
+		}
+		return DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	// cooked file that sits next to the source image, e.g. planets/earth.jpg -> planets/earth.sumtex
+	inline std::filesystem::path GetCookedPath(const std::filesystem::path& sourcePath)
+	{
+		std::filesystem::path cookedPath = sourcePath;
+		return cookedPath.replace_extension(Extension);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MeshTypes.h"
+
+// Conversions from the float vertex formats to the packed ones in VertexTypes.h.
+// Packing is lossy, run it once after a mesh is built and optimized.
+
+namespace SumEngine::Graphics::VertexPacking
+{
+	// R8G8B8A8_UNORM, red in the lowest byte
+	uint32_t PackUNorm8(const Color& color);
+	Color UnpackUNorm8(uint32_t packed);
+
+	// IEEE half float, rounds to nearest even
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+
+	uint16_t PackUNorm16(float value);
+	int16_t PackSNorm16(float value);
+
+	// octahedral mapping of a unit vector onto two SNORM16 values
+	void EncodeOctahedral(const Math::Vector3& direction, int16_t encoded[2]);
+	Math::Vector3 DecodeOctahedral(const int16_t encoded[2]);
+
+	// weights are renormalized so the four bytes always add up to exactly 255
+	void PackBoneWeights(const float weights[Vertex::MaxBoneWeights], uint8_t packed[Vertex::MaxBoneWeights]);
+	void PackBoneIndices(const int indices[Vertex::MaxBoneWeights], uint8_t packed[Vertex::MaxBoneWeights]);
+
+	PackedVertexPC Pack(const VertexPC& vertex);
+	PackedVertexPX Pack(const VertexPX& vertex);
+	PackedVertex Pack(const Vertex& vertex);
+	// uvs are clamped to [0, 1]
+	PackedVertexPXUNorm PackUNorm(const VertexPX& vertex);
+
+	// packFunc picks the packed format, Pack by default
+	template<class MeshT, class PackFunc>
+	auto PackMesh(const MeshT& mesh, PackFunc packFunc)
+	{
+		using PackedVertexType = decltype(packFunc(mesh.vertices.front()));
+
+		MeshBase<PackedVertexType, typename MeshT::IndexType> packedMesh;
+		packedMesh.vertices.reserve(mesh.vertices.size());
+		for (const auto& vertex : mesh.vertices)
+		{
+			packedMesh.vertices.push_back(packFunc(vertex));
+		}
+		packedMesh.indices = mesh.indices;
+		return packedMesh;
+	}
+
+	template<class MeshT>
+	auto PackMesh(const MeshT& mesh)
+	{
+		return PackMesh(mesh, [](const auto& vertex) { return Pack(vertex); });
+	}
+}
\ No newline at end of file
@@ -2,15 +2,32 @@
 
 namespace SumEngine::Graphics
 {
+	class ShaderArchive;
+
 	class VertexShader final
 	{
 	public:
+		VertexShader() = default;
+
+		// HotReload holds on to the address, so shaders stay where they were initialized
+		VertexShader(const VertexShader&) = delete;
+		VertexShader(VertexShader&&) = delete;
+		VertexShader& operator=(const VertexShader&) = delete;
+		VertexShader& operator=(VertexShader&&) = delete;
+
 		template<class VertexType>
 		void Initialize(const std::filesystem::path& filePath)
 		{
 			Initialize(filePath, VertexType::Format);
 		}
-		void Initialize(const std::filesystem::path& filePath, uint32_t format);
+		void Initialize(const std::filesystem::path& filePath, uint32_t format, uint32_t permutation = 0);
+
+		template<class VertexType>
+		void Initialize(const ShaderArchive& archive, uint32_t permutation)
+		{
+			Initialize(archive, permutation, VertexType::Format);
+		}
+		void Initialize(const ShaderArchive& archive, uint32_t permutation, uint32_t format);
 		void Terminate();
 
 		void Bind();
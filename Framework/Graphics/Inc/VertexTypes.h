@@ -14,6 +14,16 @@ namespace SumEngine::Graphics
 	constexpr uint32_t VE_BlendIndex	= 0x1 << 5;
 	constexpr uint32_t VE_BlendWeight	= 0x1 << 6;
 
+	// Packed vertex element flags, each one replaces the float version of the same
+	// element and sits in the same place in the vertex
+	constexpr uint32_t VE_ColorUNorm8		= 0x1 << 7;		// R8G8B8A8_UNORM
+	constexpr uint32_t VE_TexCoordHalf		= 0x1 << 8;		// R16G16_FLOAT
+	constexpr uint32_t VE_TexCoordUNorm16	= 0x1 << 9;		// R16G16_UNORM, uv must be in [0, 1]
+	constexpr uint32_t VE_NormalOct			= 0x1 << 10;	// R16G16_SNORM octahedral, decoded in the shader
+	constexpr uint32_t VE_TangentOct		= 0x1 << 11;	// R16G16_SNORM octahedral, decoded in the shader
+	constexpr uint32_t VE_BlendIndexUInt8	= 0x1 << 12;	// R8G8B8A8_UINT
+	constexpr uint32_t VE_BlendWeightUNorm8	= 0x1 << 13;	// R8G8B8A8_UNORM
+
 	#define VERTEX_FORMAT(fmt)\
 		static constexpr uint32_t Format = fmt
 
@@ -49,6 +59,51 @@ namespace SumEngine::Graphics
 		int boneIndices[MaxBoneWeights] = {};
 		float boneWeights[MaxBoneWeights] = {};
 	};
+
+	// Packed versions of the vertices above, see VertexPacking.h for the conversions.
+	// Octahedral normals reach the shader as a float2 in [-1, 1] and decode with:
+	//   float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	//   if (n.z < 0.0f) n.xy = (1.0f - abs(n.yx)) * (n.xy >= 0.0f ? 1.0f : -1.0f);
+	//   n = normalize(n);
+
+	struct PackedVertexPC
+	{
+		VERTEX_FORMAT(VE_Position | VE_ColorUNorm8);
+		SumEngine::Math::Vector3 position;
+		uint32_t color = 0;
+	};
+
+	struct PackedVertexPX
+	{
+		VERTEX_FORMAT(VE_Position | VE_TexCoordHalf);
+		SumEngine::Math::Vector3 position;
+		uint16_t uvCoord[2] = {};
+	};
+
+	// uvs in [0, 1] only (atlases, terrain), with even precision across the range unlike half floats
+	struct PackedVertexPXUNorm
+	{
+		VERTEX_FORMAT(VE_Position | VE_TexCoordUNorm16);
+		SumEngine::Math::Vector3 position;
+		uint16_t uvCoord[2] = {};
+	};
+
+	struct PackedVertex
+	{
+		VERTEX_FORMAT(VE_Position | VE_NormalOct | VE_TangentOct | VE_TexCoordHalf | VE_BlendIndexUInt8 | VE_BlendWeightUNorm8);
+
+		SumEngine::Math::Vector3 position;
+		int16_t normal[2] = {};
+		int16_t tangent[2] = {};
+		uint16_t uvCoord[2] = {};
+		uint8_t boneIndices[Vertex::MaxBoneWeights] = {};
+		uint8_t boneWeights[Vertex::MaxBoneWeights] = {};
+	};
+
+	static_assert(sizeof(PackedVertexPC) == 16, "PackedVertexPC must stay tightly packed");
+	static_assert(sizeof(PackedVertexPX) == 16, "PackedVertexPX must stay tightly packed");
+	static_assert(sizeof(PackedVertexPXUNorm) == 16, "PackedVertexPXUNorm must stay tightly packed");
+	static_assert(sizeof(PackedVertex) == 32, "PackedVertex must stay tightly packed");
 }
 
 
@@ -97,6 +97,11 @@ const Math::Vector3& Camera::GetDirection() const
 	return mDirection;
 }
 
+float Camera::GetFov() const
+{
+	return mFov;
+}
+
 Math::Matrix4 Camera::GetViewMatrix() const
 {
 	const  Math::Vector3 l = mDirection;
@@ -0,0 +1,109 @@
+#include "Precompiled.h"
+#include "CommandList.h"
+
+#include "GraphicsSystem.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+CommandList::~CommandList()
+{
+	ASSERT(!mIsInitialized, "CommandList: Terminate must be called");
+}
+
+void CommandList::Initialize(Mode mode)
+{
+	mMode = mode;
+	if (mMode == Mode::Deferred)
+	{
+		auto device = GraphicsSystem::Get()->GetDevice();
+		HRESULT hr = device->CreateDeferredContext(0, &mDeferredContext);
+		if (FAILED(hr))
+		{
+			mMode = Mode::Replay;
+		}
+		else
+		{
+			mDeferredContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&mDeferredContext1));
+		}
+	}
+	mRecordCount = 0;
+	mIsInitialized = true;
+}
+
+void CommandList::Terminate()
+{
+	ReleaseTargets();
+	mReplayFuncs.clear();
+	SafeRelease(mDeferredContext1);
+	SafeRelease(mDeferredContext);
+	mIsInitialized = false;
+}
+
+void CommandList::Begin()
+{
+	ReleaseTargets();
+	mReplayFuncs.clear();
+	mRecordCount = 0;
+
+	// read here because the immediate context must not be touched from the recording threads
+	auto context = GraphicsSystem::Get()->GetImmediateContext();
+	context->OMGetRenderTargets(1, &mRenderTargetView, &mDepthStencilView);
+	UINT viewportCount = 1;
+	context->RSGetViewports(&viewportCount, &mViewport);
+}
+
+void CommandList::Record(const RecordFunc& func)
+{
+	if (mMode == Mode::Replay)
+	{
+		mReplayFuncs.push_back(func);
+		++mRecordCount;
+		return;
+	}
+
+	if (mRecordCount == 0)
+	{
+		mDeferredContext->OMSetRenderTargets(1, &mRenderTargetView, mDepthStencilView);
+		mDeferredContext->RSSetViewports(1, &mViewport);
+	}
+	GraphicsSystem::SetRecordingContext(mDeferredContext, mDeferredContext1);
+	func();
+	GraphicsSystem::SetRecordingContext(nullptr, nullptr);
+	++mRecordCount;
+}
+
+void CommandList::Execute()
+{
+	if (mMode == Mode::Replay)
+	{
+		// the immediate context still has the Begin targets, unless something between Begin
+		// and Execute changed them
+		for (const RecordFunc& func : mReplayFuncs)
+		{
+			func();
+		}
+		mReplayFuncs.clear();
+	}
+	else if (mRecordCount > 0)
+	{
+		// the deferred context goes back to the defaults for the next Begin, the immediate one
+		// keeps the state the main thread had set
+		ID3D11CommandList* commandList = nullptr;
+		HRESULT hr = mDeferredContext->FinishCommandList(FALSE, &commandList);
+		ASSERT(SUCCEEDED(hr), "CommandList: failed to finish the command list");
+		if (SUCCEEDED(hr))
+		{
+			GraphicsSystem::Get()->GetImmediateContext()->ExecuteCommandList(commandList, TRUE);
+		}
+		SafeRelease(commandList);
+	}
+	ReleaseTargets();
+	mRecordCount = 0;
+}
+
+void CommandList::ReleaseTargets()
+{
+	SafeRelease(mDepthStencilView);
+	SafeRelease(mRenderTargetView);
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "Precompiled.h"
+#include "ConstantBufferRing.h"
+
+#include "GraphicsSystem.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+namespace
+{
+	bool SupportsOffsetBinding(ID3D11Device* device)
+	{
+		// offsets alone aren't enough, NO_OVERWRITE maps of constant buffers are needed too
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+		if (FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+		{
+			return false;
+		}
+		return options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+	}
+}
+
+ConstantBufferRing::~ConstantBufferRing()
+{
+	ASSERT(mFallbackBuffers[0] == nullptr, "ConstantBufferRing: Terminate must be called");
+}
+
+void ConstantBufferRing::Initialize(uint32_t capacity)
+{
+	auto device = GraphicsSystem::Get()->GetDevice();
+	mUseOffsets = SupportsOffsetBinding(device);
+	if (mUseOffsets)
+	{
+		const uint32_t alignedCapacity = (capacity + ConstantAlignment - 1) & ~(ConstantAlignment - 1);
+		mRing.Initialize(DynamicRingBuffer::Usage::Constant, alignedCapacity);
+	}
+
+	// created either way, Terminate checks them and they are only 64KB in total
+	D3D11_BUFFER_DESC desc{};
+	desc.ByteWidth = MaxConstantSize;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	for (ID3D11Buffer*& buffer : mFallbackBuffers)
+	{
+		HRESULT hr = device->CreateBuffer(&desc, nullptr, &buffer);
+		ASSERT(SUCCEEDED(hr), "ConstantBufferRing: failed to create fallback buffer");
+	}
+	mNextFallbackBuffer = 0;
+}
+
+void ConstantBufferRing::Terminate()
+{
+	for (ID3D11Buffer*& buffer : mFallbackBuffers)
+	{
+		SafeRelease(buffer);
+	}
+	if (mUseOffsets)
+	{
+		mRing.Terminate();
+	}
+}
+
+void ConstantBufferRing::BeginFrame()
+{
+	if (mUseOffsets)
+	{
+		mRing.BeginFrame();
+	}
+}
+
+void ConstantBufferRing::EndFrame()
+{
+	if (mUseOffsets)
+	{
+		mRing.EndFrame();
+	}
+}
+
+ConstantBufferRing::Allocation ConstantBufferRing::Write(const void* data, uint32_t size)
+{
+	ASSERT(size > 0 && size <= MaxConstantSize, "ConstantBufferRing: %u bytes of constants, the limit is %u", size, MaxConstantSize);
+
+	Allocation allocation;
+	allocation.size = (size + ConstantAlignment - 1) & ~(ConstantAlignment - 1);
+	if (mUseOffsets)
+	{
+		allocation.offset = mRing.Write(data, size, ConstantAlignment);
+		return allocation;
+	}
+
+	allocation.offset = mNextFallbackBuffer;
+	mNextFallbackBuffer = (mNextFallbackBuffer + 1) % FallbackBufferCount;
+
+	auto context = GraphicsSystem::Get()->GetContext();
+	D3D11_MAPPED_SUBRESOURCE resource;
+	context->Map(mFallbackBuffers[allocation.offset], 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
+	memcpy(resource.pData, data, size);
+	context->Unmap(mFallbackBuffers[allocation.offset], 0);
+	return allocation;
+}
+
+void ConstantBufferRing::BindVS(const Allocation& allocation, uint32_t slot) const
+{
+	if (mUseOffsets)
+	{
+		mRing.BindConstantsVS(slot, allocation.offset, allocation.size);
+		return;
+	}
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->VSSetConstantBuffers(slot, 1, &mFallbackBuffers[allocation.offset]);
+}
+
+void ConstantBufferRing::BindPS(const Allocation& allocation, uint32_t slot) const
+{
+	if (mUseOffsets)
+	{
+		mRing.BindConstantsPS(slot, allocation.offset, allocation.size);
+		return;
+	}
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->PSSetConstantBuffers(slot, 1, &mFallbackBuffers[allocation.offset]);
+}
\ No newline at end of file
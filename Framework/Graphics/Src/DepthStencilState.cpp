@@ -0,0 +1,42 @@
+#include "Precompiled.h"
+#include "DepthStencilState.h"
+
+#include "GraphicsSystem.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+void DepthStencilState::ClearState()
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->OMSetDepthStencilState(nullptr, 0);
+}
+
+DepthStencilState::~DepthStencilState()
+{
+	ASSERT(mDepthStencilState == nullptr, "DepthStencilState: Terminate must be called");
+}
+
+void DepthStencilState::Initialize(Mode mode)
+{
+	D3D11_DEPTH_STENCIL_DESC desc{};
+	desc.DepthEnable = (mode != Mode::Disabled);
+	desc.DepthWriteMask = (mode == Mode::ReadWrite) ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+	desc.DepthFunc = D3D11_COMPARISON_LESS;
+	desc.StencilEnable = FALSE;
+
+	auto device = GraphicsSystem::Get()->GetDevice();
+	HRESULT hr = device->CreateDepthStencilState(&desc, &mDepthStencilState);
+	ASSERT(SUCCEEDED(hr), "DepthStencilState: failed to create depth stencil state");
+}
+
+void DepthStencilState::Terminate()
+{
+	SafeRelease(mDepthStencilState);
+}
+
+void DepthStencilState::Set()
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->OMSetDepthStencilState(mDepthStencilState, 0);
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "Precompiled.h"
+#include "DynamicRingBuffer.h"
+
+#include "GraphicsSystem.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+DynamicRingBuffer::~DynamicRingBuffer()
+{
+	ASSERT(mBuffer == nullptr, "DynamicRingBuffer: Terminate must be called");
+}
+
+void DynamicRingBuffer::Initialize(Usage usage, uint32_t capacity, Overflow overflow)
+{
+	mOverflow = overflow;
+	auto device = GraphicsSystem::Get()->GetDevice();
+
+	D3D11_BUFFER_DESC bufferDesc{};
+	bufferDesc.ByteWidth = capacity;
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	switch (usage)
+	{
+	case Usage::Vertex: bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER; break;
+	case Usage::Index: bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER; break;
+	case Usage::Constant: bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER; break;
+	default:
+		ASSERT(false, "DynamicRingBuffer: invalid usage");
+		break;
+	}
+
+	HRESULT hr = device->CreateBuffer(&bufferDesc, nullptr, &mBuffer);
+	ASSERT(SUCCEEDED(hr), "DynamicRingBuffer: failed to create buffer");
+
+	if (usage == Usage::Constant)
+	{
+		ASSERT(capacity % 256 == 0, "DynamicRingBuffer: constant ring capacity must be a multiple of 256");
+		ASSERT(GraphicsSystem::Get()->GetContext1() != nullptr, "DynamicRingBuffer: constant rings need a D3D11.1 context");
+	}
+
+	D3D11_QUERY_DESC queryDesc{};
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	for (ID3D11Query*& query : mFrameQueries)
+	{
+		hr = device->CreateQuery(&queryDesc, &query);
+		ASSERT(SUCCEEDED(hr), "DynamicRingBuffer: failed to create frame query");
+	}
+
+	mAllocator.Initialize(capacity);
+	mFrameFence = 1;
+	mCompletedFence = 0;
+	mOverflowCount = 0;
+}
+
+void DynamicRingBuffer::Terminate()
+{
+	for (ID3D11Query*& query : mFrameQueries)
+	{
+		SafeRelease(query);
+	}
+	SafeRelease(mBuffer);
+}
+
+void DynamicRingBuffer::BeginFrame()
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	while (mCompletedFence + 1 < mFrameFence)
+	{
+		ID3D11Query* query = mFrameQueries[(mCompletedFence + 1) % MaxFramesInFlight];
+		if (context->GetData(query, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		{
+			break;
+		}
+		++mCompletedFence;
+	}
+	mAllocator.Release(mCompletedFence);
+}
+
+void DynamicRingBuffer::EndFrame()
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+
+	// the query slot is reused every MaxFramesInFlight frames, wait for its last frame first
+	if (mFrameFence > MaxFramesInFlight && mCompletedFence + MaxFramesInFlight < mFrameFence)
+	{
+		ID3D11Query* oldQuery = mFrameQueries[mFrameFence % MaxFramesInFlight];
+		while (context->GetData(oldQuery, nullptr, 0, 0) == S_FALSE)
+		{
+			std::this_thread::yield();
+		}
+		mCompletedFence = mFrameFence - MaxFramesInFlight;
+		mAllocator.Release(mCompletedFence);
+	}
+
+	context->End(mFrameQueries[mFrameFence % MaxFramesInFlight]);
+	mAllocator.EndFrame(mFrameFence);
+	++mFrameFence;
+}
+
+uint32_t DynamicRingBuffer::Write(const void* data, uint32_t size, uint32_t alignment)
+{
+	// NO_OVERWRITE maps and the frame fences belong to the immediate context
+	ASSERT(GraphicsSystem::Get()->GetContext() == GraphicsSystem::Get()->GetImmediateContext(), "DynamicRingBuffer: writes must happen on the main thread, not in a command list");
+	// a wrapped allocation is only handed out once the fences say the front is free, so it
+	// doesn't need a DISCARD either
+	RingAllocator::Allocation allocation = mAllocator.Allocate(size, alignment);
+	D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (allocation.offset == RingAllocator::InvalidOffset)
+	{
+		// D3D11 renames the buffer on DISCARD, draws already issued keep the old contents but
+		// anything written earlier this frame and not drawn yet is lost
+		ASSERT(mOverflow == Overflow::Discard || mAllocator.GetFrameSize() == 0, "DynamicRingBuffer: ring overflowed mid-frame, %u bytes of this frame would be discarded before they are drawn", mAllocator.GetFrameSize());
+		mAllocator.Reset();
+		allocation = mAllocator.Allocate(size, alignment);
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		++mOverflowCount;
+		ASSERT(allocation.offset != RingAllocator::InvalidOffset, "DynamicRingBuffer: %u bytes exceed the capacity of %u", size, mAllocator.GetCapacity());
+	}
+
+	auto context = GraphicsSystem::Get()->GetContext();
+	D3D11_MAPPED_SUBRESOURCE resource;
+	context->Map(mBuffer, 0, mapType, 0, &resource);
+	memcpy(static_cast<uint8_t*>(resource.pData) + allocation.offset, data, size);
+	context->Unmap(mBuffer, 0);
+	return allocation.offset;
+}
+
+void DynamicRingBuffer::BindVertices(uint32_t vertexSize) const
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	UINT stride = vertexSize;
+	UINT offset = 0;
+	context->IASetVertexBuffers(0, 1, &mBuffer, &stride, &offset);
+}
+
+void DynamicRingBuffer::BindIndices(IndexFormat indexFormat) const
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->IASetIndexBuffer(mBuffer, (indexFormat == IndexFormat::UInt16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
+}
+
+void DynamicRingBuffer::BindConstantsVS(uint32_t slot, uint32_t offset, uint32_t size) const
+{
+	// offsets and sizes are counted in 16 byte constants
+	const UINT firstConstant = offset / 16;
+	const UINT constantCount = size / 16;
+	auto context = GraphicsSystem::Get()->GetContext1();
+	context->VSSetConstantBuffers1(slot, 1, &mBuffer, &firstConstant, &constantCount);
+}
+
+void DynamicRingBuffer::BindConstantsPS(uint32_t slot, uint32_t offset, uint32_t size) const
+{
+	const UINT firstConstant = offset / 16;
+	const UINT constantCount = size / 16;
+	auto context = GraphicsSystem::Get()->GetContext1();
+	context->PSSetConstantBuffers1(slot, 1, &mBuffer, &firstConstant, &constantCount);
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "Precompiled.h"
+#include "FreeListAllocator.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+void FreeListAllocator::Initialize(uint32_t capacity)
+{
+	ASSERT(capacity > 0, "FreeListAllocator: capacity must not be 0");
+	mCapacity = capacity;
+	Reset();
+}
+
+void FreeListAllocator::Terminate()
+{
+	mFreeRanges.clear();
+	mCapacity = 0;
+	mUsedSize = 0;
+}
+
+void FreeListAllocator::Reset()
+{
+	mFreeRanges.clear();
+	mFreeRanges.emplace(0, mCapacity);
+	mUsedSize = 0;
+}
+
+uint32_t FreeListAllocator::Allocate(uint32_t size)
+{
+	if (size == 0)
+	{
+		return InvalidOffset;
+	}
+
+	// best fit, pools only see a few hundred meshes so a scan is fine
+	auto best = mFreeRanges.end();
+	for (auto iter = mFreeRanges.begin(); iter != mFreeRanges.end(); ++iter)
+	{
+		if (iter->second >= size && (best == mFreeRanges.end() || iter->second < best->second))
+		{
+			best = iter;
+			if (best->second == size)
+			{
+				break;
+			}
+		}
+	}
+	if (best == mFreeRanges.end())
+	{
+		return InvalidOffset;
+	}
+
+	const uint32_t offset = best->first;
+	const uint32_t remainingSize = best->second - size;
+	mFreeRanges.erase(best);
+	if (remainingSize > 0)
+	{
+		mFreeRanges.emplace(offset + size, remainingSize);
+	}
+	mUsedSize += size;
+	return offset;
+}
+
+void FreeListAllocator::Free(uint32_t offset, uint32_t size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+	ASSERT(offset <= mCapacity && size <= mCapacity - offset, "FreeListAllocator: range %u + %u is out of bounds", offset, size);
+	ASSERT(size <= mUsedSize, "FreeListAllocator: freeing more than is allocated");
+
+	auto next = mFreeRanges.lower_bound(offset);
+	ASSERT(next == mFreeRanges.end() || offset + size <= next->first, "FreeListAllocator: range %u + %u is already free", offset, size);
+
+	uint32_t freeOffset = offset;
+	uint32_t freeSize = size;
+	if (next != mFreeRanges.begin())
+	{
+		auto previous = std::prev(next);
+		ASSERT(previous->first + previous->second <= offset, "FreeListAllocator: range %u + %u is already free", offset, size);
+		if (previous->first + previous->second == offset)
+		{
+			freeOffset = previous->first;
+			freeSize += previous->second;
+			mFreeRanges.erase(previous);
+		}
+	}
+	if (next != mFreeRanges.end() && offset + size == next->first)
+	{
+		freeSize += next->second;
+		mFreeRanges.erase(next);
+	}
+	mFreeRanges.emplace(freeOffset, freeSize);
+	mUsedSize -= size;
+}
+
+uint32_t FreeListAllocator::GetLargestFreeSize() const
+{
+	uint32_t largestSize = 0;
+	for (const auto& [offset, size] : mFreeRanges)
+	{
+		largestSize = std::max(largestSize, size);
+	}
+	return largestSize;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "Precompiled.h"
+#include "Frustum.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+// Gribb and Hartmann, each plane is a sum or difference of the matrix columns
+Frustum::Frustum(const Matrix4& m)
+{
+	const Vector4 column1 = { m._11, m._21, m._31, m._41 };
+	const Vector4 column2 = { m._12, m._22, m._32, m._42 };
+	const Vector4 column3 = { m._13, m._23, m._33, m._43 };
+	const Vector4 column4 = { m._14, m._24, m._34, m._44 };
+	const Vector4 planes[6] =
+	{
+		column4 + column1,
+		column4 - column1,
+		column4 + column2,
+		column4 - column2,
+		column3,
+		column4 - column3
+	};
+
+	for (int i = 0; i < 6; ++i)
+	{
+		const Vector3 normal = { planes[i].x, planes[i].y, planes[i].z };
+		const float length = Magnitude(normal);
+		mPlanes[i] = { normal / length, planes[i].w / length };
+	}
+}
+
+bool Frustum::IsSphereVisible(const Vector3& center, float radius) const
+{
+	for (const Plane& plane : mPlanes)
+	{
+		if (Dot(plane.normal, center) + plane.d < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -9,6 +9,10 @@ namespace
 {
 	std::unique_ptr<GraphicsSystem> sGraphicsSystem;
 	Core::WindowMessageHandler sWindowsMessageHandler;
+
+	// set while a CommandList records on this thread
+	thread_local ID3D11DeviceContext* tRecordingContext = nullptr;
+	thread_local ID3D11DeviceContext1* tRecordingContext1 = nullptr;
 }
 
 LRESULT CALLBACK GraphicsSystem::GraphicsSystemMessageHandler(HWND handle, UINT message, WPARAM wparam, LPARAM lParam)
@@ -98,6 +102,7 @@ void GraphicsSystem::Initialize(HWND window, bool fullscreen)
 	);
 
 	ASSERT(SUCCEEDED(hr), "GraphicsSystem: failed to create device or swap chain");
+	mImmediateContext->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&mImmediateContext1));
 	mSwapChain->GetDesc(&mSwapChainDesc);
 
 	Resize(GetBackBufferWidth(), GetBackBufferHeight());
@@ -113,6 +118,7 @@ void GraphicsSystem::Terminate()
 	SafeRelease(mDepthStencilBuffer);
 	SafeRelease(mRenderTargetView);
 	SafeRelease(mSwapChain);
+	SafeRelease(mImmediateContext1);
 	SafeRelease(mImmediateContext);
 	SafeRelease(mD3DDevice);
 }
@@ -236,7 +242,24 @@ ID3D11Device* GraphicsSystem::GetDevice()
 }
 
 ID3D11DeviceContext* GraphicsSystem::GetContext()
+{
+	return (tRecordingContext != nullptr) ? tRecordingContext : mImmediateContext;
+}
+
+ID3D11DeviceContext1* GraphicsSystem::GetContext1()
+{
+	return (tRecordingContext != nullptr) ? tRecordingContext1 : mImmediateContext1;
+}
+
+ID3D11DeviceContext* GraphicsSystem::GetImmediateContext()
 {
 	return mImmediateContext;
 }
 
+void GraphicsSystem::SetRecordingContext(ID3D11DeviceContext* context, ID3D11DeviceContext1* context1)
+{
+	ASSERT(context == nullptr || tRecordingContext == nullptr, "GraphicsSystem: this thread is already recording a command list");
+	tRecordingContext = context;
+	tRecordingContext1 = context1;
+}
+
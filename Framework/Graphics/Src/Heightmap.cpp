@@ -0,0 +1,58 @@
+#include "Precompiled.h"
+#include "Heightmap.h"
+
+#include "Image.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+bool Heightmap::Initialize(const std::filesystem::path& filePath)
+{
+	Image image;
+	if (!image.Load(filePath))
+	{
+		LOG("Heightmap: failed to load %ls", filePath.c_str());
+		return false;
+	}
+
+	mColumns = image.GetWidth();
+	mRows = image.GetHeight();
+	mHeights.resize(static_cast<size_t>(mColumns) * mRows);
+	for (uint32_t z = 0; z < mRows; ++z)
+	{
+		for (uint32_t x = 0; x < mColumns; ++x)
+		{
+			mHeights[(z * mColumns) + x] = static_cast<float>(image.GetPixel(x, z)[0]) / 255.0f;
+		}
+	}
+	return true;
+}
+
+void Heightmap::Terminate()
+{
+	mHeights.clear();
+	mColumns = 0;
+	mRows = 0;
+}
+
+float Heightmap::GetHeight(int32_t x, int32_t z) const
+{
+	ASSERT(IsValid(), "Heightmap: not initialized");
+	x = Math::Clamp(x, 0, static_cast<int32_t>(mColumns) - 1);
+	z = Math::Clamp(z, 0, static_cast<int32_t>(mRows) - 1);
+	return mHeights[(z * mColumns) + x];
+}
+
+float Heightmap::Sample(float u, float v) const
+{
+	const float x = Math::Clamp(u, 0.0f, 1.0f) * static_cast<float>(mColumns - 1);
+	const float z = Math::Clamp(v, 0.0f, 1.0f) * static_cast<float>(mRows - 1);
+	const int32_t x0 = static_cast<int32_t>(x);
+	const int32_t z0 = static_cast<int32_t>(z);
+	const float tx = x - static_cast<float>(x0);
+	const float tz = z - static_cast<float>(z0);
+
+	const float h0 = Math::Lerp(GetHeight(x0, z0), GetHeight(x0 + 1, z0), tx);
+	const float h1 = Math::Lerp(GetHeight(x0, z0 + 1), GetHeight(x0 + 1, z0 + 1), tx);
+	return Math::Lerp(h0, h1, tz);
+}
\ No newline at end of file
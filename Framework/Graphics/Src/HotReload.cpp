@@ -0,0 +1,243 @@
+#include "Precompiled.h"
+#include "HotReload.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+namespace
+{
+	// paths are compared case insensitive and fully resolved, the same file can be
+	// registered as "../../Assets/x.fx" and reported as "C:\...\Assets\x.fx"
+	std::wstring GetPathKey(const std::filesystem::path& filePath)
+	{
+		std::error_code ec;
+		std::wstring key = std::filesystem::weakly_canonical(filePath, ec).wstring();
+		if (ec)
+		{
+			key = std::filesystem::absolute(filePath, ec).lexically_normal().wstring();
+		}
+		std::transform(key.begin(), key.end(), key.begin(), ::towlower);
+		return key;
+	}
+
+	class HotReloadImpl
+	{
+	public:
+		void Initialize(const std::filesystem::path& watchDirectory);
+		void Terminate();
+
+		void Register(const void* owner, const std::vector<std::filesystem::path>& filePaths, HotReload::ReloadFunc reload);
+		void Unregister(const void* owner);
+
+		void Update();
+
+	private:
+		struct Registration
+		{
+			std::vector<std::wstring> keys;
+			HotReload::ReloadFunc reload;
+			uint32_t generation = 0;
+		};
+
+		struct Job
+		{
+			const void* owner = nullptr;
+			uint32_t generation = 0;
+			HotReload::ReloadFunc reload;
+		};
+
+		struct Result
+		{
+			const void* owner = nullptr;
+			uint32_t generation = 0;
+			HotReload::ApplyFunc apply;
+		};
+
+		void OnFileChanged(const std::filesystem::path& filePath);
+		void RunWorker();
+		bool IsCurrent(const void* owner, uint32_t generation) const;
+
+		Core::FileWatcher mFileWatcher;
+		std::thread mWorker;
+
+		mutable std::mutex mMutex;
+		std::condition_variable mJobSignal;
+		std::unordered_map<const void*, Registration> mRegistrations;
+		std::deque<Job> mJobs;
+		std::vector<Result> mResults;
+		uint32_t mNextGeneration = 0;
+		bool mRunning = false;
+	};
+
+	void HotReloadImpl::Initialize(const std::filesystem::path& watchDirectory)
+	{
+		mRunning = true;
+		mWorker = std::thread(&HotReloadImpl::RunWorker, this);
+
+		const bool watching = mFileWatcher.Initialize(watchDirectory, [this](const std::filesystem::path& filePath)
+		{
+			OnFileChanged(filePath);
+		});
+		ASSERT(watching, "HotReload: failed to watch %ls", watchDirectory.c_str());
+	}
+
+	void HotReloadImpl::Terminate()
+	{
+		mFileWatcher.Terminate();
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRunning = false;
+			mJobs.clear();
+		}
+		mJobSignal.notify_all();
+		if (mWorker.joinable())
+		{
+			mWorker.join();
+		}
+
+		// nothing is left to swap into, only release what finished reloading
+		for (Result& result : mResults)
+		{
+			result.apply(false);
+		}
+		mResults.clear();
+		mRegistrations.clear();
+	}
+
+	void HotReloadImpl::Register(const void* owner, const std::vector<std::filesystem::path>& filePaths, HotReload::ReloadFunc reload)
+	{
+		Registration registration;
+		registration.reload = std::move(reload);
+		for (const std::filesystem::path& filePath : filePaths)
+		{
+			registration.keys.push_back(GetPathKey(filePath));
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		registration.generation = ++mNextGeneration;
+		mRegistrations[owner] = std::move(registration);
+	}
+
+	void HotReloadImpl::Unregister(const void* owner)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mRegistrations.erase(owner);
+	}
+
+	void HotReloadImpl::Update()
+	{
+		std::vector<Result> results;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			results.swap(mResults);
+		}
+
+		// Unregister only happens on this thread, so a result that is current here stays current
+		for (Result& result : results)
+		{
+			const bool commit = IsCurrent(result.owner, result.generation);
+			result.apply(commit);
+		}
+	}
+
+	void HotReloadImpl::OnFileChanged(const std::filesystem::path& filePath)
+	{
+		const std::wstring key = GetPathKey(filePath);
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (const auto& [owner, registration] : mRegistrations)
+		{
+			if (std::find(registration.keys.begin(), registration.keys.end(), key) == registration.keys.end())
+			{
+				continue;
+			}
+
+			// a reload that has not started yet picks up the latest file anyway
+			const void* jobOwner = owner;
+			auto queued = std::find_if(mJobs.begin(), mJobs.end(), [jobOwner](const Job& job) { return job.owner == jobOwner; });
+			if (queued == mJobs.end())
+			{
+				mJobs.push_back({ owner, registration.generation, registration.reload });
+			}
+		}
+		mJobSignal.notify_one();
+	}
+
+	void HotReloadImpl::RunWorker()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (true)
+		{
+			mJobSignal.wait(lock, [this]() { return !mRunning || !mJobs.empty(); });
+			if (!mRunning)
+			{
+				break;
+			}
+
+			Job job = std::move(mJobs.front());
+			mJobs.pop_front();
+
+			lock.unlock();
+			HotReload::ApplyFunc apply = job.reload();
+			lock.lock();
+
+			if (apply)
+			{
+				mResults.push_back({ job.owner, job.generation, std::move(apply) });
+			}
+			else
+			{
+				LOG("HotReload: reload failed, keeping the current resource");
+			}
+		}
+	}
+
+	bool HotReloadImpl::IsCurrent(const void* owner, uint32_t generation) const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto iter = mRegistrations.find(owner);
+		return iter != mRegistrations.end() && iter->second.generation == generation;
+	}
+
+	std::unique_ptr<HotReloadImpl> sInstance;
+}
+
+void HotReload::StaticInitialize(const std::filesystem::path& watchDirectory)
+{
+	ASSERT(sInstance == nullptr, "HotReload: is already initialized");
+	sInstance = std::make_unique<HotReloadImpl>();
+	sInstance->Initialize(watchDirectory);
+}
+
+void HotReload::StaticTerminate()
+{
+	if (sInstance != nullptr)
+	{
+		sInstance->Terminate();
+		sInstance.reset();
+	}
+}
+
+void HotReload::Register(const void* owner, const std::vector<std::filesystem::path>& filePaths, ReloadFunc reload)
+{
+	if (sInstance != nullptr)
+	{
+		sInstance->Register(owner, filePaths, std::move(reload));
+	}
+}
+
+void HotReload::Unregister(const void* owner)
+{
+	if (sInstance != nullptr)
+	{
+		sInstance->Unregister(owner);
+	}
+}
+
+void HotReload::Update()
+{
+	if (sInstance != nullptr)
+	{
+		sInstance->Update();
+	}
+}
\ No newline at end of file
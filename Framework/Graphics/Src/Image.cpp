@@ -0,0 +1,75 @@
+#include "Precompiled.h"
+#include "Image.h"
+
+#include <wincodec.h>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+bool Image::Load(const std::filesystem::path& filePath)
+{
+	// WIC is COM based, tools and worker threads may not have initialized it yet
+	const HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	IWICImagingFactory* factory = nullptr;
+	IWICBitmapDecoder* decoder = nullptr;
+	IWICBitmapFrameDecode* frame = nullptr;
+	IWICFormatConverter* converter = nullptr;
+
+	HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+	if (SUCCEEDED(hr))
+	{
+		hr = factory->CreateDecoderFromFilename(filePath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = decoder->GetFrame(0, &frame);
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = factory->CreateFormatConverter(&converter);
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+	}
+
+	UINT width = 0;
+	UINT height = 0;
+	if (SUCCEEDED(hr))
+	{
+		hr = converter->GetSize(&width, &height);
+	}
+	if (SUCCEEDED(hr))
+	{
+		Initialize(width, height);
+		hr = converter->CopyPixels(nullptr, width * 4, static_cast<UINT>(mPixels.size()), mPixels.data());
+	}
+
+	SafeRelease(converter);
+	SafeRelease(frame);
+	SafeRelease(decoder);
+	SafeRelease(factory);
+
+	if (SUCCEEDED(comResult))
+	{
+		CoUninitialize();
+	}
+
+	if (FAILED(hr))
+	{
+		LOG("Image: failed to load %ls", filePath.c_str());
+		Initialize(0, 0);
+		return false;
+	}
+	return true;
+}
+
+void Image::Initialize(uint32_t width, uint32_t height)
+{
+	mWidth = width;
+	mHeight = height;
+	mPixels.assign(static_cast<size_t>(width) * height * 4, 0);
+}
@@ -2,6 +2,7 @@
 #include "MeshBuffer.h"
 
 #include "GraphicsSystem.h"
+#include "MeshFile.h"
 
 using namespace SumEngine;
 using namespace SumEngine::Graphics;
@@ -14,11 +15,46 @@ void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t
 void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
 {
 	CreateVertexBuffer(vertices, vertexSize, vertexCount);
-	CreateIndexBuffer(indices, indexCount);
+	const IndexFormat indexFormat = (indices == nullptr) ? GetIndexFormat(vertexCount) : IndexFormat::UInt32;
+	CreateIndexBuffer(indices, indexCount, indexFormat);
+}
+
+void MeshBuffer::Initialize(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount)
+{
+	CreateVertexBuffer(vertices, vertexSize, vertexCount);
+	CreateIndexBuffer(indices, indexCount, IndexFormat::UInt16);
+}
+
+void MeshBuffer::Initialize(const std::filesystem::path& filePath)
+{
+	// the blobs are uploaded straight from the mapped pages, no parsing or staging copy
+	Core::MappedFile file;
+	if (!file.Open(filePath))
+	{
+		ASSERT(false, "MeshBuffer: failed to open %ls", filePath.c_str());
+		return;
+	}
+	file.Prefetch();
+
+	const uint8_t* data = file.GetData().data();
+	const char* error = MeshFile::CheckHeader(data, file.GetSize());
+	if (error != nullptr)
+	{
+		ASSERT(false, "MeshBuffer: invalid mesh file %ls, %s", filePath.c_str(), error);
+		return;
+	}
+
+	const MeshFile::Header* header = reinterpret_cast<const MeshFile::Header*>(data);
+	CreateVertexBuffer(data + header->vertexOffset, header->vertexSize, header->vertexCount);
+	if (header->indexCount > 0)
+	{
+		CreateIndexBuffer(data + header->indexOffset, header->indexCount, header->indexFormat);
+	}
 }
 
 void MeshBuffer::Terminate()
 {
+	SafeRelease(mIndexBuffer);
 	SafeRelease(mVertexBuffer);
 }
 
@@ -45,6 +81,34 @@ void MeshBuffer::Update(const void* vertices, uint32_t vertexCount)
 	context->Unmap(mVertexBuffer, 0);
 }
 
+void MeshBuffer::UpdateIndices(const uint32_t* indices, uint32_t indexCount)
+{
+	ASSERT(mDynamicIndices, "MeshBuffer: UpdateIndices needs an index buffer created without indices");
+	ASSERT(indexCount <= mIndexCapacity, "MeshBuffer: %u indices exceed the capacity of %u", indexCount, mIndexCapacity);
+	mIndexCount = indexCount;
+	if (indexCount == 0)
+	{
+		return;
+	}
+
+	auto context = GraphicsSystem::Get()->GetContext();
+	D3D11_MAPPED_SUBRESOURCE resource;
+	context->Map(mIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
+	if (mIndexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		uint16_t* shortIndices = static_cast<uint16_t*>(resource.pData);
+		for (uint32_t i = 0; i < indexCount; ++i)
+		{
+			shortIndices[i] = static_cast<uint16_t>(indices[i]);
+		}
+	}
+	else
+	{
+		memcpy(resource.pData, indices, indexCount * sizeof(uint32_t));
+	}
+	context->Unmap(mIndexBuffer, 0);
+}
+
 void MeshBuffer::Render() const
 {
 	auto context = GraphicsSystem::Get()->GetContext();
@@ -53,7 +117,7 @@ void MeshBuffer::Render() const
 	context->IASetVertexBuffers(0, 1, &mVertexBuffer, &mVertexSize, &offset);
 	if (mIndexBuffer != nullptr)
 	{
-		context->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+		context->IASetIndexBuffer(mIndexBuffer, mIndexFormat, 0);
 		context->DrawIndexed(mIndexCount, 0, 0);
 	}
 	else
@@ -62,6 +126,23 @@ void MeshBuffer::Render() const
 	}
 }
 
+void MeshBuffer::RenderInstanced(uint32_t instanceCount) const
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->IASetPrimitiveTopology(mTopology);
+	UINT offset = 0;
+	context->IASetVertexBuffers(0, 1, &mVertexBuffer, &mVertexSize, &offset);
+	if (mIndexBuffer != nullptr)
+	{
+		context->IASetIndexBuffer(mIndexBuffer, mIndexFormat, 0);
+		context->DrawIndexedInstanced(mIndexCount, instanceCount, 0, 0, 0);
+	}
+	else
+	{
+		context->DrawInstanced(mVertexCount, instanceCount, 0, 0);
+	}
+}
+
 void MeshBuffer::CreateVertexBuffer(const void* vertices, uint32_t vertexSize, uint32_t vertexCount)
 {
 	mVertexSize = vertexSize;
@@ -88,22 +169,35 @@ void MeshBuffer::CreateVertexBuffer(const void* vertices, uint32_t vertexSize, u
 
 }
 
-void MeshBuffer::CreateIndexBuffer(const uint32_t* indices, uint32_t indexCount)
+void MeshBuffer::CreateIndexBuffer(const void* indices, uint32_t indexCount, IndexFormat indexFormat)
 {
 	mIndexCount = indexCount;
+	mIndexCapacity = indexCount;
+	mIndexFormat = (indexFormat == IndexFormat::UInt16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	const uint32_t indexSize = (indexFormat == IndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	// dynamic buffers start out empty and are filled by UpdateIndices
+	const bool isDynamic = (indices == nullptr);
+	mDynamicIndices = isDynamic;
+	if (isDynamic)
+	{
+		mIndexCount = 0;
+	}
+
 	auto device = GraphicsSystem::Get()->GetDevice();
 
 	// Create index buffer
 	D3D11_BUFFER_DESC bufferDesc{};
-	bufferDesc.ByteWidth = static_cast<UINT>(indexCount * sizeof(uint32_t));
-	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.ByteWidth = static_cast<UINT>(indexCount * indexSize);
+	bufferDesc.Usage = (isDynamic) ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
 	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	bufferDesc.MiscFlags = 0;
 	bufferDesc.StructureByteStride = 0;
+	bufferDesc.CPUAccessFlags = (isDynamic) ? D3D11_CPU_ACCESS_WRITE : 0;
 
 	D3D11_SUBRESOURCE_DATA initData{};
 	initData.pSysMem = indices;
 
-	HRESULT hr = device->CreateBuffer(&bufferDesc, &initData, &mIndexBuffer);
+	HRESULT hr = device->CreateBuffer(&bufferDesc, (isDynamic ? nullptr : &initData), &mIndexBuffer);
 	ASSERT(SUCCEEDED(hr), "Failed to create index buffer");
 }
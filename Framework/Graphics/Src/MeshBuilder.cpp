@@ -1,26 +1,49 @@
 #include "Precompiled.h"
 #include "MeshBuilder.h"
 
+#include "TangentSpace.h"
+
 using namespace SumEngine;
 using namespace SumEngine::Graphics;
 
 namespace
 {
+	constexpr Color ColorTable[] = {
+		Colors::Red,
+		Colors::Green,
+		Colors::Blue,
+		Colors::Magenta,
+		Colors::Pink,
+		Colors::Purple,
+		Colors::Yellow,
+		Colors::Orange
+	};
+
 	Color GetNextColor(int& index)
 	{
-		constexpr Color colorTable[] = {
-			Colors::Red,
-			Colors::Green,
-			Colors::Blue,
-			Colors::Magenta,
-			Colors::Pink,
-			Colors::Purple,
-			Colors::Yellow,
-			Colors::Orange
-		};
+		index = (index + 1) % std::size(ColorTable);
+		return ColorTable[index];
+	}
 
-		index = (index + 1) % std::size(colorTable);
-		return colorTable[index];
+	// the color GetNextColor returns after being called offset + 1 times, so rows can be filled in any order
+	Color GetColorAt(int index, uint32_t offset)
+	{
+		return ColorTable[(index + 1 + offset) % std::size(ColorTable)];
+	}
+
+	// rows of small grids are generated on the calling thread, bigger grids are split across the workers
+	constexpr uint32_t MinVerticesPerBatch = 16 * 1024;
+
+	void ForEachRow(uint32_t rowCount, uint32_t verticesPerRow, const std::function<void(uint32_t row)>& func)
+	{
+		const uint32_t batchSize = std::max(MinVerticesPerBatch / std::max(verticesPerRow, 1u), 1u);
+		Core::ParallelUtil::ParallelFor(rowCount, batchSize, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t row = begin; row < end; ++row)
+			{
+				func(row);
+			}
+		});
 	}
 
 	void CreateCubeIndices(std::vector<uint32_t>& indices)
@@ -52,48 +75,103 @@ namespace
 		};
 	}
 
-	void CreatePlaneIndices(std::vector<uint32_t>& indices, int numRows, int numCols)
+	void CreatePlaneIndices(Core::Span<uint32_t> indices, int numRows, int numCols)
 	{
-		for (int r = 0; r < numRows; ++r)
+		ASSERT(indices.size() >= static_cast<size_t>(numRows * numCols * 6), "MeshBuilder: index span is too small");
+		ForEachRow(numRows, numCols, [&](uint32_t r)
 		{
+			uint32_t* rowIndices = &indices[r * numCols * 6];
 			for (int c = 0; c < numCols; ++c)
 			{
-				int i = (r * (numCols + 1)) + c;
+				uint32_t i = (r * (numCols + 1)) + c;
 
 				// triangle 0
-				indices.push_back(i);
-				indices.push_back(i + numCols + 2);
-				indices.push_back(i + 1);
+				*rowIndices++ = i;
+				*rowIndices++ = i + numCols + 2;
+				*rowIndices++ = i + 1;
 
 				// triangle 1
-				indices.push_back(i);
-				indices.push_back(i + numCols + 1);
-				indices.push_back(i + numCols + 2);
+				*rowIndices++ = i;
+				*rowIndices++ = i + numCols + 1;
+				*rowIndices++ = i + numCols + 2;
 			}
-		}
+		});
 	}
 
-	void CreateCapIndices(std::vector<uint32_t>& indices, int slices, int topIndex, int bottomIndex)
+	void CreateCapIndices(Core::Span<uint32_t> indices, int slices, int topIndex, int bottomIndex)
 	{
+		ASSERT(indices.size() >= static_cast<size_t>(slices * 6), "MeshBuilder: index span is too small");
+		uint32_t* capIndices = indices.data();
 		for (int s = 0; s < slices; ++s)
 		{
 			// bottom triangle
-			indices.push_back(bottomIndex);
-			indices.push_back(s);
-			indices.push_back(s + 1);
+			*capIndices++ = bottomIndex;
+			*capIndices++ = s;
+			*capIndices++ = s + 1;
 
 			// top triangle
 			int topRowIndex = topIndex - slices - 1 + s;
-			indices.push_back(topIndex);
-			indices.push_back(topRowIndex +1);
-			indices.push_back(topRowIndex);
+			*capIndices++ = topIndex;
+			*capIndices++ = topRowIndex + 1;
+			*capIndices++ = topRowIndex;
 		}
 	}
+
+	// fills the (rings + 1) x (slices + 1) sphere vertices, rings run from the top pole down
+	template<class VertexT, class MakeVertex>
+	void CreateSphereVertices(Core::Span<VertexT> vertices, int slices, int rings, MakeVertex makeVertex)
+	{
+		ASSERT(vertices.size() >= static_cast<size_t>((rings + 1) * (slices + 1)), "MeshBuilder: vertex span is too small");
+		const float vertRotation = (Math::Constants::Pi / static_cast<float>(rings - 1));
+		const float horzRotation = (Math::Constants::TwoPi / static_cast<float>(slices));
+		ForEachRow(rings + 1, slices + 1, [&](uint32_t r)
+		{
+			const float ring = static_cast<float>(r);
+			const float phi = ring * vertRotation;
+			VertexT* rowVertices = &vertices[r * (slices + 1)];
+			for (int s = 0; s <= slices; ++s)
+			{
+				const float slice = static_cast<float>(s);
+				const float rotation = slice * horzRotation;
+				const uint32_t index = (r * (slices + 1)) + s;
+				rowVertices[s] = makeVertex(index, ring, slice, phi, rotation);
+			}
+		});
+	}
+
+	template<class MeshT>
+	void AllocateMesh(MeshT& mesh, const MeshBuilder::MeshSize& size)
+	{
+		mesh.vertices.resize(size.vertexCount);
+		mesh.indices.resize(size.indexCount);
+	}
+}
+
+MeshBuilder::MeshSize MeshBuilder::GetPlaneSize(int numRows, int numCols)
+{
+	MeshSize size;
+	size.vertexCount = static_cast<uint32_t>((numRows + 1) * (numCols + 1));
+	size.indexCount = static_cast<uint32_t>(numRows * numCols * 6);
+	return size;
+}
+
+MeshBuilder::MeshSize MeshBuilder::GetCylinderSize(int slices, int rings)
+{
+	MeshSize size = GetPlaneSize(rings, slices);
+	size.vertexCount += 2;
+	size.indexCount += static_cast<uint32_t>(slices * 6);
+	return size;
+}
+
+MeshBuilder::MeshSize MeshBuilder::GetSphereSize(int slices, int rings)
+{
+	return GetPlaneSize(rings, slices);
 }
 
 MeshPC MeshBuilder::CreateCubePC(float size)
 {
 	MeshPC mesh;
+	mesh.vertices.reserve(8);
 
 	int index = rand() % 10;
 
@@ -122,6 +200,7 @@ MeshPC MeshBuilder::CreateCubePC(float size)
 MeshPX MeshBuilder::CreateCubePX(float size)
 {
 	MeshPX mesh;
+	mesh.vertices.reserve(36);
 
 	const float hs = size * 0.5f;	// half size
 	const float ot = 1.0f / 3.0f;	// one third
@@ -182,10 +261,8 @@ MeshPX MeshBuilder::CreateCubePX(float size)
 	mesh.vertices.push_back({ { hs, -hs, -hs}, { 0.5f, tt} });
 	mesh.vertices.push_back({ { hs, -hs,  hs}, { 0.5f, 1.0f} });
 
-	for (uint32_t i = 0; i < mesh.vertices.size(); ++i)
-	{
-		mesh.indices.push_back(i);
-	}
+	mesh.indices.resize(mesh.vertices.size());
+	std::iota(mesh.indices.begin(), mesh.indices.end(), 0u);
 
 	return mesh;
 }
@@ -193,6 +270,7 @@ MeshPX MeshBuilder::CreateCubePX(float size)
 MeshPX MeshBuilder::CreateSkyboxPX(float size)
 {
 	MeshPX mesh;
+	mesh.vertices.reserve(36);
 
 	const float hs = size * 0.5f;	// half size
 	const float ot = 1.0f / 3.0f;	// one third
@@ -253,10 +331,8 @@ MeshPX MeshBuilder::CreateSkyboxPX(float size)
 	mesh.vertices.push_back({ { hs, -hs,  hs}, { 0.5f, 1.0f} });
 	mesh.vertices.push_back({ { hs, -hs, -hs}, { 0.5f, tt} });
 
-	for (uint32_t i = 0; i < mesh.vertices.size(); ++i)
-	{
-		mesh.indices.push_back(i);
-	}
+	mesh.indices.resize(mesh.vertices.size());
+	std::iota(mesh.indices.begin(), mesh.indices.end(), 0u);
 
 	return mesh;
 }
@@ -264,38 +340,33 @@ MeshPX MeshBuilder::CreateSkyboxPX(float size)
 MeshPX MeshBuilder::CreateSkySpherePX(int slices, int rings, float radius)
 {
 	MeshPX mesh;
+	AllocateMesh(mesh, GetSphereSize(slices, rings));
+	CreateSkySpherePX(slices, rings, radius, mesh.vertices, mesh.indices);
+	return mesh;
+}
 
-	float vertRotation = (Math::Constants::Pi / static_cast<float>(rings - 1));
-	float horzRotation = (Math::Constants::TwoPi / static_cast<float>(slices));
-	float uStep = 1.0f / static_cast<float>(slices);
-	float vStep = 1.0f / static_cast<float>(rings);
-	for (int r = 0; r <= rings; ++r)
+void MeshBuilder::CreateSkySpherePX(int slices, int rings, float radius, Core::Span<VertexPX> vertices, Core::Span<uint32_t> indices)
+{
+	const float uStep = 1.0f / static_cast<float>(slices);
+	const float vStep = 1.0f / static_cast<float>(rings);
+	CreateSphereVertices(vertices, slices, rings, [&](uint32_t, float ring, float slice, float phi, float rotation) -> VertexPX
 	{
-		float ring = static_cast<float>(r);
-		float phi = ring * vertRotation;
-		for (int s = 0; s <= slices; ++s)
-		{
-			float slice = static_cast<float>(s);
-			float rotation = slice * horzRotation;
-
-			float u = 1.0f - (uStep * slice);
-			float v = vStep * ring;
-			mesh.vertices.push_back({ {
-					radius * cos(rotation) * sin(phi),
-					radius * cos(phi),
-					radius * sin(rotation) * sin(phi)},
-					{u, v} });
-		}
-	}
-
-	CreatePlaneIndices(mesh.indices, rings, slices);
-
-	return mesh;
+		float u = 1.0f - (uStep * slice);
+		float v = vStep * ring;
+		return { {
+			radius * cos(rotation) * sin(phi),
+			radius * cos(phi),
+			radius * sin(rotation) * sin(phi)},
+			{u, v} };
+	});
+
+	CreatePlaneIndices(indices, rings, slices);
 }
 
 MeshPC MeshBuilder::CreateRectPC(float width, float length, float height)
 {
 	MeshPC mesh;
+	mesh.vertices.reserve(8);
 
 	int index = rand() % 10;
 	
@@ -323,153 +394,197 @@ MeshPC MeshBuilder::CreateRectPC(float width, float length, float height)
 MeshPC MeshBuilder::CreatePlanePC(int numRows, int numCols, float spacing)
 {
 	MeshPC mesh;
-	int index = rand() % 10;
+	AllocateMesh(mesh, GetPlaneSize(numRows, numCols));
+	CreatePlanePC(numRows, numCols, spacing, mesh.vertices, mesh.indices);
+	return mesh;
+}
+
+void MeshBuilder::CreatePlanePC(int numRows, int numCols, float spacing, Core::Span<VertexPC> vertices, Core::Span<uint32_t> indices)
+{
+	ASSERT(vertices.size() >= GetPlaneSize(numRows, numCols).vertexCount, "MeshBuilder: vertex span is too small");
+	const int index = rand() % 10;
 
 	const float hpw = static_cast<float>(numCols) * spacing * 0.5f;
 	const float hph = static_cast<float>(numRows) * spacing * 0.5f;
 
-	float x = -hpw;
-	float y = -hph;
-
-	for (int r = 0; r <= numRows; ++r)
+	ForEachRow(numRows + 1, numCols + 1, [&](uint32_t r)
 	{
+		const float y = -hph + (static_cast<float>(r) * spacing);
+		const uint32_t rowStart = r * (numCols + 1);
 		for (int c = 0; c <= numCols; ++c)
 		{
-			mesh.vertices.push_back({ { x,y, 0.0f }, GetNextColor(index) });
-			x += spacing;
+			const float x = -hpw + (static_cast<float>(c) * spacing);
+			vertices[rowStart + c] = { { x, y, 0.0f }, GetColorAt(index, rowStart + c) };
 		}
-		x = -hpw;
-		y += spacing;
-	}
+	});
 
-	CreatePlaneIndices(mesh.indices, numRows, numCols);
-	return mesh;
+	CreatePlaneIndices(indices, numRows, numCols);
 }
 
 MeshPX MeshBuilder::CreatePlanePX(int numRows, int numCols, float spacing)
 {
 	MeshPX mesh;
+	AllocateMesh(mesh, GetPlaneSize(numRows, numCols));
+	CreatePlanePX(numRows, numCols, spacing, mesh.vertices, mesh.indices);
+	return mesh;
+}
+
+void MeshBuilder::CreatePlanePX(int numRows, int numCols, float spacing, Core::Span<VertexPX> vertices, Core::Span<uint32_t> indices)
+{
+	ASSERT(vertices.size() >= GetPlaneSize(numRows, numCols).vertexCount, "MeshBuilder: vertex span is too small");
 
 	const float hpw = static_cast<float>(numCols) * spacing * 0.5f;
 	const float hph = static_cast<float>(numRows) * spacing * 0.5f;
+	const float uInc = 1.0f / static_cast<float>(numCols);
+	const float vInc = 1.0f / static_cast<float>(numRows);
 
-	float x = -hpw;
-	float y = -hph;
-	float uInc = 1.0f / static_cast<float>(numCols);
-	float vInc = 1.0f / static_cast<float>(numRows);
-	float u = 0.0f;
-	float v = 1.0f;
-
-	for (int r = 0; r <= numRows; ++r)
+	ForEachRow(numRows + 1, numCols + 1, [&](uint32_t r)
 	{
+		const float y = -hph + (static_cast<float>(r) * spacing);
+		const float v = 1.0f + (static_cast<float>(r) * vInc);
+		const uint32_t rowStart = r * (numCols + 1);
 		for (int c = 0; c <= numCols; ++c)
 		{
-			mesh.vertices.push_back({ { x,y, 0.0f }, { u, v } });
-			x += spacing;
-			u += uInc;
+			const float x = -hpw + (static_cast<float>(c) * spacing);
+			const float u = static_cast<float>(c) * uInc;
+			vertices[rowStart + c] = { { x, y, 0.0f }, { u, v } };
 		}
-		x = -hpw;
-		y += spacing;
-		u = 0.0f;
-		v += vInc;
-	}
+	});
 
-	CreatePlaneIndices(mesh.indices, numRows, numCols);
-	return mesh;
+	CreatePlaneIndices(indices, numRows, numCols);
 }
 
+Mesh MeshBuilder::CreatePlane(int numRows, int numCols, float spacing)
+{
+	MeshPX planePX = CreatePlanePX(numRows, numCols, spacing);
+
+	Mesh mesh;
+	mesh.vertices.resize(planePX.vertices.size());
+	for (size_t i = 0; i < planePX.vertices.size(); ++i)
+	{
+		mesh.vertices[i].position = planePX.vertices[i].position;
+		mesh.vertices[i].uvCoord = planePX.vertices[i].uvCoord;
+	}
+	mesh.indices = std::move(planePX.indices);
 
+	TangentSpace::Compute(mesh);
+	return mesh;
+}
 
 MeshPC MeshBuilder::CreateCylinderPC(int slices, int rings)
 {
 	MeshPC mesh;
+	AllocateMesh(mesh, GetCylinderSize(slices, rings));
+	CreateCylinderPC(slices, rings, mesh.vertices, mesh.indices);
+	return mesh;
+}
+
+void MeshBuilder::CreateCylinderPC(int slices, int rings, Core::Span<VertexPC> vertices, Core::Span<uint32_t> indices)
+{
+	const MeshSize size = GetCylinderSize(slices, rings);
+	ASSERT(vertices.size() >= size.vertexCount, "MeshBuilder: vertex span is too small");
+	const int index = rand() % 10;
 
-	int index = rand() % 10;
-	
 	const float hh = static_cast<float>(rings) * 0.5f;
 
-	for (int r = 0; r <= rings; ++r)
+	ForEachRow(rings + 1, slices + 1, [&](uint32_t r)
 	{
-		float ring = static_cast<float>(r);
+		const float ring = static_cast<float>(r);
+		const uint32_t rowStart = r * (slices + 1);
 		for (int s = 0; s <= slices; ++s)
 		{
-			float slice = static_cast<float>(s);
-			float rotation = (slice / static_cast<float>(slices)) * Math::Constants::TwoPi;
+			const float slice = static_cast<float>(s);
+			const float rotation = (slice / static_cast<float>(slices)) * Math::Constants::TwoPi;
 
-			mesh.vertices.push_back({ {
+			vertices[rowStart + s] = { {
 					sin(rotation),
 					ring - hh,
 					-cos(rotation)},
-					GetNextColor(index) });
+					GetColorAt(index, rowStart + s) };
 		}
-	}
-
-	mesh.vertices.push_back({ {0.0f, hh, 0.0f}, GetNextColor(index) });
-	mesh.vertices.push_back({ {0.0f, -hh, 0.0f}, GetNextColor(index) });
+	});
 
-	CreatePlaneIndices(mesh.indices, rings, slices);
-	CreateCapIndices(mesh.indices, slices, mesh.vertices.size() - 2, mesh.vertices.size() - 1);
+	const uint32_t topIndex = size.vertexCount - 2;
+	const uint32_t bottomIndex = size.vertexCount - 1;
+	vertices[topIndex] = { {0.0f, hh, 0.0f}, GetColorAt(index, topIndex) };
+	vertices[bottomIndex] = { {0.0f, -hh, 0.0f}, GetColorAt(index, bottomIndex) };
 
-	return mesh;
+	const uint32_t sideIndexCount = GetPlaneSize(rings, slices).indexCount;
+	CreatePlaneIndices(indices, rings, slices);
+	CreateCapIndices(indices.subspan(sideIndexCount), slices, topIndex, bottomIndex);
 }
 
 MeshPC MeshBuilder::CreateSpherePC(int slices, int rings, float radius)
 {
 	MeshPC mesh;
-	int index = rand() % 10;
+	AllocateMesh(mesh, GetSphereSize(slices, rings));
+	CreateSpherePC(slices, rings, radius, mesh.vertices, mesh.indices);
+	return mesh;
+}
 
-	float vertRotation = (Math::Constants::Pi / static_cast<float>(rings - 1));
-	float horzRotation = (Math::Constants::TwoPi / static_cast<float>(slices));
-	for (int r = 0; r <= rings; ++r)
+void MeshBuilder::CreateSpherePC(int slices, int rings, float radius, Core::Span<VertexPC> vertices, Core::Span<uint32_t> indices)
+{
+	const int index = rand() % 10;
+	CreateSphereVertices(vertices, slices, rings, [&](uint32_t vertexIndex, float, float, float phi, float rotation) -> VertexPC
 	{
-		float ring = static_cast<float>(r);
-		float phi = ring * vertRotation;
-		for (int s = 0; s <= slices; ++s)
-		{
-			float slice = static_cast<float>(s);
-			float rotation = slice * horzRotation;
-			mesh.vertices.push_back({ {
-					radius * sin(rotation) * sin(phi),
-					radius * cos(phi),
-					radius * cos(rotation) * sin(phi)},
-					GetNextColor(index) });
-		}
-	}
-
-	CreatePlaneIndices(mesh.indices, rings, slices);
-
-	return mesh;
+		return { {
+			radius * sin(rotation) * sin(phi),
+			radius * cos(phi),
+			radius * cos(rotation) * sin(phi)},
+			GetColorAt(index, vertexIndex) };
+	});
+
+	CreatePlaneIndices(indices, rings, slices);
 }
 
 MeshPX MeshBuilder::CreateSpherePX(int slices, int rings, float radius)
 {
 	MeshPX mesh;
+	AllocateMesh(mesh, GetSphereSize(slices, rings));
+	CreateSpherePX(slices, rings, radius, mesh.vertices, mesh.indices);
+	return mesh;
+}
 
-	float vertRotation = (Math::Constants::Pi / static_cast<float>(rings - 1));
-	float horzRotation = (Math::Constants::TwoPi / static_cast<float>(slices));
-	float uStep = 1.0f / static_cast<float>(slices);
-	float vStep = 1.0f / static_cast<float>(rings);
-	for (int r = 0; r <= rings; ++r)
+void MeshBuilder::CreateSpherePX(int slices, int rings, float radius, Core::Span<VertexPX> vertices, Core::Span<uint32_t> indices)
+{
+	const float uStep = 1.0f / static_cast<float>(slices);
+	const float vStep = 1.0f / static_cast<float>(rings);
+	CreateSphereVertices(vertices, slices, rings, [&](uint32_t, float ring, float slice, float phi, float rotation) -> VertexPX
 	{
-		float ring = static_cast<float>(r);
-		float phi = ring * vertRotation;
-		for (int s = 0; s <= slices; ++s)
-		{
-			float slice = static_cast<float>(s);
-			float rotation = slice * horzRotation;
-
-			float u = 1.0f - (uStep * slice);
-			float v = vStep * ring;
-			mesh.vertices.push_back({ {
-					radius * sin(rotation) * sin(phi),
-					radius * cos(phi),
-					radius * cos(rotation) * sin(phi)},
-					{u, v} });
-		}
-	}
+		float u = 1.0f - (uStep * slice);
+		float v = vStep * ring;
+		return { {
+			radius * sin(rotation) * sin(phi),
+			radius * cos(phi),
+			radius * cos(rotation) * sin(phi)},
+			{u, v} };
+	});
+
+	CreatePlaneIndices(indices, rings, slices);
+}
 
-	CreatePlaneIndices(mesh.indices, rings, slices);
+Mesh MeshBuilder::CreateSphere(int slices, int rings, float radius)
+{
+	Mesh mesh;
+	AllocateMesh(mesh, GetSphereSize(slices, rings));
+
+	// the seam and poles are split vertices, so the normals come straight from the sphere
+	// and only the tangents are generated
+	const float uStep = 1.0f / static_cast<float>(slices);
+	const float vStep = 1.0f / static_cast<float>(rings);
+	CreateSphereVertices(Core::Span<Vertex>(mesh.vertices), slices, rings, [&](uint32_t, float ring, float slice, float phi, float rotation)
+	{
+		Vertex vertex;
+		vertex.normal = {
+			sinf(rotation) * sinf(phi),
+			cosf(phi),
+			cosf(rotation) * sinf(phi) };
+		vertex.position = vertex.normal * radius;
+		vertex.uvCoord = { 1.0f - (uStep * slice), vStep * ring };
+		return vertex;
+	});
 
+	CreatePlaneIndices(mesh.indices, rings, slices);
+	TangentSpace::ComputeTangents(mesh);
 	return mesh;
-}
-
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "Precompiled.h"
+#include "MeshFile.h"
+
+#include "VertexTypes.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	bool IsRangeInFile(uint64_t offset, uint64_t size, size_t fileSize)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	}
+
+	template<class IndexT>
+	const char* ValidateIndices(const IndexT* indices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		for (uint32_t i = 0; i < indexCount; ++i)
+		{
+			if (indices[i] >= vertexCount)
+			{
+				return "index out of range";
+			}
+		}
+		return nullptr;
+	}
+
+	void GetBounds(const uint8_t* vertices, uint32_t vertexSize, uint32_t vertexCount, Vector3& boundsMin, Vector3& boundsMax)
+	{
+		boundsMin = Vector3::Zero;
+		boundsMax = Vector3::Zero;
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			Vector3 position;
+			memcpy(&position, vertices + (static_cast<size_t>(i) * vertexSize), sizeof(Vector3));
+			if (i == 0)
+			{
+				boundsMin = position;
+				boundsMax = position;
+				continue;
+			}
+			boundsMin = { std::min(boundsMin.x, position.x), std::min(boundsMin.y, position.y), std::min(boundsMin.z, position.z) };
+			boundsMax = { std::max(boundsMax.x, position.x), std::max(boundsMax.y, position.y), std::max(boundsMax.z, position.z) };
+		}
+	}
+}
+
+const char* MeshFile::CheckHeader(const uint8_t* data, size_t size)
+{
+	if (size < sizeof(Header))
+	{
+		return "file too small";
+	}
+
+	const Header* header = reinterpret_cast<const Header*>(data);
+	if (header->magic != Magic)
+	{
+		return "not a mesh file";
+	}
+	if (header->version != Version)
+	{
+		return "unsupported version";
+	}
+	if (header->vertexCount == 0 || header->vertexSize == 0 || header->vertexSize % sizeof(float) != 0)
+	{
+		return "invalid vertex layout";
+	}
+	if ((header->vertexFormat & VE_Position) == 0 || header->vertexSize < sizeof(Vector3))
+	{
+		return "vertices have no position";
+	}
+	if (header->indexFormat != IndexFormat::UInt16 && header->indexFormat != IndexFormat::UInt32)
+	{
+		return "invalid index format";
+	}
+	if (header->indexFormat == IndexFormat::UInt16 && header->vertexCount > MaxShortIndexVertexCount)
+	{
+		return "too many vertices for 16 bit indices";
+	}
+	if (header->indexCount % 3 != 0)
+	{
+		return "index count is not a multiple of 3";
+	}
+	if (header->vertexOffset % DataAlignment != 0 || header->indexOffset % DataAlignment != 0)
+	{
+		return "misaligned data";
+	}
+
+	const uint64_t vertexDataSize = static_cast<uint64_t>(header->vertexSize) * header->vertexCount;
+	const uint64_t indexDataSize = static_cast<uint64_t>(GetIndexSize(header->indexFormat)) * header->indexCount;
+	if (header->vertexOffset < sizeof(Header) || !IsRangeInFile(header->vertexOffset, vertexDataSize, size))
+	{
+		return "vertex data out of range";
+	}
+	if (header->indexCount > 0 && (header->indexOffset < header->vertexOffset + vertexDataSize || !IsRangeInFile(header->indexOffset, indexDataSize, size)))
+	{
+		return "index data out of range";
+	}
+	return nullptr;
+}
+
+const char* MeshFile::Validate(const uint8_t* data, size_t size)
+{
+	if (const char* error = CheckHeader(data, size))
+	{
+		return error;
+	}
+
+	const Header* header = reinterpret_cast<const Header*>(data);
+	const char* indexError = (header->indexFormat == IndexFormat::UInt16) ?
+		ValidateIndices(reinterpret_cast<const uint16_t*>(data + header->indexOffset), header->indexCount, header->vertexCount) :
+		ValidateIndices(reinterpret_cast<const uint32_t*>(data + header->indexOffset), header->indexCount, header->vertexCount);
+	if (indexError != nullptr)
+	{
+		return indexError;
+	}
+
+	Vector3 boundsMin;
+	Vector3 boundsMax;
+	GetBounds(data + header->vertexOffset, header->vertexSize, header->vertexCount, boundsMin, boundsMax);
+	if (boundsMin.x != header->boundsMin.x || boundsMin.y != header->boundsMin.y || boundsMin.z != header->boundsMin.z ||
+		boundsMax.x != header->boundsMax.x || boundsMax.y != header->boundsMax.y || boundsMax.z != header->boundsMax.z)
+	{
+		return "stored bounds don't match the vertices";
+	}
+	return nullptr;
+}
+
+bool MeshFile::Write(const std::filesystem::path& filePath, const void* vertices, uint32_t vertexSize, uint32_t vertexCount, uint32_t vertexFormat, const uint32_t* indices, uint32_t indexCount)
+{
+	ASSERT((vertexFormat & VE_Position) != 0, "MeshFile: vertices need a position");
+	ASSERT(indexCount % 3 == 0, "MeshFile: index count must be a multiple of 3");
+
+	Header header;
+	header.vertexFormat = vertexFormat;
+	header.vertexSize = vertexSize;
+	header.vertexCount = vertexCount;
+	header.indexFormat = GetIndexFormat(vertexCount);
+	header.indexCount = indexCount;
+	header.vertexOffset = sizeof(Header);
+	header.indexOffset = AlignOffset(header.vertexOffset + (static_cast<uint64_t>(vertexSize) * vertexCount));
+	GetBounds(static_cast<const uint8_t*>(vertices), vertexSize, vertexCount, header.boundsMin, header.boundsMax);
+
+	// written next to the destination and renamed over it once complete, so a failed write
+	// never leaves a truncated file that still passes the header check
+	std::filesystem::path tempPath = filePath;
+	tempPath += L".tmp";
+	std::ofstream file(tempPath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const char padding[DataAlignment] = {};
+	const size_t vertexDataSize = static_cast<size_t>(vertexSize) * vertexCount;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(static_cast<const char*>(vertices), vertexDataSize);
+	file.write(padding, static_cast<std::streamsize>(header.indexOffset - (header.vertexOffset + vertexDataSize)));
+	if (header.indexFormat == IndexFormat::UInt16)
+	{
+		const std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+		file.write(reinterpret_cast<const char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		file.write(reinterpret_cast<const char*>(indices), static_cast<size_t>(indexCount) * sizeof(uint32_t));
+	}
+	file.close();
+
+	std::error_code ec;
+	if (!file.good())
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	std::filesystem::rename(tempPath, filePath, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
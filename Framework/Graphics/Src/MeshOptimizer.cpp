@@ -0,0 +1,645 @@
+#include "Precompiled.h"
+#include "MeshOptimizer.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	// Forsyth, "Linear-Speed Vertex Cache Optimisation"
+	constexpr int MaxCacheSize = 32;
+	constexpr float CacheDecayPower = 1.5f;
+	constexpr float LastTriScore = 0.75f;
+	constexpr float ValenceBoostScale = 2.0f;
+	constexpr float ValenceBoostPower = 0.5f;
+	constexpr uint32_t MaxValence = 64;
+	constexpr uint32_t InvalidTriangle = ~0u;
+
+	// vertex structs lay their attributes out in VE_* flag order, packed elements take the place of
+	// their float version and are compared as raw 4 byte words
+	struct AttributeDesc
+	{
+		uint32_t flag;
+		uint32_t componentCount;
+		bool isFloat;
+	};
+
+	constexpr AttributeDesc VertexAttributes[] = {
+		{ VE_Position, 3, true },
+		{ VE_Normal, 3, true },
+		{ VE_NormalOct, 1, false },
+		{ VE_Tangent, 3, true },
+		{ VE_TangentOct, 1, false },
+		{ VE_Color, 4, true },
+		{ VE_ColorUNorm8, 1, false },
+		{ VE_TexCoord, 2, true },
+		{ VE_TexCoordHalf, 1, false },
+		{ VE_TexCoordUNorm16, 1, false },
+		{ VE_BlendIndex, 4, false },
+		{ VE_BlendIndexUInt8, 1, false },
+		{ VE_BlendWeight, 4, true },
+		{ VE_BlendWeightUNorm8, 1, false }
+	};
+
+	struct ScoreTable
+	{
+		float cache[MaxCacheSize] = {};
+		float valence[MaxValence + 1] = {};
+
+		ScoreTable()
+		{
+			for (int i = 0; i < MaxCacheSize; ++i)
+			{
+				if (i < 3)
+				{
+					// the last triangle's vertices are scored flat so the strip doesn't just flip back and forth
+					cache[i] = LastTriScore;
+				}
+				else
+				{
+					const float scaler = 1.0f / (MaxCacheSize - 3);
+					cache[i] = powf(1.0f - ((i - 3) * scaler), CacheDecayPower);
+				}
+			}
+			for (uint32_t i = 1; i <= MaxValence; ++i)
+			{
+				valence[i] = ValenceBoostScale * powf(static_cast<float>(i), -ValenceBoostPower);
+			}
+		}
+
+		float GetVertexScore(int cachePosition, uint32_t remainingTriangles) const
+		{
+			if (remainingTriangles == 0)
+			{
+				return -1.0f;
+			}
+			float score = (cachePosition >= 0) ? cache[cachePosition] : 0.0f;
+			score += valence[std::min(remainingTriangles, MaxValence)];
+			return score;
+		}
+	};
+
+	// per vertex list of the triangles that use it
+	struct TriangleAdjacency
+	{
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+
+		TriangleAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+			: counts(vertexCount, 0)
+			, offsets(vertexCount, 0)
+			, triangles(indices.size())
+		{
+			for (uint32_t index : indices)
+			{
+				++counts[index];
+			}
+			uint32_t offset = 0;
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				offsets[v] = offset;
+				offset += counts[v];
+			}
+			std::vector<uint32_t> fill(offsets);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+	};
+
+	// exact FIFO cache simulation, a vertex is cached while fewer than cacheSize misses happened since it was loaded
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t cacheSize)
+			: mTimestamps(vertexCount, 0)
+			, mTime(cacheSize + 1)
+			, mCacheSize(cacheSize)
+		{
+		}
+
+		void Reset()
+		{
+			mTime += mCacheSize + 1;
+		}
+
+		// returns true on a cache miss
+		bool Access(uint32_t vertex)
+		{
+			if (mTime - mTimestamps[vertex] > mCacheSize)
+			{
+				mTimestamps[vertex] = mTime++;
+				return true;
+			}
+			return false;
+		}
+
+		uint32_t AccessTriangle(const uint32_t* triangle)
+		{
+			return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+		}
+
+	private:
+		std::vector<uint32_t> mTimestamps;
+		uint32_t mTime;
+		uint32_t mCacheSize;
+	};
+
+	// welding compares canonical keys instead of the raw vertices, so -0 matches 0
+	class VertexKeys
+	{
+	public:
+		VertexKeys(const void* vertices, uint32_t vertexSize, size_t vertexCount, uint32_t vertexFormat)
+		{
+			for (const AttributeDesc& attribute : VertexAttributes)
+			{
+				if (vertexFormat & attribute.flag)
+				{
+					mIsFloat.insert(mIsFloat.end(), attribute.componentCount, attribute.isFloat);
+				}
+			}
+			mComponentCount = static_cast<uint32_t>(mIsFloat.size());
+			ASSERT(mComponentCount * sizeof(uint32_t) == vertexSize, "MeshOptimizer: vertex size does not match the vertex format");
+			mHasPosition = (vertexFormat & VE_Position) != 0;
+
+			const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+			mKeys.resize(vertexCount * mComponentCount);
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				const uint8_t* vertex = bytes + (v * vertexSize);
+				uint32_t* key = &mKeys[v * mComponentCount];
+				for (uint32_t c = 0; c < mComponentCount; ++c)
+				{
+					memcpy(&key[c], vertex + (c * sizeof(uint32_t)), sizeof(uint32_t));
+					if (mIsFloat[c] && GetFloat(key[c]) == 0.0f)
+					{
+						key[c] = 0;
+					}
+				}
+			}
+		}
+
+		size_t Hash(uint32_t vertex) const
+		{
+			// FNV-1a
+			uint64_t hash = 14695981039346656037ull;
+			const uint32_t* key = &mKeys[vertex * mComponentCount];
+			for (uint32_t c = 0; c < mComponentCount; ++c)
+			{
+				hash ^= key[c];
+				hash *= 1099511628211ull;
+			}
+			return static_cast<size_t>(hash);
+		}
+
+		bool Equal(uint32_t a, uint32_t b) const
+		{
+			return std::equal(&mKeys[a * mComponentCount], &mKeys[a * mComponentCount] + mComponentCount, &mKeys[b * mComponentCount]);
+		}
+
+		// float components at most epsilon apart, everything else equal
+		bool IsNear(uint32_t a, uint32_t b, float epsilon) const
+		{
+			const uint32_t* keyA = &mKeys[a * mComponentCount];
+			const uint32_t* keyB = &mKeys[b * mComponentCount];
+			for (uint32_t c = 0; c < mComponentCount; ++c)
+			{
+				const bool match = mIsFloat[c] ? (fabsf(GetFloat(keyA[c]) - GetFloat(keyB[c])) <= epsilon) : (keyA[c] == keyB[c]);
+				if (!match)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool HasPosition() const { return mHasPosition; }
+
+		// positions are always the first three components
+		float GetComponent(uint32_t vertex, uint32_t c) const
+		{
+			return GetFloat(mKeys[(vertex * mComponentCount) + c]);
+		}
+
+	private:
+		static float GetFloat(uint32_t bits)
+		{
+			float value = 0.0f;
+			memcpy(&value, &bits, sizeof(float));
+			return value;
+		}
+
+		std::vector<uint32_t> mKeys;
+		std::vector<bool> mIsFloat;
+		uint32_t mComponentCount = 0;
+		bool mHasPosition = false;
+	};
+
+	// grid cell of a coordinate, clamped in float first because casting an out of range or NaN float is undefined
+	int32_t GetWeldCell(float value, float invEpsilon)
+	{
+		constexpr float MaxCell = 2147483520.0f;	// largest float below 2^31, leaves room for the neighbour probes
+		const float cell = floorf(value * invEpsilon);
+		if (std::isnan(cell))
+		{
+			return 0;
+		}
+		return static_cast<int32_t>(std::clamp(cell, -MaxCell, MaxCell));
+	}
+
+	uint64_t GetWeldCellKey(int32_t x, int32_t y, int32_t z)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) * 73856093ull) ^
+			(static_cast<uint64_t>(static_cast<uint32_t>(y)) * 19349663ull) ^
+			(static_cast<uint64_t>(static_cast<uint32_t>(z)) * 83492791ull);
+	}
+
+	struct VertexKeyHash
+	{
+		const VertexKeys* keys;
+		size_t operator()(uint32_t vertex) const { return keys->Hash(vertex); }
+	};
+
+	struct VertexKeyEqual
+	{
+		const VertexKeys* keys;
+		bool operator()(uint32_t a, uint32_t b) const { return keys->Equal(a, b); }
+	};
+
+	struct Cluster
+	{
+		uint32_t firstTriangle = 0;
+		uint32_t triangleCount = 0;
+		Vector3 centroid = Vector3::Zero;
+		Vector3 normal = Vector3::Zero;
+		float sortKey = 0.0f;
+	};
+
+	// a new hard cluster starts wherever the cache had nothing to reuse, the vertex cache pass
+	// only does that when it jumps to a disconnected part of the mesh
+	std::vector<uint32_t> GetHardBoundaries(const std::vector<uint32_t>& indices, size_t vertexCount)
+	{
+		std::vector<uint32_t> boundaries;
+		FifoCache cache(vertexCount, MeshOptimizer::DefaultCacheSize);
+		const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		for (uint32_t t = 0; t < triangleCount; ++t)
+		{
+			if (cache.AccessTriangle(&indices[t * 3]) == 3)
+			{
+				boundaries.push_back(t);
+			}
+		}
+		return boundaries;
+	}
+
+	// splits a hard cluster wherever the running ACMR is already within threshold of the cluster's own ACMR
+	void AddSoftClusters(std::vector<Cluster>& clusters, const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t first, uint32_t last, float threshold)
+	{
+		FifoCache cache(vertexCount, MeshOptimizer::DefaultCacheSize);
+		uint32_t clusterMisses = 0;
+		for (uint32_t t = first; t < last; ++t)
+		{
+			clusterMisses += cache.AccessTriangle(&indices[t * 3]);
+		}
+		const float targetAcmr = threshold * static_cast<float>(clusterMisses) / static_cast<float>(last - first);
+
+		cache.Reset();
+		Cluster cluster;
+		cluster.firstTriangle = first;
+		uint32_t misses = 0;
+		for (uint32_t t = first; t < last; ++t)
+		{
+			misses += cache.AccessTriangle(&indices[t * 3]);
+			++cluster.triangleCount;
+
+			const float acmr = static_cast<float>(misses) / static_cast<float>(cluster.triangleCount);
+			if (acmr <= targetAcmr && t + 1 < last)
+			{
+				clusters.push_back(cluster);
+				cluster.firstTriangle = t + 1;
+				cluster.triangleCount = 0;
+				misses = 0;
+				cache.Reset();
+			}
+		}
+		if (cluster.triangleCount > 0)
+		{
+			clusters.push_back(cluster);
+		}
+	}
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats;
+	if (indices.empty() || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> referenced(vertexCount, false);
+	uint32_t misses = 0;
+	uint32_t uniqueCount = 0;
+	for (uint32_t index : indices)
+	{
+		ASSERT(index < vertexCount, "MeshOptimizer: index out of range");
+		misses += cache.Access(index) ? 1 : 0;
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			++uniqueCount;
+		}
+	}
+
+	stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+	stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueCount);
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	ASSERT(indices.size() % 3 == 0, "MeshOptimizer: index count must be a multiple of 3");
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	static const ScoreTable scoreTable;
+	TriangleAdjacency adjacency(indices, vertexCount);
+
+	// counts double as the number of triangles not emitted yet
+	std::vector<uint32_t>& remaining = adjacency.counts;
+	std::vector<float> vertexScores(vertexCount, 0.0f);
+	for (size_t v = 0; v < vertexCount; ++v)
+	{
+		vertexScores[v] = scoreTable.GetVertexScore(-1, remaining[v]);
+	}
+	auto getTriangleScore = [&](uint32_t t)
+	{
+		const uint32_t* triangle = &indices[t * 3];
+		return vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+	};
+	std::vector<bool> emitted(triangleCount, false);
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	uint32_t cache[MaxCacheSize + 3];
+	uint32_t cacheCount = 0;
+	uint32_t newCache[MaxCacheSize + 3];
+	uint32_t nextCandidate = 0;
+
+	uint32_t bestTriangle = 0;
+	float bestScore = getTriangleScore(0);
+	for (uint32_t t = 1; t < triangleCount; ++t)
+	{
+		const float score = getTriangleScore(t);
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = t;
+		}
+	}
+
+	while (bestTriangle != InvalidTriangle)
+	{
+		const uint32_t* triangle = &indices[bestTriangle * 3];
+		output.insert(output.end(), triangle, triangle + 3);
+		emitted[bestTriangle] = true;
+
+		// the emitted triangle goes to the front of the cache, followed by everything that was there before
+		uint32_t newCacheCount = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			const uint32_t v = triangle[i];
+			newCache[newCacheCount++] = v;
+
+			uint32_t* begin = adjacency.triangles.data() + adjacency.offsets[v];
+			uint32_t* end = begin + remaining[v];
+			uint32_t* it = std::find(begin, end, bestTriangle);
+			ASSERT(it != end, "MeshOptimizer: corrupt triangle adjacency");
+			std::swap(*it, *(end - 1));
+			--remaining[v];
+		}
+		for (uint32_t i = 0; i < cacheCount; ++i)
+		{
+			const uint32_t v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				newCache[newCacheCount++] = v;
+			}
+		}
+		for (uint32_t i = MaxCacheSize; i < newCacheCount; ++i)
+		{
+			// fell out of the cache
+			vertexScores[newCache[i]] = scoreTable.GetVertexScore(-1, remaining[newCache[i]]);
+		}
+		cacheCount = std::min<uint32_t>(newCacheCount, MaxCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+
+		for (uint32_t i = 0; i < cacheCount; ++i)
+		{
+			const uint32_t v = cache[i];
+			vertexScores[v] = scoreTable.GetVertexScore(static_cast<int>(i), remaining[v]);
+		}
+
+		// only triangles touching the cache changed score, the best of them goes next
+		bestTriangle = InvalidTriangle;
+		bestScore = -1.0f;
+		for (uint32_t i = 0; i < cacheCount; ++i)
+		{
+			const uint32_t v = cache[i];
+			const uint32_t* begin = adjacency.triangles.data() + adjacency.offsets[v];
+			for (const uint32_t* it = begin; it != begin + remaining[v]; ++it)
+			{
+				const float score = getTriangleScore(*it);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = *it;
+				}
+			}
+		}
+
+		// dead end, continue with the next triangle in input order
+		if (bestTriangle == InvalidTriangle)
+		{
+			while (nextCandidate < triangleCount && emitted[nextCandidate])
+			{
+				++nextCandidate;
+			}
+			if (nextCandidate < triangleCount)
+			{
+				bestTriangle = nextCandidate;
+			}
+		}
+	}
+
+	indices = std::move(output);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions, float threshold)
+{
+	ASSERT(indices.size() % 3 == 0, "MeshOptimizer: index count must be a multiple of 3");
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> hardBoundaries = GetHardBoundaries(indices, positions.size());
+	hardBoundaries.push_back(triangleCount);
+
+	std::vector<Cluster> clusters;
+	for (size_t i = 0; i + 1 < hardBoundaries.size(); ++i)
+	{
+		AddSoftClusters(clusters, indices, positions.size(), hardBoundaries[i], hardBoundaries[i + 1], threshold);
+	}
+	if (clusters.size() <= 1)
+	{
+		return;
+	}
+
+	Vector3 meshCentroid = Vector3::Zero;
+	float meshArea = 0.0f;
+	for (Cluster& cluster : clusters)
+	{
+		float area = 0.0f;
+		for (uint32_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; ++t)
+		{
+			const Vector3& p0 = positions[indices[t * 3 + 0]];
+			const Vector3& p1 = positions[indices[t * 3 + 1]];
+			const Vector3& p2 = positions[indices[t * 3 + 2]];
+			const Vector3 faceNormal = Cross(p1 - p0, p2 - p0);
+			const float triangleArea = Magnitude(faceNormal);
+			cluster.centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			cluster.normal += faceNormal;
+			area += triangleArea;
+		}
+
+		meshCentroid += cluster.centroid;
+		meshArea += area;
+		if (area > 0.0f)
+		{
+			cluster.centroid /= area;
+		}
+		const float normalLength = Magnitude(cluster.normal);
+		if (normalLength > 0.0f)
+		{
+			cluster.normal /= normalLength;
+		}
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	// clusters far out along their own normal are the most likely to occlude the rest, so they draw first
+	for (Cluster& cluster : clusters)
+	{
+		cluster.sortKey = Dot(cluster.centroid - meshCentroid, cluster.normal);
+	}
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const Cluster& cluster : clusters)
+	{
+		const auto first = indices.begin() + cluster.firstTriangle * 3;
+		output.insert(output.end(), first, first + cluster.triangleCount * 3);
+	}
+	indices = std::move(output);
+}
+
+std::vector<uint32_t> MeshOptimizer::GetVertexFetchRemap(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	std::vector<uint32_t> remap(vertexCount, UnusedVertex);
+	uint32_t nextVertex = 0;
+	for (uint32_t index : indices)
+	{
+		ASSERT(index < vertexCount, "MeshOptimizer: index out of range");
+		if (remap[index] == UnusedVertex)
+		{
+			remap[index] = nextVertex++;
+		}
+	}
+	return remap;
+}
+
+std::vector<uint32_t> MeshOptimizer::GetWeldRemap(const void* vertices, uint32_t vertexSize, size_t vertexCount, uint32_t vertexFormat, float epsilon, size_t& uniqueCount)
+{
+	const VertexKeys keys(vertices, vertexSize, vertexCount, vertexFormat);
+	std::vector<uint32_t> remap(vertexCount, 0);
+
+	if (epsilon <= 0.0f)
+	{
+		// maps the first vertex of every group to the group's compacted index
+		std::unordered_map<uint32_t, uint32_t, VertexKeyHash, VertexKeyEqual> groups(vertexCount, VertexKeyHash{ &keys }, VertexKeyEqual{ &keys });
+		for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v)
+		{
+			auto [it, inserted] = groups.emplace(v, static_cast<uint32_t>(groups.size()));
+			remap[v] = it->second;
+		}
+		uniqueCount = groups.size();
+		return remap;
+	}
+
+	// The first vertex of every group sits in a grid of epsilon sized cells by position. A vertex within
+	// epsilon of it can fall into any neighbouring cell, so all 27 are probed and the actual attribute
+	// distances compared. Matching against the first vertex only keeps a group from chaining further.
+	// Formats without a position all share one cell.
+	const float invEpsilon = 1.0f / epsilon;
+	std::unordered_multimap<uint64_t, uint32_t> grid;
+	grid.reserve(vertexCount);
+	uniqueCount = 0;
+	for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v)
+	{
+		int32_t cell[3] = { 0, 0, 0 };
+		if (keys.HasPosition())
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				cell[c] = GetWeldCell(keys.GetComponent(v, c), invEpsilon);
+			}
+		}
+
+		uint32_t match = UnusedVertex;
+		for (int32_t x = -1; x <= 1; ++x)
+		{
+			for (int32_t y = -1; y <= 1; ++y)
+			{
+				for (int32_t z = -1; z <= 1; ++z)
+				{
+					auto [begin, end] = grid.equal_range(GetWeldCellKey(cell[0] + x, cell[1] + y, cell[2] + z));
+					for (auto it = begin; it != end; ++it)
+					{
+						// the earliest group wins so the result doesn't depend on the hash order
+						if (it->second < match && keys.IsNear(v, it->second, epsilon))
+						{
+							match = it->second;
+						}
+					}
+				}
+			}
+		}
+
+		if (match != UnusedVertex)
+		{
+			remap[v] = remap[match];
+		}
+		else
+		{
+			remap[v] = static_cast<uint32_t>(uniqueCount++);
+			grid.emplace(GetWeldCellKey(cell[0], cell[1], cell[2]), v);
+		}
+	}
+	return remap;
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "Precompiled.h"
+#include "MeshPool.h"
+
+#include "GraphicsSystem.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+namespace
+{
+	ID3D11Buffer* CreateBuffer(uint32_t size, UINT bindFlags)
+	{
+		D3D11_BUFFER_DESC bufferDesc{};
+		bufferDesc.ByteWidth = size;
+		bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		bufferDesc.BindFlags = bindFlags;
+
+		ID3D11Buffer* buffer = nullptr;
+		auto device = GraphicsSystem::Get()->GetDevice();
+		HRESULT hr = device->CreateBuffer(&bufferDesc, nullptr, &buffer);
+		ASSERT(SUCCEEDED(hr), "MeshPool: failed to create buffer");
+		return buffer;
+	}
+
+	void UpdateRange(ID3D11Buffer* buffer, uint32_t offset, uint32_t size, const void* data)
+	{
+		D3D11_BOX box{};
+		box.left = offset;
+		box.right = offset + size;
+		box.bottom = 1;
+		box.back = 1;
+
+		auto context = GraphicsSystem::Get()->GetContext();
+		context->UpdateSubresource(buffer, 0, &box, data, 0, 0);
+	}
+}
+
+MeshPool::~MeshPool()
+{
+	ASSERT(mVertexBuffer == nullptr, "MeshPool: Terminate must be called");
+}
+
+void MeshPool::Initialize(uint32_t vertexSize, uint32_t vertexCapacity, uint32_t indexCapacity, IndexFormat indexFormat)
+{
+	mVertexSize = vertexSize;
+	mIndexSize = (indexFormat == IndexFormat::UInt16) ? sizeof(uint16_t) : sizeof(uint32_t);
+	mIndexFormat = (indexFormat == IndexFormat::UInt16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	mMeshCount = 0;
+
+	mVertexAllocator.Initialize(vertexCapacity);
+	mIndexAllocator.Initialize(indexCapacity);
+	mVertexBuffer = CreateBuffer(vertexCapacity * vertexSize, D3D11_BIND_VERTEX_BUFFER);
+	mIndexBuffer = CreateBuffer(indexCapacity * mIndexSize, D3D11_BIND_INDEX_BUFFER);
+}
+
+void MeshPool::Terminate()
+{
+	SafeRelease(mIndexBuffer);
+	SafeRelease(mVertexBuffer);
+	mIndexAllocator.Terminate();
+	mVertexAllocator.Terminate();
+	mMeshCount = 0;
+}
+
+MeshPool::Mesh MeshPool::Add(const void* vertices, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount)
+{
+	ASSERT(mIndexFormat == DXGI_FORMAT_R16_UINT, "MeshPool: 16 bit indices need a 16 bit pool");
+	return Add(vertices, vertexCount, static_cast<const void*>(indices), indexCount);
+}
+
+MeshPool::Mesh MeshPool::Add(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+{
+	ASSERT(mIndexFormat == DXGI_FORMAT_R32_UINT, "MeshPool: 32 bit indices need a 32 bit pool, narrow the mesh once with NarrowIndices");
+	return Add(vertices, vertexCount, static_cast<const void*>(indices), indexCount);
+}
+
+MeshPool::Mesh MeshPool::Add(const void* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount)
+{
+	ASSERT(indexCount > 0, "MeshPool: meshes need indices");
+	ASSERT(mIndexFormat == DXGI_FORMAT_R32_UINT || vertexCount <= MaxShortIndexVertexCount, "MeshPool: %u vertices are too many for a 16 bit pool", vertexCount);
+
+	Mesh mesh;
+	const uint32_t baseVertex = mVertexAllocator.Allocate(vertexCount);
+	if (baseVertex == FreeListAllocator::InvalidOffset)
+	{
+		ASSERT(false, "MeshPool: no room for %u vertices", vertexCount);
+		return mesh;
+	}
+	const uint32_t startIndex = mIndexAllocator.Allocate(indexCount);
+	if (startIndex == FreeListAllocator::InvalidOffset)
+	{
+		mVertexAllocator.Free(baseVertex, vertexCount);
+		ASSERT(false, "MeshPool: no room for %u indices", indexCount);
+		return mesh;
+	}
+
+	UpdateRange(mVertexBuffer, baseVertex * mVertexSize, vertexCount * mVertexSize, vertices);
+	UpdateRange(mIndexBuffer, startIndex * mIndexSize, indexCount * mIndexSize, indices);
+
+	mesh.baseVertex = baseVertex;
+	mesh.vertexCount = vertexCount;
+	mesh.startIndex = startIndex;
+	mesh.indexCount = indexCount;
+	++mMeshCount;
+	return mesh;
+}
+
+void MeshPool::Remove(Mesh& mesh)
+{
+	if (!mesh.IsValid())
+	{
+		return;
+	}
+	mVertexAllocator.Free(mesh.baseVertex, mesh.vertexCount);
+	mIndexAllocator.Free(mesh.startIndex, mesh.indexCount);
+	--mMeshCount;
+	mesh = Mesh();
+}
+
+void MeshPool::Bind() const
+{
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	UINT offset = 0;
+	context->IASetVertexBuffers(0, 1, &mVertexBuffer, &mVertexSize, &offset);
+	context->IASetIndexBuffer(mIndexBuffer, mIndexFormat, 0);
+}
+
+void MeshPool::Render(const Mesh& mesh) const
+{
+	ASSERT(mesh.IsValid(), "MeshPool: invalid mesh");
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->DrawIndexed(mesh.indexCount, mesh.startIndex, static_cast<int32_t>(mesh.baseVertex));
+}
\ No newline at end of file
@@ -0,0 +1,599 @@
+#include "Precompiled.h"
+#include "MeshSimplifier.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	// open borders are held in place by planes through the border edge, perpendicular to the
+	// triangle, weighted well above the surface planes
+	constexpr double BorderWeight = 10.0;
+
+	constexpr uint32_t NoVertex = ~0u;
+	constexpr uint32_t ManyVertices = ~0u - 1;
+
+	enum class VertexKind : uint8_t
+	{
+		Manifold,	// free to collapse onto any neighbour
+		Border,		// on an open edge, collapses along the border only
+		Seam,		// one of two vertices at a position, both collapse together along the seam
+		Locked		// seam end, corner or non-manifold vertex, never moves
+	};
+
+	// sum of squared distances to a set of planes, divided by the total weight so the
+	// error reads as a squared distance no matter how many planes were added
+	struct Quadric
+	{
+		double xx = 0.0, xy = 0.0, xz = 0.0, yy = 0.0, yz = 0.0, zz = 0.0;
+		double x = 0.0, y = 0.0, z = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		void AddPlane(const Vector3& normal, const Vector3& point, double planeWeight)
+		{
+			const double a = normal.x;
+			const double b = normal.y;
+			const double n = normal.z;
+			const double d = -((a * point.x) + (b * point.y) + (n * point.z));
+			xx += planeWeight * a * a; xy += planeWeight * a * b; xz += planeWeight * a * n;
+			yy += planeWeight * b * b; yz += planeWeight * b * n; zz += planeWeight * n * n;
+			x += planeWeight * a * d; y += planeWeight * b * d; z += planeWeight * n * d;
+			c += planeWeight * d * d;
+			weight += planeWeight;
+		}
+
+		void Add(const Quadric& other)
+		{
+			xx += other.xx; xy += other.xy; xz += other.xz;
+			yy += other.yy; yz += other.yz; zz += other.zz;
+			x += other.x; y += other.y; z += other.z;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		double Evaluate(const Vector3& p) const
+		{
+			const double px = p.x;
+			const double py = p.y;
+			const double pz = p.z;
+			const double error =
+				(xx * px * px) + (2.0 * xy * px * py) + (2.0 * xz * px * pz) +
+				(yy * py * py) + (2.0 * yz * py * pz) + (zz * pz * pz) +
+				(2.0 * ((x * px) + (y * py) + (z * pz))) + c;
+			return (weight > 0.0) ? std::abs(error) / weight : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		uint32_t from = 0;
+		uint32_t to = 0;
+		double error = 0.0;
+		uint32_t seamFrom = NoVertex;	// the other side of a seam moves along with from
+		uint32_t seamTo = NoVertex;
+	};
+
+	uint64_t GetEdgeKey(uint32_t a, uint32_t b)
+	{
+		return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+	}
+
+	uint64_t GetHalfEdgeKey(uint32_t from, uint32_t to)
+	{
+		return (static_cast<uint64_t>(from) << 32) | to;
+	}
+
+	struct PositionHash
+	{
+		size_t operator()(const Vector3& p) const
+		{
+			uint32_t bits[3];
+			memcpy(bits, &p, sizeof(bits));
+			return static_cast<size_t>((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u));
+		}
+	};
+
+	struct PositionEqual
+	{
+		bool operator()(const Vector3& a, const Vector3& b) const
+		{
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+	};
+
+	// per vertex list of the triangles using it, rebuilt every pass
+	struct TriangleAdjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+
+		void Build(const std::vector<uint32_t>& indices, size_t vertexCount)
+		{
+			offsets.assign(vertexCount + 1, 0);
+			triangles.resize(indices.size());
+			for (uint32_t index : indices)
+			{
+				++offsets[index + 1];
+			}
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				offsets[v + 1] += offsets[v];
+			}
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+	};
+
+	// half edges without a twin in index space, on open borders and on both sides of a seam.
+	// openIn and openOut hold the vertex across the single open edge of each vertex, NoVertex or ManyVertices.
+	void FindOpenEdges(const std::vector<uint32_t>& indices, size_t vertexCount, std::unordered_set<uint64_t>& halfEdges, std::vector<uint32_t>& openIn, std::vector<uint32_t>& openOut)
+	{
+		halfEdges.clear();
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			halfEdges.insert(GetHalfEdgeKey(indices[i], indices[(i / 3) * 3 + ((i % 3) + 1) % 3]));
+		}
+
+		auto setOpen = [](uint32_t& slot, uint32_t v)
+		{
+			slot = (slot == NoVertex) ? v : ManyVertices;
+		};
+
+		openIn.assign(vertexCount, NoVertex);
+		openOut.assign(vertexCount, NoVertex);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			const uint32_t a = indices[i];
+			const uint32_t b = indices[(i / 3) * 3 + ((i % 3) + 1) % 3];
+			if (halfEdges.count(GetHalfEdgeKey(b, a)) == 0)
+			{
+				setOpen(openOut[a], b);
+				setOpen(openIn[b], a);
+			}
+		}
+	}
+
+	bool IsSingle(uint32_t v)
+	{
+		return v != NoVertex && v != ManyVertices;
+	}
+
+	std::vector<VertexKind> ClassifyVertices(const std::vector<uint32_t>& indices, const std::vector<Vector3>& positions, std::vector<bool>& borderEdges, std::vector<uint32_t>& wedges, std::vector<uint32_t>& partners)
+	{
+		const size_t vertexCount = positions.size();
+
+		// vertices sharing a position form a wedge, the first one represents the group
+		std::unordered_map<Vector3, uint32_t, PositionHash, PositionEqual> positionToWedge;
+		positionToWedge.reserve(vertexCount);
+		std::vector<uint32_t> wedgeSizes(vertexCount, 0);
+		wedges.resize(vertexCount);
+		for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v)
+		{
+			wedges[v] = positionToWedge.emplace(positions[v], v).first->second;
+			++wedgeSizes[wedges[v]];
+		}
+
+		// edges are counted on wedges so uv seams don't look like open borders
+		std::unordered_map<uint64_t, uint32_t> edgeCounts;
+		edgeCounts.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int e = 0; e < 3; ++e)
+			{
+				const uint32_t a = wedges[indices[i + e]];
+				const uint32_t b = wedges[indices[i + ((e + 1) % 3)]];
+				if (a != b)
+				{
+					++edgeCounts[GetEdgeKey(a, b)];
+				}
+			}
+		}
+
+		std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+		borderEdges.assign(indices.size(), false);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int e = 0; e < 3; ++e)
+			{
+				const uint32_t a = indices[i + e];
+				const uint32_t b = indices[i + ((e + 1) % 3)];
+				if (wedges[a] == wedges[b])
+				{
+					continue;
+				}
+
+				const uint32_t count = edgeCounts[GetEdgeKey(wedges[a], wedges[b])];
+				if (count == 1)
+				{
+					borderEdges[i + e] = true;
+					for (uint32_t v : { a, b })
+					{
+						if (kinds[v] == VertexKind::Manifold)
+						{
+							kinds[v] = VertexKind::Border;
+						}
+					}
+				}
+				else if (count > 2)
+				{
+					kinds[a] = VertexKind::Locked;
+					kinds[b] = VertexKind::Locked;
+				}
+			}
+		}
+
+		// a vertex pair at one position is a seam when each copy has one open edge in and out and
+		// the two copies run along the same edges in opposite directions. Everything else sharing a
+		// position is locked, and so are the ends of a seam, where single vertices touch open edges.
+		std::unordered_set<uint64_t> halfEdges;
+		std::vector<uint32_t> openIn;
+		std::vector<uint32_t> openOut;
+
+		// a pole or cone tip split into many uv copies leaves the edges around it open in index space,
+		// but the vertices next to it aren't seam ends, so those are checked with the copies merged
+		std::vector<uint32_t> mergedIndices(indices.size());
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			const uint32_t v = indices[i];
+			mergedIndices[i] = (wedgeSizes[wedges[v]] > 2) ? wedges[v] : v;
+		}
+		std::vector<uint32_t> mergedOpenIn;
+		std::vector<uint32_t> mergedOpenOut;
+		FindOpenEdges(mergedIndices, vertexCount, halfEdges, mergedOpenIn, mergedOpenOut);
+		FindOpenEdges(indices, vertexCount, halfEdges, openIn, openOut);
+
+		partners.assign(vertexCount, NoVertex);
+		for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v)
+		{
+			if (wedges[v] != v && wedgeSizes[wedges[v]] == 2)
+			{
+				partners[v] = wedges[v];
+				partners[wedges[v]] = v;
+			}
+		}
+		for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v)
+		{
+			const uint32_t wedgeSize = wedgeSizes[wedges[v]];
+			if (wedgeSize == 1)
+			{
+				if (kinds[v] == VertexKind::Manifold && mergedOpenOut[v] != NoVertex)
+				{
+					kinds[v] = VertexKind::Locked;
+				}
+			}
+			else if (wedgeSize > 2)
+			{
+				kinds[v] = VertexKind::Locked;
+			}
+			else if (wedges[v] == v)
+			{
+				// both copies are decided together by the first one
+				const uint32_t partner = partners[v];
+				const bool isSeam =
+					kinds[v] == VertexKind::Manifold && kinds[partner] == VertexKind::Manifold &&
+					IsSingle(openIn[v]) && IsSingle(openOut[v]) && IsSingle(openIn[partner]) && IsSingle(openOut[partner]) &&
+					wedges[openOut[v]] == wedges[openIn[partner]] && wedges[openIn[v]] == wedges[openOut[partner]];
+				kinds[v] = isSeam ? VertexKind::Seam : VertexKind::Locked;
+				kinds[partner] = kinds[v];
+			}
+		}
+		return kinds;
+	}
+
+	// true if any corner of the triangle sits at the position of v, so moving onto v removes it
+	bool TouchesWedge(const uint32_t* triangle, const std::vector<uint32_t>& wedges, uint32_t v)
+	{
+		return wedges[triangle[0]] == wedges[v] || wedges[triangle[1]] == wedges[v] || wedges[triangle[2]] == wedges[v];
+	}
+
+	// true if moving from onto to turns any remaining triangle around from upside down
+	bool FlipsTriangle(const std::vector<uint32_t>& indices, const std::vector<Vector3>& positions, const std::vector<uint32_t>& wedges, const TriangleAdjacency& adjacency, uint32_t from, uint32_t to)
+	{
+		for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; ++i)
+		{
+			const uint32_t* triangle = &indices[adjacency.triangles[i] * 3];
+			if (TouchesWedge(triangle, wedges, to))
+			{
+				// this one collapses away
+				continue;
+			}
+
+			Vector3 corners[3];
+			Vector3 movedCorners[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				corners[k] = positions[triangle[k]];
+				movedCorners[k] = (triangle[k] == from) ? positions[to] : corners[k];
+			}
+			const Vector3 normal = Cross(corners[1] - corners[0], corners[2] - corners[0]);
+			const Vector3 movedNormal = Cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+			if (Dot(normal, movedNormal) <= 0.0f)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<uint32_t>& indices, const std::vector<Vector3>& positions, size_t targetIndexCount, float targetError, float* resultError)
+{
+	ASSERT(indices.size() % 3 == 0, "MeshSimplifier: index count must be a multiple of 3");
+	const size_t vertexCount = positions.size();
+
+	// slivers with two corners at one position (sphere poles, welded seams) have no area but would
+	// count as a third triangle on the edge they share with their neighbours and lock it
+	const PositionEqual samePosition;
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const Vector3& p0 = positions[indices[i + 0]];
+		const Vector3& p1 = positions[indices[i + 1]];
+		const Vector3& p2 = positions[indices[i + 2]];
+		if (!samePosition(p0, p1) && !samePosition(p1, p2) && !samePosition(p0, p2))
+		{
+			result.insert(result.end(), &indices[i], &indices[i] + 3);
+		}
+	}
+
+	std::vector<bool> borderEdges;
+	std::vector<uint32_t> wedges;
+	std::vector<uint32_t> partners;
+	const std::vector<VertexKind> kinds = ClassifyVertices(result, positions, borderEdges, wedges, partners);
+
+	// area weighted triangle planes, plus the border planes
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		const Vector3& p0 = positions[result[i + 0]];
+		const Vector3& p1 = positions[result[i + 1]];
+		const Vector3& p2 = positions[result[i + 2]];
+		const Vector3 normal = Cross(p1 - p0, p2 - p0);
+		const float doubleArea = Magnitude(normal);
+		if (doubleArea <= 0.0f)
+		{
+			continue;
+		}
+
+		const Vector3 unitNormal = normal / doubleArea;
+		for (int k = 0; k < 3; ++k)
+		{
+			quadrics[result[i + k]].AddPlane(unitNormal, p0, doubleArea * 0.5);
+		}
+
+		for (int e = 0; e < 3; ++e)
+		{
+			if (!borderEdges[i + e])
+			{
+				continue;
+			}
+			const uint32_t a = result[i + e];
+			const uint32_t b = result[i + ((e + 1) % 3)];
+			const Vector3 edge = positions[b] - positions[a];
+			const float edgeLength = Magnitude(edge);
+			if (edgeLength <= 0.0f)
+			{
+				continue;
+			}
+			const Vector3 borderNormal = Normalize(Cross(edge, unitNormal));
+			const double weight = BorderWeight * edgeLength * edgeLength;
+			quadrics[a].AddPlane(borderNormal, positions[a], weight);
+			quadrics[b].AddPlane(borderNormal, positions[a], weight);
+		}
+	}
+
+	// border edges are looked up by vertex pair once the indices start moving
+	std::unordered_set<uint64_t> borderEdgeKeys;
+	for (size_t i = 0; i < result.size(); ++i)
+	{
+		if (borderEdges[i])
+		{
+			borderEdgeKeys.insert(GetEdgeKey(result[i], result[(i / 3) * 3 + ((i % 3) + 1) % 3]));
+		}
+	}
+
+	std::unordered_set<uint64_t> halfEdges;
+	std::vector<uint32_t> openIn;
+	std::vector<uint32_t> openOut;
+
+	// fills in the seam partners for Seam vertices, which only move along their open edges
+	// while the partner follows along the matching edge on the other side
+	auto canCollapse = [&](uint32_t from, uint32_t to, Collapse& collapse)
+	{
+		collapse = { from, to };
+		switch (kinds[from])
+		{
+		case VertexKind::Manifold: return true;
+		case VertexKind::Border: return kinds[to] != VertexKind::Manifold && borderEdgeKeys.count(GetEdgeKey(from, to)) > 0;
+		case VertexKind::Seam:
+		{
+			if (kinds[to] != VertexKind::Seam && kinds[to] != VertexKind::Locked)
+			{
+				return false;
+			}
+			const uint32_t partner = partners[from];
+			uint32_t partnerTo = NoVertex;
+			if (openOut[from] == to)
+			{
+				partnerTo = openIn[partner];
+			}
+			else if (openIn[from] == to)
+			{
+				partnerTo = openOut[partner];
+			}
+			if (!IsSingle(partnerTo) || wedges[partnerTo] != wedges[to])
+			{
+				return false;
+			}
+			collapse.seamFrom = partner;
+			collapse.seamTo = partnerTo;
+			return true;
+		}
+		default: return false;
+		}
+	};
+
+	// a seam collapse is measured on the surface of both sides
+	auto evaluate = [&](Collapse& collapse)
+	{
+		Quadric quadric = quadrics[collapse.from];
+		quadric.Add(quadrics[collapse.to]);
+		if (collapse.seamFrom != NoVertex)
+		{
+			quadric.Add(quadrics[collapse.seamFrom]);
+			quadric.Add(quadrics[collapse.seamTo]);
+		}
+		collapse.error = quadric.Evaluate(positions[collapse.to]);
+	};
+
+	const double maxError = static_cast<double>(targetError) * static_cast<double>(targetError);
+	double reachedError = 0.0;
+
+	TriangleAdjacency adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<bool> locked(vertexCount, false);
+	std::vector<uint32_t> remap(vertexCount);
+
+	// every pass collapses an independent set of the cheapest edges, then rebuilds the indices
+	while (result.size() > targetIndexCount)
+	{
+		adjacency.Build(result, vertexCount);
+		FindOpenEdges(result, vertexCount, halfEdges, openIn, openOut);
+
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); ++i)
+		{
+			const uint32_t a = result[i];
+			const uint32_t b = result[(i / 3) * 3 + ((i % 3) + 1) % 3];
+
+			// interior edges show up twice, once per triangle, border and seam edges only once
+			if (a > b && halfEdges.count(GetHalfEdgeKey(b, a)) > 0)
+			{
+				continue;
+			}
+
+			Collapse collapse;
+			collapse.error = std::numeric_limits<double>::max();
+			Collapse candidate;
+			if (canCollapse(a, b, candidate))
+			{
+				evaluate(candidate);
+				collapse = candidate;
+			}
+			if (canCollapse(b, a, candidate))
+			{
+				evaluate(candidate);
+				if (candidate.error < collapse.error)
+				{
+					collapse = candidate;
+				}
+			}
+			if (collapse.error <= maxError)
+			{
+				collapses.push_back(collapse);
+			}
+		}
+		if (collapses.empty())
+		{
+			break;
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs)
+		{
+			return lhs.error < rhs.error;
+		});
+
+		std::fill(locked.begin(), locked.end(), false);
+		for (uint32_t v = 0; v < static_cast<uint32_t>(vertexCount); ++v)
+		{
+			remap[v] = v;
+		}
+
+		size_t triangleCount = result.size() / 3;
+		const size_t targetTriangleCount = targetIndexCount / 3;
+		size_t collapseCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (triangleCount <= targetTriangleCount)
+			{
+				break;
+			}
+			const bool isSeam = collapse.seamFrom != NoVertex;
+			if (locked[collapse.from] || locked[collapse.to] || (isSeam && (locked[collapse.seamFrom] || locked[collapse.seamTo])))
+			{
+				continue;
+			}
+			if (FlipsTriangle(result, positions, wedges, adjacency, collapse.from, collapse.to) ||
+				(isSeam && FlipsTriangle(result, positions, wedges, adjacency, collapse.seamFrom, collapse.seamTo)))
+			{
+				continue;
+			}
+
+			// lock the whole one ring, so the flip checks of later collapses in this pass stay valid
+			auto apply = [&](uint32_t from, uint32_t to)
+			{
+				for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; ++i)
+				{
+					const uint32_t* triangle = &result[adjacency.triangles[i] * 3];
+					triangleCount -= TouchesWedge(triangle, wedges, to) ? 1 : 0;
+					locked[triangle[0]] = true;
+					locked[triangle[1]] = true;
+					locked[triangle[2]] = true;
+				}
+				remap[from] = to;
+				quadrics[to].Add(quadrics[from]);
+			};
+			apply(collapse.from, collapse.to);
+			if (isSeam)
+			{
+				apply(collapse.seamFrom, collapse.seamTo);
+			}
+			reachedError = std::max(reachedError, collapse.error);
+			++collapseCount;
+		}
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		// a collapse next to a split vertex leaves triangles with two copies of one position, drop them too
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			const uint32_t a = remap[result[i + 0]];
+			const uint32_t b = remap[result[i + 1]];
+			const uint32_t c = remap[result[i + 2]];
+			if (wedges[a] != wedges[b] && wedges[b] != wedges[c] && wedges[a] != wedges[c])
+			{
+				result[writeIndex++] = a;
+				result[writeIndex++] = b;
+				result[writeIndex++] = c;
+			}
+		}
+		result.resize(writeIndex);
+
+		// border edges that survived keep their keys, collapsed ones just stop being looked up
+		std::unordered_set<uint64_t> remappedBorderEdges;
+		for (uint64_t key : borderEdgeKeys)
+		{
+			const uint32_t a = remap[static_cast<uint32_t>(key >> 32)];
+			const uint32_t b = remap[static_cast<uint32_t>(key & 0xFFFFFFFF)];
+			if (a != b)
+			{
+				remappedBorderEdges.insert(GetEdgeKey(a, b));
+			}
+		}
+		borderEdgeKeys = std::move(remappedBorderEdges);
+	}
+
+	if (resultError != nullptr)
+	{
+		*resultError = static_cast<float>(std::sqrt(reachedError));
+	}
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "Precompiled.h"
+#include "Meshlet.h"
+
+#include "Camera.h"
+#include "Frustum.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	constexpr uint8_t NotInMeshlet = 0xFF;
+	constexpr uint32_t NoTriangle = ~0u;
+
+	// cones wider than this (minimum normal dot under 0.1) can't be culled in practice
+	constexpr float MinConeDot = 0.1f;
+
+	constexpr uint32_t MinMeshletsPerBatch = 256;
+
+	void ForEach(uint32_t count, const Core::ParallelUtil::RangeFunc& func)
+	{
+		const uint32_t batchSize = std::max(MinMeshletsPerBatch, count / (Core::ParallelUtil::GetWorkerCount() * 4));
+		Core::ParallelUtil::ParallelFor(count, batchSize, func);
+	}
+
+	MeshletBounds ComputeBounds(const MeshletMesh& mesh, const Meshlet& meshlet, const std::vector<Vector3>& positions)
+	{
+		MeshletBounds bounds;
+
+		Vector3 minExtent = positions[mesh.vertices[meshlet.vertexOffset]];
+		Vector3 maxExtent = minExtent;
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		{
+			const Vector3& p = positions[mesh.vertices[meshlet.vertexOffset + i]];
+			minExtent = { std::min(minExtent.x, p.x), std::min(minExtent.y, p.y), std::min(minExtent.z, p.z) };
+			maxExtent = { std::max(maxExtent.x, p.x), std::max(maxExtent.y, p.y), std::max(maxExtent.z, p.z) };
+		}
+		bounds.center = (minExtent + maxExtent) * 0.5f;
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		{
+			bounds.radius = std::max(bounds.radius, Magnitude(positions[mesh.vertices[meshlet.vertexOffset + i]] - bounds.center));
+		}
+
+		std::vector<Vector3> normals;
+		normals.reserve(meshlet.triangleCount);
+		Vector3 axis = Vector3::Zero;
+		for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+		{
+			const uint8_t* triangle = &mesh.triangles[(meshlet.triangleOffset + t) * 3];
+			const Vector3& p0 = positions[mesh.vertices[meshlet.vertexOffset + triangle[0]]];
+			const Vector3& p1 = positions[mesh.vertices[meshlet.vertexOffset + triangle[1]]];
+			const Vector3& p2 = positions[mesh.vertices[meshlet.vertexOffset + triangle[2]]];
+			const Vector3 normal = Cross(p1 - p0, p2 - p0);
+			const float length = Magnitude(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		const float axisLength = Magnitude(axis);
+		if (normals.empty() || axisLength <= 0.0f)
+		{
+			return bounds;
+		}
+		axis /= axisLength;
+
+		float minDot = 1.0f;
+		for (const Vector3& normal : normals)
+		{
+			minDot = std::min(minDot, Dot(axis, normal));
+		}
+		if (minDot >= MinConeDot)
+		{
+			// sine of the cone's half angle, back facing once the view direction is within 90 degrees minus that
+			bounds.coneAxis = axis;
+			bounds.coneCutoff = sqrtf(1.0f - (minDot * minDot));
+		}
+		return bounds;
+	}
+}
+
+MeshletMesh MeshletBuilder::Build(const std::vector<uint32_t>& indices, const std::vector<Vector3>& positions)
+{
+	ASSERT(indices.size() % 3 == 0, "MeshletBuilder: index count must be a multiple of 3");
+	const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+	// triangles around each vertex, and how many of them are still waiting for a meshlet
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (uint32_t index : indices)
+	{
+		++offsets[index + 1];
+	}
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); ++i)
+		{
+			adjacency[fill[indices[i]]++] = i / 3;
+		}
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			liveTriangles[v] = offsets[v + 1] - offsets[v];
+		}
+	}
+
+	MeshletMesh result;
+	result.meshlets.reserve((triangleCount / MaxTriangles) + 1);
+	result.vertices.reserve(indices.size() / 2);
+	result.triangles.reserve(indices.size());
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint8_t> localIndices(vertexCount, NotInMeshlet);
+	Meshlet meshlet;
+	uint32_t cursor = 0;
+
+	auto finishMeshlet = [&]()
+	{
+		for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+		{
+			localIndices[result.vertices[meshlet.vertexOffset + i]] = NotInMeshlet;
+		}
+		result.meshlets.push_back(meshlet);
+		meshlet.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+		meshlet.triangleOffset = static_cast<uint32_t>(result.triangles.size() / 3);
+		meshlet.vertexCount = 0;
+		meshlet.triangleCount = 0;
+	};
+
+	auto getNewVertexCount = [&](uint32_t triangle)
+	{
+		const uint32_t* corners = &indices[triangle * 3];
+		return (localIndices[corners[0]] == NotInMeshlet ? 1u : 0u) +
+			(localIndices[corners[1]] == NotInMeshlet ? 1u : 0u) +
+			(localIndices[corners[2]] == NotInMeshlet ? 1u : 0u);
+	};
+
+	for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		// the neighbouring triangle that adds the fewest vertices, ties keep the input order
+		uint32_t best = NoTriangle;
+		uint32_t bestNewVertices = 4;
+		for (uint32_t i = 0; i < meshlet.vertexCount && bestNewVertices > 0; ++i)
+		{
+			const uint32_t v = result.vertices[meshlet.vertexOffset + i];
+			if (liveTriangles[v] == 0)
+			{
+				continue;
+			}
+			for (uint32_t a = offsets[v]; a < offsets[v + 1]; ++a)
+			{
+				const uint32_t triangle = adjacency[a];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+				const uint32_t newVertices = getNewVertexCount(triangle);
+				if (newVertices < bestNewVertices || (newVertices == bestNewVertices && triangle < best))
+				{
+					best = triangle;
+					bestNewVertices = newVertices;
+				}
+			}
+		}
+
+		if (best == NoTriangle)
+		{
+			// the meshlet is cut off from the rest, start over at the next triangle in order
+			while (emitted[cursor])
+			{
+				++cursor;
+			}
+			best = cursor;
+			bestNewVertices = getNewVertexCount(best);
+		}
+
+		if (meshlet.vertexCount + bestNewVertices > MaxVertices || meshlet.triangleCount + 1 > MaxTriangles)
+		{
+			finishMeshlet();
+			bestNewVertices = 3;
+		}
+
+		emitted[best] = true;
+		for (int k = 0; k < 3; ++k)
+		{
+			const uint32_t v = indices[(best * 3) + k];
+			if (localIndices[v] == NotInMeshlet)
+			{
+				localIndices[v] = static_cast<uint8_t>(meshlet.vertexCount++);
+				result.vertices.push_back(v);
+			}
+			result.triangles.push_back(localIndices[v]);
+			--liveTriangles[v];
+		}
+		++meshlet.triangleCount;
+	}
+	if (meshlet.triangleCount > 0)
+	{
+		finishMeshlet();
+	}
+
+	result.bounds.resize(result.meshlets.size());
+	ForEach(static_cast<uint32_t>(result.meshlets.size()), [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			result.bounds[i] = ComputeBounds(result, result.meshlets[i], positions);
+		}
+	});
+	return result;
+}
+
+MeshletCullStats MeshletCuller::Cull(const MeshletMesh& mesh, const Matrix4& world, const Camera& camera, std::vector<uint32_t>& indices)
+{
+	const uint32_t meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+	const Frustum frustum(world * camera.GetViewMatrix() * camera.GetProjectionMatrix());
+	const Vector3& cameraPosition = camera.GetPosition();
+
+	// bounding radii grow with the largest axis scale of the world matrix
+	const float radiusScale = sqrtf(std::max({
+		MagnitudeSqr({ world._11, world._12, world._13 }),
+		MagnitudeSqr({ world._21, world._22, world._23 }),
+		MagnitudeSqr({ world._31, world._32, world._33 }) }));
+
+	enum class Visibility : uint8_t { Visible, OutsideFrustum, BackFacing };
+	std::vector<Visibility> visibility(meshletCount);
+	ForEach(meshletCount, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const MeshletBounds& bounds = mesh.bounds[i];
+
+			// frustum planes are in object space already, they were built with the world matrix
+			visibility[i] = frustum.IsSphereVisible(bounds.center, bounds.radius) ? Visibility::Visible : Visibility::OutsideFrustum;
+			if (visibility[i] != Visibility::Visible || bounds.coneCutoff >= 1.0f)
+			{
+				continue;
+			}
+
+			const Vector3 center = TransformCoord(bounds.center, world);
+			const Vector3 axis = Normalize(TransformNormal(bounds.coneAxis, world));
+			const Vector3 view = center - cameraPosition;
+			if (Dot(view, axis) >= (bounds.coneCutoff * Magnitude(view)) + (bounds.radius * radiusScale))
+			{
+				visibility[i] = Visibility::BackFacing;
+			}
+		}
+	});
+
+	MeshletCullStats stats;
+	std::vector<uint32_t> firstIndices(meshletCount);
+	uint32_t indexCount = 0;
+	for (uint32_t i = 0; i < meshletCount; ++i)
+	{
+		firstIndices[i] = indexCount;
+		switch (visibility[i])
+		{
+		case Visibility::Visible:
+			++stats.visibleMeshlets;
+			stats.visibleTriangles += mesh.meshlets[i].triangleCount;
+			indexCount += mesh.meshlets[i].triangleCount * 3;
+			break;
+		case Visibility::OutsideFrustum: ++stats.frustumCulled; break;
+		case Visibility::BackFacing: ++stats.backfaceCulled; break;
+		}
+	}
+
+	indices.resize(indexCount);
+	ForEach(meshletCount, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			if (visibility[i] != Visibility::Visible)
+			{
+				continue;
+			}
+			const Meshlet& meshlet = mesh.meshlets[i];
+			const uint32_t* vertices = mesh.vertices.data() + meshlet.vertexOffset;
+			const uint8_t* triangles = mesh.triangles.data() + (meshlet.triangleOffset * 3);
+			uint32_t* output = indices.data() + firstIndices[i];
+			for (uint32_t j = 0; j < meshlet.triangleCount * 3; ++j)
+			{
+				output[j] = vertices[triangles[j]];
+			}
+		}
+	});
+	return stats;
+}
\ No newline at end of file
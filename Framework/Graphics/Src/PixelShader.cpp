@@ -1,44 +1,81 @@
 #include "Precompiled.h"
 #include "PixelShader.h"
 #include "GraphicsSystem.h"
+#include "HotReload.h"
+#include "ShaderArchive.h"
+#include "ShaderCache.h"
 
 using namespace SumEngine;
 using namespace SumEngine::Graphics;
 
-void PixelShader::Initialize(const std::filesystem::path& filePath)
+namespace
 {
-	auto device = GraphicsSystem::Get()->GetDevice();
-	DWORD shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
-	ID3DBlob* shaderBlob = nullptr;
-	ID3DBlob* errorBlob = nullptr;
-	HRESULT hr = D3DCompileFromFile(
-		filePath.c_str(),
-		nullptr,
-		D3D_COMPILE_STANDARD_FILE_INCLUDE,
-		"PS", "ps_5_0",
-		shaderFlags, 0,
-		&shaderBlob,
-		&errorBlob
-	);
-	if (errorBlob != nullptr && errorBlob->GetBufferPointer() != nullptr)
+	// the device is free threaded, hot reload also calls this from its worker thread
+	bool CreatePixelShader(Core::Span<const uint8_t> bytecode, ID3D11PixelShader** pixelShader)
 	{
-		LOG("%s", static_cast<const char*>(errorBlob->GetBufferPointer()));
+		auto device = GraphicsSystem::Get()->GetDevice();
+		HRESULT hr = device->CreatePixelShader(
+			bytecode.data(),
+			bytecode.size(),
+			nullptr,
+			pixelShader
+		);
+		if (FAILED(hr))
+		{
+			LOG("PixelShader: failed to create pixel shader");
+			return false;
+		}
+		return true;
 	}
-	ASSERT(SUCCEEDED(hr), "Fialed to compile pixel shader");
-
-	hr = device->CreatePixelShader(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		nullptr,
-		&mPixelShader
-	);
-	ASSERT(SUCCEEDED(hr), "Failed to create pixel shader");
-	SafeRelease(shaderBlob);
-	SafeRelease(errorBlob);
+}
+
+void PixelShader::Initialize(const std::filesystem::path& filePath, uint32_t permutation)
+{
+	ShaderCompileDesc compileDesc;
+	compileDesc.filePath = filePath;
+	compileDesc.entryPoint = "PS";
+	compileDesc.profile = "ps_5_0";
+	compileDesc.permutation = permutation;
+	compileDesc.flags = ShaderCache::GetDefaultFlags();
+	std::vector<uint8_t> bytecode;
+	const bool compiled = ShaderCache::Compile(compileDesc, bytecode);
+	ASSERT(compiled, "Failed to compile pixel shader");
+
+	const bool created = CreatePixelShader(bytecode, &mPixelShader);
+	ASSERT(created, "Failed to create pixel shader");
+
+	// recompile when the source changes, the new shader is swapped in by HotReload::Update
+	HotReload::Register(this, { filePath }, [this, compileDesc]()
+	{
+		std::vector<uint8_t> bytecode;
+		ID3D11PixelShader* pixelShader = nullptr;
+		if (!ShaderCache::Compile(compileDesc, bytecode) || !CreatePixelShader(bytecode, &pixelShader))
+		{
+			return HotReload::ApplyFunc();
+		}
+		return HotReload::ApplyFunc([this, pixelShader](bool commit) mutable
+		{
+			if (commit)
+			{
+				std::swap(mPixelShader, pixelShader);
+			}
+			SafeRelease(pixelShader);
+		});
+	});
+}
+
+void PixelShader::Initialize(const ShaderArchive& archive, uint32_t permutation)
+{
+	const Core::Span<const uint8_t> bytecode = archive.GetBytecode(ShaderArchiveFile::Stage::Pixel, permutation);
+	ASSERT(!bytecode.empty(), "PixelShader: permutation %u is not in the archive", permutation);
+
+	const bool created = CreatePixelShader(bytecode, &mPixelShader);
+	ASSERT(created, "Failed to create pixel shader");
 }
 
 void PixelShader::Terminate()
 {
+	HotReload::Unregister(this);
 	SafeRelease(mPixelShader);
 }
 
@@ -46,4 +83,4 @@ void PixelShader::Bind()
 {
 	auto context = GraphicsSystem::Get()->GetContext();
 	context->PSSetShader(mPixelShader, nullptr, 0);
-}
+}
\ No newline at end of file
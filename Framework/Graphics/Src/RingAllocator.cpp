@@ -0,0 +1,89 @@
+#include "Precompiled.h"
+#include "RingAllocator.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+void RingAllocator::Initialize(uint32_t capacity)
+{
+	ASSERT(capacity > 0, "RingAllocator: capacity must not be 0");
+	mCapacity = capacity;
+	Reset();
+}
+
+void RingAllocator::Reset()
+{
+	mFrames.clear();
+	mHead = 0;
+	mTail = 0;
+	mUsedSize = 0;
+	mFrameSize = 0;
+}
+
+RingAllocator::Allocation RingAllocator::Allocate(uint32_t size, uint32_t alignment)
+{
+	ASSERT(alignment > 0, "RingAllocator: alignment must not be 0");
+
+	Allocation allocation;
+	if (size == 0 || size > mCapacity)
+	{
+		return allocation;
+	}
+
+	if (mUsedSize == 0 && mFrames.empty())
+	{
+		mHead = 0;
+		mTail = 0;
+	}
+
+	// any alignment works, vertex strides like 28 are not powers of 2
+	const uint64_t alignedHead = ((static_cast<uint64_t>(mHead) + alignment - 1) / alignment) * alignment;
+	uint32_t takenSize = 0;
+	if (mHead > mTail || mUsedSize == 0)
+	{
+		// free space is [head, capacity) followed by [0, tail)
+		if (alignedHead + size <= mCapacity)
+		{
+			allocation.offset = static_cast<uint32_t>(alignedHead);
+			takenSize = static_cast<uint32_t>(alignedHead - mHead) + size;
+		}
+		else if (size <= mTail)
+		{
+			allocation.offset = 0;
+			allocation.wrapped = true;
+			takenSize = (mCapacity - mHead) + size;	// the end of the ring is skipped
+		}
+	}
+	else if (mHead < mTail && alignedHead + size <= mTail)
+	{
+		// free space is [head, tail)
+		allocation.offset = static_cast<uint32_t>(alignedHead);
+		takenSize = static_cast<uint32_t>(alignedHead - mHead) + size;
+	}
+
+	if (allocation.offset != InvalidOffset)
+	{
+		mHead = allocation.offset + size;
+		mUsedSize += takenSize;
+		mFrameSize += takenSize;
+	}
+	return allocation;
+}
+
+void RingAllocator::EndFrame(uint64_t fence)
+{
+	ASSERT(mFrames.empty() || mFrames.back().fence < fence, "RingAllocator: fences must increase");
+	mFrames.push_back({ fence, mHead, mFrameSize });
+	mFrameSize = 0;
+}
+
+void RingAllocator::Release(uint64_t completedFence)
+{
+	while (!mFrames.empty() && mFrames.front().fence <= completedFence)
+	{
+		const Frame& frame = mFrames.front();
+		mUsedSize -= frame.size;
+		mTail = frame.end;
+		mFrames.pop_front();
+	}
+}
\ No newline at end of file
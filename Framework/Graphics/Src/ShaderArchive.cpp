@@ -0,0 +1,74 @@
+#include "Precompiled.h"
+#include "ShaderArchive.h"
+
+#include "ShaderPermutation.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+void ShaderArchive::Initialize(const std::filesystem::path& filePath)
+{
+	using namespace ShaderArchiveFile;
+
+	Terminate();
+	if (!mFile.Open(filePath, Core::MappedFile::Access::Random))
+	{
+		ASSERT(false, "ShaderArchive: failed to open %ls", filePath.c_str());
+		return;
+	}
+
+	const Core::Span<const uint8_t> data = mFile.GetData();
+	const Header* header = reinterpret_cast<const Header*>(data.data());
+	if (data.size() < sizeof(Header) || header->magic != Magic || header->version != Version ||
+		header->keywordCount > ShaderPermutation::MaxKeywords ||
+		data.size() < sizeof(Header) + (header->keywordCount * sizeof(Keyword)) + (header->entryCount * sizeof(Entry)))
+	{
+		ASSERT(false, "ShaderArchive: invalid archive %ls", filePath.c_str());
+		mFile.Close();
+		return;
+	}
+
+	const Keyword* keywords = reinterpret_cast<const Keyword*>(data.data() + sizeof(Header));
+	for (uint32_t i = 0; i < header->keywordCount; ++i)
+	{
+		mKeywords.emplace_back(keywords[i].name, strnlen(keywords[i].name, MaxKeywordLength));
+	}
+
+	const Entry* entries = reinterpret_cast<const Entry*>(keywords + header->keywordCount);
+	for (uint32_t i = 0; i < header->entryCount; ++i)
+	{
+		if (entries[i].offset + entries[i].size > data.size())
+		{
+			ASSERT(false, "ShaderArchive: invalid archive %ls", filePath.c_str());
+			Terminate();
+			return;
+		}
+	}
+	mEntries = { entries, header->entryCount };
+}
+
+void ShaderArchive::Terminate()
+{
+	mEntries = {};
+	mKeywords.clear();
+	mFile.Close();
+}
+
+uint32_t ShaderArchive::GetPermutation(std::initializer_list<std::string_view> keywords) const
+{
+	return ShaderPermutation::GetPermutation(mKeywords, keywords);
+}
+
+Core::Span<const uint8_t> ShaderArchive::GetBytecode(ShaderArchiveFile::Stage stage, uint32_t permutation) const
+{
+	ShaderArchiveFile::Entry key;
+	key.stage = stage;
+	key.permutation = permutation;
+
+	auto iter = std::lower_bound(mEntries.begin(), mEntries.end(), key);
+	if (iter == mEntries.end() || iter->stage != stage || iter->permutation != permutation)
+	{
+		return {};
+	}
+	return mFile.GetData().subspan(static_cast<size_t>(iter->offset), static_cast<size_t>(iter->size));
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "Precompiled.h"
+#include "ShaderCache.h"
+
+#include "ShaderPermutation.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+namespace
+{
+	std::unique_ptr<ShaderCache> sShaderCache;
+
+	constexpr uint32_t CacheMagic = 0x43534D53;	// 'SMSC'
+	constexpr uint32_t CacheVersion = 1;
+	constexpr uint32_t MaxIncludeDepth = 16;
+
+	// keeps the temporary files of concurrent Store calls apart, the process id covers other instances
+	std::atomic<uint32_t> sTempFileCounter = 0;
+
+	struct CacheHeader
+	{
+		uint32_t magic = CacheMagic;
+		uint32_t version = CacheVersion;
+		uint64_t key = 0;
+		uint64_t size = 0;
+	};
+
+	// 64 bit FNV-1a
+	class Hasher
+	{
+	public:
+		void Add(const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < size; ++i)
+			{
+				mHash = (mHash ^ bytes[i]) * 0x100000001b3ull;
+			}
+		}
+		void Add(const std::string& text)
+		{
+			// the terminator keeps "ab"+"c" and "a"+"bc" apart
+			Add(text.c_str(), text.size() + 1);
+		}
+		template<class T>
+		void AddValue(const T& value)
+		{
+			Add(&value, sizeof(T));
+		}
+		uint64_t GetHash() const { return mHash; }
+
+	private:
+		uint64_t mHash = 0xcbf29ce484222325ull;
+	};
+
+	// hashes the contents of every quoted #include so editing a shared header invalidates its users
+	void HashIncludes(Hasher& hasher, Core::Span<const uint8_t> source, const std::filesystem::path& directory, uint32_t depth)
+	{
+		if (depth >= MaxIncludeDepth)
+		{
+			return;
+		}
+
+		const std::string_view text(reinterpret_cast<const char*>(source.data()), source.size());
+		size_t pos = 0;
+		while ((pos = text.find("#include", pos)) != std::string_view::npos)
+		{
+			pos += 8;
+			const size_t open = text.find_first_not_of(" \t", pos);
+			if (open == std::string_view::npos || text[open] != '"')
+			{
+				continue;
+			}
+			const size_t close = text.find('"', open + 1);
+			if (close == std::string_view::npos)
+			{
+				break;
+			}
+
+			const std::filesystem::path includePath = directory / std::string(text.substr(open + 1, close - open - 1));
+			Core::MappedFile includeFile;
+			if (includeFile.Open(includePath))
+			{
+				hasher.Add(includePath.filename().u8string());
+				hasher.Add(includeFile.GetData().data(), includeFile.GetSize());
+				HashIncludes(hasher, includeFile.GetData(), includePath.parent_path(), depth + 1);
+			}
+			pos = close;
+		}
+	}
+
+	bool CompileSource(const ShaderCompileDesc& desc, Core::Span<const uint8_t> source, std::vector<uint8_t>& bytecode)
+	{
+		const std::vector<std::string> keywords = ShaderPermutation::ParseKeywords(source);
+		ASSERT(desc.permutation < ShaderPermutation::GetPermutationCount(keywords), "ShaderCache: permutation %u is out of range for %ls", desc.permutation, desc.filePath.c_str());
+
+		std::vector<ShaderDefine> defines = ShaderPermutation::GetDefines(keywords, desc.permutation);
+		defines.insert(defines.end(), desc.defines.begin(), desc.defines.end());
+
+		std::vector<D3D_SHADER_MACRO> macros;
+		macros.reserve(defines.size() + 1);
+		for (const ShaderDefine& define : defines)
+		{
+			macros.push_back({ define.name.c_str(), define.value.c_str() });
+		}
+		macros.push_back({ nullptr, nullptr });
+
+		const std::string sourceName = desc.filePath.u8string();
+		ID3DBlob* shaderBlob = nullptr;
+		ID3DBlob* errorBlob = nullptr;
+		HRESULT hr = D3DCompile(
+			source.data(),
+			source.size(),
+			sourceName.c_str(),
+			macros.data(),
+			D3D_COMPILE_STANDARD_FILE_INCLUDE,
+			desc.entryPoint.c_str(), desc.profile.c_str(),
+			desc.flags, 0,
+			&shaderBlob,
+			&errorBlob
+		);
+		if (errorBlob != nullptr && errorBlob->GetBufferPointer() != nullptr)
+		{
+			LOG("%s", static_cast<const char*>(errorBlob->GetBufferPointer()));
+		}
+
+		if (SUCCEEDED(hr))
+		{
+			const uint8_t* data = static_cast<const uint8_t*>(shaderBlob->GetBufferPointer());
+			bytecode.assign(data, data + shaderBlob->GetBufferSize());
+		}
+		SafeRelease(shaderBlob);
+		SafeRelease(errorBlob);
+		return SUCCEEDED(hr);
+	}
+}
+
+void ShaderCache::StaticInitialize(const std::filesystem::path& cacheDirectory)
+{
+	ASSERT(sShaderCache == nullptr, "ShaderCache: is already initialized");
+	sShaderCache = std::make_unique<ShaderCache>();
+	sShaderCache->Initialize(cacheDirectory);
+}
+
+void ShaderCache::StaticTerminate()
+{
+	if (sShaderCache != nullptr)
+	{
+		sShaderCache->Terminate();
+		sShaderCache.reset();
+	}
+}
+
+ShaderCache* ShaderCache::Get()
+{
+	ASSERT(sShaderCache != nullptr, "ShaderCache: was not initialized");
+	return sShaderCache.get();
+}
+
+bool ShaderCache::Compile(const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode)
+{
+	if (sShaderCache != nullptr)
+	{
+		return sShaderCache->GetBytecode(desc, bytecode);
+	}
+
+	Core::MappedFile sourceFile;
+	if (!sourceFile.Open(desc.filePath))
+	{
+		LOG("ShaderCache: failed to open %ls", desc.filePath.c_str());
+		return false;
+	}
+	return CompileSource(desc, sourceFile.GetData(), bytecode);
+}
+
+uint32_t ShaderCache::GetDefaultFlags()
+{
+#if defined(_DEBUG)
+	return D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
+#else
+	return D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+}
+
+uint64_t ShaderCache::ComputeKey(Core::Span<const uint8_t> source, const ShaderCompileDesc& desc)
+{
+	Hasher hasher;
+	hasher.AddValue(CacheVersion);
+	hasher.AddValue(static_cast<uint32_t>(D3D_COMPILER_VERSION));
+	hasher.Add(source.data(), source.size());
+	HashIncludes(hasher, source, desc.filePath.parent_path(), 0);
+	hasher.Add(desc.entryPoint);
+	hasher.Add(desc.profile);
+	for (const ShaderDefine& define : desc.defines)
+	{
+		hasher.Add(define.name);
+		hasher.Add(define.value);
+	}
+	hasher.AddValue(desc.permutation);
+	hasher.AddValue(desc.flags);
+	return hasher.GetHash();
+}
+
+void ShaderCache::Initialize(const std::filesystem::path& cacheDirectory)
+{
+	mCacheDirectory = cacheDirectory;
+
+	std::error_code ec;
+	std::filesystem::create_directories(mCacheDirectory, ec);
+	ASSERT(!ec, "ShaderCache: failed to create %ls", mCacheDirectory.c_str());
+}
+
+void ShaderCache::Terminate()
+{
+	LOG("ShaderCache: %u hits, %u misses", mHitCount.load(), mMissCount.load());
+}
+
+bool ShaderCache::Load(uint64_t key, std::vector<uint8_t>& bytecode) const
+{
+	Core::MappedFile file;
+	if (!file.Open(GetEntryPath(key)))
+	{
+		return false;
+	}
+
+	// a stale or partially written entry is treated as a miss and overwritten
+	const Core::Span<const uint8_t> data = file.GetData();
+	if (data.size() < sizeof(CacheHeader))
+	{
+		return false;
+	}
+	const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data.data());
+	if (header->magic != CacheMagic || header->version != CacheVersion || header->key != key ||
+		header->size == 0 || header->size != data.size() - sizeof(CacheHeader))
+	{
+		return false;
+	}
+
+	const Core::Span<const uint8_t> blob = data.subspan(sizeof(CacheHeader));
+	bytecode.assign(blob.begin(), blob.end());
+	return true;
+}
+
+bool ShaderCache::Store(uint64_t key, Core::Span<const uint8_t> bytecode) const
+{
+	CacheHeader header;
+	header.key = key;
+	header.size = bytecode.size();
+
+	// write to a temporary of our own first so a crash or another writer of the same key never
+	// leaves a truncated entry behind, the rename then swaps in a complete file
+	const std::filesystem::path entryPath = GetEntryPath(key);
+	char tempSuffix[32];
+	snprintf(tempSuffix, std::size(tempSuffix), ".%lu.%u.tmp", GetCurrentProcessId(), sTempFileCounter.fetch_add(1));
+	std::filesystem::path tempPath = entryPath;
+	tempPath += tempSuffix;
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(bytecode.data()), bytecode.size());
+		if (!file.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, entryPath, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	return true;
+}
+
+std::filesystem::path ShaderCache::GetEntryPath(uint64_t key) const
+{
+	char fileName[32];
+	snprintf(fileName, std::size(fileName), "%016llx.cso", static_cast<unsigned long long>(key));
+	return mCacheDirectory / fileName;
+}
+
+bool ShaderCache::GetBytecode(const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode)
+{
+	Core::MappedFile sourceFile;
+	if (!sourceFile.Open(desc.filePath))
+	{
+		LOG("ShaderCache: failed to open %ls", desc.filePath.c_str());
+		return false;
+	}
+
+	const uint64_t key = ComputeKey(sourceFile.GetData(), desc);
+	if (Load(key, bytecode))
+	{
+		++mHitCount;
+		return true;
+	}
+
+	++mMissCount;
+	if (!CompileSource(desc, sourceFile.GetData(), bytecode))
+	{
+		return false;
+	}
+
+	if (!Store(key, bytecode))
+	{
+		LOG("ShaderCache: failed to store %ls", GetEntryPath(key).c_str());
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "Precompiled.h"
+#include "ShaderPermutation.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+
+namespace
+{
+	constexpr std::string_view KeywordTag = "@keywords";
+
+	bool IsKeywordChar(char c)
+	{
+		return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+	}
+}
+
+std::vector<std::string> ShaderPermutation::ParseKeywords(Core::Span<const uint8_t> source)
+{
+	std::vector<std::string> keywords;
+
+	const std::string_view text(reinterpret_cast<const char*>(source.data()), source.size());
+	size_t pos = 0;
+	while ((pos = text.find(KeywordTag, pos)) != std::string_view::npos)
+	{
+		pos += KeywordTag.size();
+		const size_t lineEnd = std::min(text.find('\n', pos), text.size());
+		while (pos < lineEnd)
+		{
+			if (!IsKeywordChar(text[pos]))
+			{
+				++pos;
+				continue;
+			}
+
+			const size_t start = pos;
+			while (pos < lineEnd && IsKeywordChar(text[pos]))
+			{
+				++pos;
+			}
+			std::string keyword(text.substr(start, pos - start));
+			if (std::find(keywords.begin(), keywords.end(), keyword) == keywords.end())
+			{
+				keywords.push_back(std::move(keyword));
+			}
+		}
+	}
+
+	ASSERT(keywords.size() <= MaxKeywords, "ShaderPermutation: too many keywords (%zu), max is %u", keywords.size(), MaxKeywords);
+	if (keywords.size() > MaxKeywords)
+	{
+		keywords.resize(MaxKeywords);
+	}
+	return keywords;
+}
+
+std::vector<ShaderDefine> ShaderPermutation::GetDefines(const std::vector<std::string>& keywords, uint32_t permutation)
+{
+	std::vector<ShaderDefine> defines;
+	defines.reserve(keywords.size());
+	for (size_t i = 0; i < keywords.size(); ++i)
+	{
+		defines.push_back({ keywords[i], (permutation & (1u << i)) ? "1" : "0" });
+	}
+	return defines;
+}
+
+uint32_t ShaderPermutation::GetPermutation(const std::vector<std::string>& keywords, std::initializer_list<std::string_view> enabled)
+{
+	uint32_t permutation = 0;
+	for (std::string_view name : enabled)
+	{
+		for (size_t i = 0; i < keywords.size(); ++i)
+		{
+			if (keywords[i] == name)
+			{
+				permutation |= 1u << i;
+			}
+		}
+	}
+	return permutation;
+}
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "Camera.h"
 #include "VertexTypes.h"
 #include "BlendState.h"
+#include "DepthStencilState.h"
+#include "DynamicRingBuffer.h"
+#include "GraphicsSystem.h"
 
 using namespace SumEngine;
 using namespace SumEngine::Graphics;
@@ -16,109 +19,784 @@ using namespace SumEngine::Math::Constants;
 
 namespace
 {
+	// Shapes drawn with instancing, each one is built once per tessellation around the origin
+	// and placed by the instance transform
+	enum class UnitShape : uint32_t
+	{
+		WireSphere,		// latitude rings of a unit sphere around y
+		FilledSphere,
+		FilledCone,		// unit circle in xz with the tip at (0, 1, 0)
+		WireBox			// [0, 1] cube
+	};
+
+	constexpr uint32_t MaxInstancesPerBatch = 256;	// matches DoInstancedTransform.fx
+	constexpr uint32_t MaxInstancesPerFrame = 1 << 18;
+	constexpr uint64_t OverlayShapeBit = 1ull << 63;	// sorts overlay instances after the scene ones
+
+	struct InstanceData
+	{
+		Matrix4 world;	// transposed for the shader
+		Color color;
+	};
+	static_assert(sizeof(InstanceData) == 80, "SimpleDraw: InstanceData must match the shader layout");
+
+	struct InstanceRecord
+	{
+		uint64_t shapeKey = 0;
+		InstanceData data;
+	};
+
+	uint64_t GetShapeKey(UnitShape shape, int slices, int rings)
+	{
+		// overlay bit stays clear, it only matters while sorting
+		return (static_cast<uint64_t>(shape) << 32) | (static_cast<uint64_t>(static_cast<uint16_t>(slices)) << 16) | static_cast<uint16_t>(rings);
+	}
+
+	Vector3 GetSpherePoint(float theta, float phi)
+	{
+		return { sinf(theta) * sinf(phi), cosf(phi), cosf(theta) * sinf(phi) };
+	}
+
+	bool IsWireShape(UnitShape shape)
+	{
+		return shape == UnitShape::WireSphere || shape == UnitShape::WireBox;
+	}
+
+	// same vertices the shape functions used to generate per call, at unit size
+	std::vector<VertexP> BuildUnitShape(UnitShape shape, int slices, int rings)
+	{
+		std::vector<VertexP> vertices;
+		const float vertRot = (Pi / static_cast<float>(std::max(rings, 1)));
+		const float horzRot = (TwoPi / static_cast<float>(std::max(slices, 1)));
+		switch (shape)
+		{
+		case UnitShape::WireSphere:
+			for (int r = 0; r < rings; ++r)
+			{
+				const float phi = r * vertRot;
+				for (int s = 0; s < slices; ++s)
+				{
+					vertices.push_back({ GetSpherePoint(s * horzRot, phi) });
+					vertices.push_back({ GetSpherePoint((s + 1) * horzRot, phi) });
+				}
+			}
+			break;
+		case UnitShape::FilledSphere:
+			for (int r = 0; r < rings; ++r)
+			{
+				const float phi0 = r * vertRot;
+				const float phi1 = (r + 1) * vertRot;
+				for (int s = 0; s < slices; ++s)
+				{
+					const Vector3 v0 = GetSpherePoint(s * horzRot, phi0);
+					const Vector3 v1 = GetSpherePoint((s + 1) * horzRot, phi0);
+					const Vector3 v2 = GetSpherePoint(s * horzRot, phi1);
+					const Vector3 v3 = GetSpherePoint((s + 1) * horzRot, phi1);
+					vertices.insert(vertices.end(), { { v0 }, { v1 }, { v2 }, { v1 }, { v3 }, { v2 } });
+				}
+			}
+			break;
+		case UnitShape::FilledCone:
+			for (int s = 0; s < slices; ++s)
+			{
+				const Vector3 v0 = { sinf(s * horzRot), 0.0f, cosf(s * horzRot) };
+				const Vector3 v1 = { sinf((s + 1) * horzRot), 0.0f, cosf((s + 1) * horzRot) };
+				vertices.insert(vertices.end(), { { v1 }, { Vector3::YAxis }, { v0 } });
+			}
+			break;
+		case UnitShape::WireBox:
+		{
+			const Vector3 corners[] =
+			{
+				{ 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f },	// front
+				{ 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }	// back
+			};
+			for (int i = 0; i < 4; ++i)
+			{
+				const int next = (i + 1) % 4;
+				vertices.insert(vertices.end(), { { corners[i] }, { corners[next] } });			// front
+				vertices.insert(vertices.end(), { { corners[i + 4] }, { corners[next + 4] } });	// back
+				vertices.insert(vertices.end(), { { corners[i] }, { corners[i + 4] } });			// front to back
+			}
+			break;
+		}
+		default:
+			ASSERT(false, "SimpleDraw: invalid unit shape");
+			break;
+		}
+		return vertices;
+	}
+
+	// unit shape baked into plain vertices, for geometry that can't be drawn instanced
+	void AppendShape(UnitShape shape, int slices, int rings, const Matrix4& world, const Color& color, std::vector<VertexPC>& vertices)
+	{
+		for (const VertexP& vertex : BuildUnitShape(shape, slices, rings))
+		{
+			vertices.push_back(VertexPC{ TransformCoord(vertex.position, world), color });
+		}
+	}
+
+	// maps floats to unsigned keys with the same ordering, negative values included
+	uint32_t GetSortableBits(float value)
+	{
+		value += 0.0f;	// -0 becomes 0
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+
+	// LSD radix sort of values by 32 bit key, 8 bits per pass. Stable, so equal keys keep their
+	// submission order, and passes where every key lands in the same bucket are skipped.
+	void RadixSort(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, std::vector<uint32_t>& scratchKeys, std::vector<uint32_t>& scratchValues)
+	{
+		const size_t count = keys.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		scratchKeys.resize(count);
+		scratchValues.resize(count);
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			uint32_t offsets[256] = {};
+			for (uint32_t key : keys)
+			{
+				++offsets[(key >> shift) & 0xff];
+			}
+			if (offsets[(keys[0] >> shift) & 0xff] == count)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t& bucket : offsets)
+			{
+				const uint32_t bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				const uint32_t target = offsets[(keys[i] >> shift) & 0xff]++;
+				scratchKeys[target] = keys[i];
+				scratchValues[target] = values[i];
+			}
+			keys.swap(scratchKeys);
+			values.swap(scratchValues);
+		}
+	}
+
+	// geometry one thread recorded since the last Render, so worker threads never share a buffer.
+	// Render hands the drained recorders back to a pool, the next add on any thread takes one
+	// from there, so short lived worker threads don't pile up recorders.
+	struct ThreadRecorder
+	{
+		std::vector<VertexPC> lineVertices;
+		std::vector<VertexPC> faceVertices;			// opaque
+		std::vector<VertexPC> translucentVertices;	// faces with alpha below 1
+		std::vector<VertexPC> overlayLineVertices;
+		std::vector<VertexPC> overlayFaceVertices;
+		std::vector<InstanceRecord> instances;
+	};
+
+	struct RetainedItem
+	{
+		std::vector<VertexPC> lineVertices;
+		std::vector<VertexPC> faceVertices;
+		float expireTime = 0.0f;	// 0 keeps the item until it is removed
+	};
+
+	// item the calling thread is filling between BeginRetained and EndRetained
+	struct RetainedCapture
+	{
+		SimpleDraw::RetainedId id = SimpleDraw::InvalidRetainedId;
+		RetainedItem item;
+	};
+
+	RetainedCapture& GetRetainedCapture()
+	{
+		thread_local RetainedCapture capture;
+		return capture;
+	}
+
+	// per thread rather than per recorder, recorders change hands every frame
+	SimpleDraw::Layer& GetThreadLayer()
+	{
+		thread_local SimpleDraw::Layer layer = SimpleDraw::Layer::Scene;
+		return layer;
+	}
+
+	// bumped on every Initialize and Render, a thread whose recorder is from an older epoch
+	// takes a new one from the pool. Global so epochs stay unique across instances.
+	std::atomic<uint64_t> sRecorderEpoch = 0;
+
+	// the recorders grow on demand, this only guards against something adding every frame
+	// without ever rendering
+	constexpr uint32_t MaxBatchesPerFrame = 64;
+
 	class SimpleDrawImpl
 	{
 	public:
-		void Initialize(uint32_t maxVertexCount);
+		void Initialize(uint32_t batchVertexCount);
 		void Terminate();
 
 		void AddLine(const Vector3& v0, const Vector3& v1, const Color& color);
 		void AddFace(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Color& color);
+		void AddInstance(UnitShape shape, int slices, int rings, const Matrix4& world, const Color& color);
+		void SetLayer(SimpleDraw::Layer layer);
+
+		SimpleDraw::RetainedId BeginRetained(SimpleDraw::RetainedId id, float lifetime);
+		void EndRetained();
+		void RemoveRetained(SimpleDraw::RetainedId id);
+		void ClearRetained();
 
 		void Render(const Camera& camera);
 
+		const SimpleDraw::Stats& GetStats() const { return mStats; }
+
 	private:
+		ThreadRecorder& GetRecorder();
+		void Flush(uint32_t& batchCount);
+		void DrawRecorded(std::vector<VertexPC> ThreadRecorder::* vertices, D3D11_PRIMITIVE_TOPOLOGY topology, uint32_t& vertexCount, uint32_t& batchCount);
+		void DrawTranslucent(const Matrix4& matView, uint32_t& batchCount);
+		void RenderInstances(size_t first, size_t end, uint32_t& batchCount);
+		const MeshBuffer& GetUnitShape(uint64_t shapeKey);
+		void UpdateRetained();
+
 		VertexShader mVertexShader;
 		PixelShader mPixelShader;
-		ConstantBuffer mConstantBuffer;
-		MeshBuffer mMeshBuffer;
+		VertexShader mInstancedVertexShader;
+		PixelShader mInstancedPixelShader;
+		TypedConstantBuffer<Matrix4> mConstantBuffer;
+		ConstantBuffer mInstanceBuffer;
+		DynamicRingBuffer mVertexRing;
 		BlendState mBlendState;
-
-		std::unique_ptr<VertexPC[]> mLineVertices;
-		std::unique_ptr<VertexPC[]> mFaceVertices;
-
-		uint32_t mLineVertexCount = 0;
-		uint32_t mFaceVertexCount = 0;
-		uint32_t mMaxVertexCount = 0;
+		DepthStencilState mDepthReadWrite;
+		DepthStencilState mDepthReadOnly;
+		DepthStencilState mDepthDisabled;
+
+		// translucent faces of the frame and their back to front order
+		std::vector<VertexPC> mTranslucentVertices;
+		std::vector<uint32_t> mSortKeys;
+		std::vector<uint32_t> mSortOrder;
+		std::vector<uint32_t> mSortScratchKeys;
+		std::vector<uint32_t> mSortScratchOrder;
+
+		// built on first use, keyed by GetShapeKey
+		std::unordered_map<uint64_t, MeshBuffer> mUnitShapes;
+		std::vector<InstanceRecord> mInstances;
+		std::unique_ptr<InstanceData[]> mBatchInstances;
+
+		// retained items live in two immutable buffers that are only rebuilt when an item
+		// is added, replaced, removed or expires
+		std::mutex mRetainedMutex;
+		std::map<SimpleDraw::RetainedId, RetainedItem> mRetainedItems;
+		std::atomic<SimpleDraw::RetainedId> mNextRetainedId = SimpleDraw::InvalidRetainedId;
+		MeshBuffer mRetainedLines;
+		MeshBuffer mRetainedFaces;
+		uint32_t mRetainedLineVertexCount = 0;
+		uint32_t mRetainedFaceVertexCount = 0;
+		bool mRetainedDirty = false;
+
+		std::mutex mRecorderMutex;
+		std::vector<std::unique_ptr<ThreadRecorder>> mRecorders;		// in use this frame
+		std::vector<std::unique_ptr<ThreadRecorder>> mFreeRecorders;
+		std::atomic<uint64_t> mRecorderEpoch = 0;
+
+		// staging for one GPU batch, Render flushes it into the ring whenever it fills up
+		std::unique_ptr<VertexPC[]> mBatchVertices;
+		D3D11_PRIMITIVE_TOPOLOGY mBatchTopology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+		uint32_t mBatchVertexCount = 0;
+		uint32_t mBatchCapacity = 0;
+
+		// vertices requested across all threads this frame, anything past mMaxFrameVertexCount is dropped
+		std::atomic<uint32_t> mLineVertexCount = 0;
+		std::atomic<uint32_t> mFaceVertexCount = 0;
+		std::atomic<uint32_t> mInstanceCount = 0;
+		uint32_t mMaxFrameVertexCount = 0;
+
+		SimpleDraw::Stats mStats;
 	};
-	void SimpleDrawImpl::Initialize(uint32_t maxVertexCount)
+	void SimpleDrawImpl::Initialize(uint32_t batchVertexCount)
 	{
+		// whole lines and whole triangles per batch
+		const uint32_t batchCapacity = batchVertexCount - (batchVertexCount % 6);
+		ASSERT(batchCapacity > 0, "SimpleDraw: batch needs room for at least 6 vertices, got %u", batchVertexCount);
+
 		std::filesystem::path shaderFile = "../../Assets/Shaders/DoTransform.fx";
 		mVertexShader.Initialize<VertexPC>(shaderFile);
 		mPixelShader.Initialize(shaderFile);
-		mConstantBuffer.Initialize(sizeof(Matrix4));
-		mMeshBuffer.Initialize(nullptr, sizeof(VertexPC), maxVertexCount);
+		std::filesystem::path instancedShaderFile = "../../Assets/Shaders/DoInstancedTransform.fx";
+		mInstancedVertexShader.Initialize<VertexP>(instancedShaderFile);
+		mInstancedPixelShader.Initialize(instancedShaderFile);
+		mConstantBuffer.Initialize();
+		mInstanceBuffer.Initialize(sizeof(InstanceData) * MaxInstancesPerBatch);
+		// every batch is drawn right after its Write, so discarding on overflow is safe
+		mVertexRing.Initialize(DynamicRingBuffer::Usage::Vertex, batchCapacity * sizeof(VertexPC) * DynamicRingBuffer::MaxFramesInFlight, DynamicRingBuffer::Overflow::Discard);
 		mBlendState.Initialize(BlendState::Mode::AlphaBlend);
-
-		mLineVertices = std::make_unique<VertexPC[]>(maxVertexCount);
-		mFaceVertices = std::make_unique<VertexPC[]>(maxVertexCount);
+		mDepthReadWrite.Initialize(DepthStencilState::Mode::ReadWrite);
+		mDepthReadOnly.Initialize(DepthStencilState::Mode::ReadOnly);
+		mDepthDisabled.Initialize(DepthStencilState::Mode::Disabled);
+
+		mBatchVertices = std::make_unique<VertexPC[]>(batchCapacity);
+		mBatchVertexCount = 0;
+		mBatchCapacity = batchCapacity;
+		mBatchInstances = std::make_unique<InstanceData[]>(MaxInstancesPerBatch);
 		mLineVertexCount = 0;
 		mFaceVertexCount = 0;
-		mMaxVertexCount = maxVertexCount;
+		mInstanceCount = 0;
+		mMaxFrameVertexCount = batchCapacity * MaxBatchesPerFrame;
+		mStats = {};
+		mRecorderEpoch = ++sRecorderEpoch;
 	}
 
 	void SimpleDrawImpl::Terminate()
 	{
-		mMeshBuffer.Terminate();
+		for (auto& [shapeKey, meshBuffer] : mUnitShapes)
+		{
+			meshBuffer.Terminate();
+		}
+		mUnitShapes.clear();
+
+		mVertexRing.Terminate();
+		mInstanceBuffer.Terminate();
 		mConstantBuffer.Terminate();
+		mInstancedPixelShader.Terminate();
+		mInstancedVertexShader.Terminate();
 		mPixelShader.Terminate();
 		mVertexShader.Terminate();
+		mDepthDisabled.Terminate();
+		mDepthReadOnly.Terminate();
+		mDepthReadWrite.Terminate();
 		mBlendState.Terminate();
+
+		{
+			std::lock_guard<std::mutex> lock(mRetainedMutex);
+			mRetainedItems.clear();
+			mRetainedLines.Terminate();
+			mRetainedFaces.Terminate();
+			mRetainedLineVertexCount = 0;
+			mRetainedFaceVertexCount = 0;
+		}
+
+		std::lock_guard<std::mutex> lock(mRecorderMutex);
+		mRecorders.clear();
+		mFreeRecorders.clear();
+	}
+
+	ThreadRecorder& SimpleDrawImpl::GetRecorder()
+	{
+		thread_local ThreadRecorder* recorder = nullptr;
+		thread_local uint64_t recorderEpoch = 0;
+		const uint64_t epoch = mRecorderEpoch.load(std::memory_order_acquire);
+		if (recorder == nullptr || recorderEpoch != epoch)
+		{
+			std::lock_guard<std::mutex> lock(mRecorderMutex);
+			if (mFreeRecorders.empty())
+			{
+				mRecorders.push_back(std::make_unique<ThreadRecorder>());
+			}
+			else
+			{
+				mRecorders.push_back(std::move(mFreeRecorders.back()));
+				mFreeRecorders.pop_back();
+			}
+			recorder = mRecorders.back().get();
+			recorderEpoch = epoch;
+		}
+		return *recorder;
 	}
 
 	void SimpleDrawImpl::AddLine(const Vector3& v0, const Vector3& v1, const Color& color)
 	{
-		if (mLineVertexCount + 2 <= mMaxVertexCount)
+		RetainedCapture& capture = GetRetainedCapture();
+		if (capture.id != SimpleDraw::InvalidRetainedId)
+		{
+			capture.item.lineVertices.push_back(VertexPC{ v0, color });
+			capture.item.lineVertices.push_back(VertexPC{ v1, color });
+		}
+		else if (mLineVertexCount.fetch_add(2, std::memory_order_relaxed) + 2 <= mMaxFrameVertexCount)
 		{
-			mLineVertices[mLineVertexCount++] = VertexPC{ v0, color };
-			mLineVertices[mLineVertexCount++] = VertexPC{ v1, color };
+			ThreadRecorder& recorder = GetRecorder();
+			std::vector<VertexPC>& vertices = (GetThreadLayer() == SimpleDraw::Layer::Overlay) ? recorder.overlayLineVertices : recorder.lineVertices;
+			vertices.push_back(VertexPC{ v0, color });
+			vertices.push_back(VertexPC{ v1, color });
 		}
 	}
 
 	void SimpleDrawImpl::AddFace(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Color& color)
 	{
-		if (mFaceVertexCount + 3 <= mMaxVertexCount)
+		RetainedCapture& capture = GetRetainedCapture();
+		if (capture.id != SimpleDraw::InvalidRetainedId)
+		{
+			capture.item.faceVertices.push_back(VertexPC{ v0, color });
+			capture.item.faceVertices.push_back(VertexPC{ v1, color });
+			capture.item.faceVertices.push_back(VertexPC{ v2, color });
+		}
+		else if (mFaceVertexCount.fetch_add(3, std::memory_order_relaxed) + 3 <= mMaxFrameVertexCount)
+		{
+			ThreadRecorder& recorder = GetRecorder();
+			std::vector<VertexPC>& vertices =
+				(GetThreadLayer() == SimpleDraw::Layer::Overlay) ? recorder.overlayFaceVertices :
+				(color.a < 1.0f) ? recorder.translucentVertices : recorder.faceVertices;
+			vertices.push_back(VertexPC{ v0, color });
+			vertices.push_back(VertexPC{ v1, color });
+			vertices.push_back(VertexPC{ v2, color });
+		}
+	}
+
+	void SimpleDrawImpl::AddInstance(UnitShape shape, int slices, int rings, const Matrix4& world, const Color& color)
+	{
+		if (slices <= 0 || rings <= 0)
+		{
+			return;
+		}
+
+		// retained shapes are drawn every frame, baking them once is cheaper than instancing
+		RetainedCapture& capture = GetRetainedCapture();
+		if (capture.id != SimpleDraw::InvalidRetainedId)
+		{
+			AppendShape(shape, slices, rings, world, color, IsWireShape(shape) ? capture.item.lineVertices : capture.item.faceVertices);
+			return;
+		}
+
+		ThreadRecorder& recorder = GetRecorder();
+		const SimpleDraw::Layer layer = GetThreadLayer();
+		if (layer == SimpleDraw::Layer::Scene && !IsWireShape(shape) && color.a < 1.0f)
+		{
+			// translucent faces are sorted one by one, so these go in as plain faces
+			std::vector<VertexPC>& vertices = recorder.translucentVertices;
+			const size_t oldSize = vertices.size();
+			AppendShape(shape, slices, rings, world, color, vertices);
+			const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() - oldSize);
+			if (mFaceVertexCount.fetch_add(vertexCount, std::memory_order_relaxed) + vertexCount > mMaxFrameVertexCount)
+			{
+				vertices.resize(oldSize);
+			}
+		}
+		else if (mInstanceCount.fetch_add(1, std::memory_order_relaxed) < MaxInstancesPerFrame)
+		{
+			InstanceRecord& record = recorder.instances.emplace_back();
+			record.shapeKey = GetShapeKey(shape, slices, rings) | ((layer == SimpleDraw::Layer::Overlay) ? OverlayShapeBit : 0);
+			record.data.world = Transpose(world);
+			record.data.color = color;
+		}
+	}
+
+	void SimpleDrawImpl::SetLayer(SimpleDraw::Layer layer)
+	{
+		GetThreadLayer() = layer;
+	}
+
+	const MeshBuffer& SimpleDrawImpl::GetUnitShape(uint64_t shapeKey)
+	{
+		auto [iter, inserted] = mUnitShapes.try_emplace(shapeKey);
+		if (inserted)
+		{
+			const UnitShape shape = static_cast<UnitShape>((shapeKey >> 32) & 0xff);
+			const std::vector<VertexP> vertices = BuildUnitShape(shape, static_cast<int>((shapeKey >> 16) & 0xffff), static_cast<int>(shapeKey & 0xffff));
+			iter->second.Initialize(vertices.data(), sizeof(VertexP), static_cast<uint32_t>(vertices.size()));
+			iter->second.SetTopology(IsWireShape(shape) ? MeshBuffer::Topology::Lines : MeshBuffer::Topology::Triangles);
+		}
+		return iter->second;
+	}
+
+	SimpleDraw::RetainedId SimpleDrawImpl::BeginRetained(SimpleDraw::RetainedId id, float lifetime)
+	{
+		RetainedCapture& capture = GetRetainedCapture();
+		ASSERT(capture.id == SimpleDraw::InvalidRetainedId, "SimpleDraw: BeginRetained called twice without EndRetained");
+		capture.id = (id != SimpleDraw::InvalidRetainedId) ? id : ++mNextRetainedId;
+		capture.item = {};
+		capture.item.expireTime = (lifetime > 0.0f) ? Core::TimeUtil::GetTime() + lifetime : 0.0f;
+		return capture.id;
+	}
+
+	void SimpleDrawImpl::EndRetained()
+	{
+		RetainedCapture& capture = GetRetainedCapture();
+		ASSERT(capture.id != SimpleDraw::InvalidRetainedId, "SimpleDraw: EndRetained called without BeginRetained");
+
+		std::lock_guard<std::mutex> lock(mRetainedMutex);
+		mRetainedItems[capture.id] = std::move(capture.item);
+		mRetainedDirty = true;
+		capture.id = SimpleDraw::InvalidRetainedId;
+	}
+
+	void SimpleDrawImpl::RemoveRetained(SimpleDraw::RetainedId id)
+	{
+		std::lock_guard<std::mutex> lock(mRetainedMutex);
+		mRetainedDirty |= (mRetainedItems.erase(id) > 0);
+	}
+
+	void SimpleDrawImpl::ClearRetained()
+	{
+		std::lock_guard<std::mutex> lock(mRetainedMutex);
+		mRetainedDirty |= !mRetainedItems.empty();
+		mRetainedItems.clear();
+	}
+
+	void SimpleDrawImpl::UpdateRetained()
+	{
+		std::lock_guard<std::mutex> lock(mRetainedMutex);
+		const float time = Core::TimeUtil::GetTime();
+		for (auto iter = mRetainedItems.begin(); iter != mRetainedItems.end();)
 		{
-			mFaceVertices[mFaceVertexCount++] = VertexPC{ v0, color };
-			mFaceVertices[mFaceVertexCount++] = VertexPC{ v1, color };
-			mFaceVertices[mFaceVertexCount++] = VertexPC{ v2, color };
+			if (iter->second.expireTime > 0.0f && iter->second.expireTime <= time)
+			{
+				iter = mRetainedItems.erase(iter);
+				mRetainedDirty = true;
+			}
+			else
+			{
+				++iter;
+			}
+		}
+
+		if (!mRetainedDirty)
+		{
+			return;
+		}
+
+		std::vector<VertexPC> lineVertices;
+		std::vector<VertexPC> faceVertices;
+		for (const auto& [id, item] : mRetainedItems)
+		{
+			lineVertices.insert(lineVertices.end(), item.lineVertices.begin(), item.lineVertices.end());
+			faceVertices.insert(faceVertices.end(), item.faceVertices.begin(), item.faceVertices.end());
+		}
+
+		mRetainedLines.Terminate();
+		mRetainedFaces.Terminate();
+		mRetainedLineVertexCount = static_cast<uint32_t>(lineVertices.size());
+		mRetainedFaceVertexCount = static_cast<uint32_t>(faceVertices.size());
+		if (mRetainedLineVertexCount > 0)
+		{
+			mRetainedLines.Initialize(lineVertices.data(), sizeof(VertexPC), mRetainedLineVertexCount);
+			mRetainedLines.SetTopology(MeshBuffer::Topology::Lines);
+		}
+		if (mRetainedFaceVertexCount > 0)
+		{
+			mRetainedFaces.Initialize(faceVertices.data(), sizeof(VertexPC), mRetainedFaceVertexCount);
+			mRetainedFaces.SetTopology(MeshBuffer::Topology::Triangles);
+		}
+		mRetainedDirty = false;
+	}
+
+	void SimpleDrawImpl::RenderInstances(size_t first, size_t end, uint32_t& batchCount)
+	{
+		if (first == end)
+		{
+			return;
+		}
+
+		mInstancedVertexShader.Bind();
+		mInstancedPixelShader.Bind();
+		mInstanceBuffer.BindVS(1);
+
+		while (first < end)
+		{
+			const uint64_t shapeKey = mInstances[first].shapeKey;
+			size_t last = first;
+			while (last < end && mInstances[last].shapeKey == shapeKey)
+			{
+				++last;
+			}
+
+			const MeshBuffer& unitShape = GetUnitShape(shapeKey & ~OverlayShapeBit);
+			for (size_t i = first; i < last; i += MaxInstancesPerBatch)
+			{
+				const uint32_t instanceCount = static_cast<uint32_t>(std::min<size_t>(MaxInstancesPerBatch, last - i));
+				for (uint32_t j = 0; j < instanceCount; ++j)
+				{
+					mBatchInstances[j] = mInstances[i + j].data;
+				}
+				mInstanceBuffer.Update(mBatchInstances.get());
+				unitShape.RenderInstanced(instanceCount);
+				++batchCount;
+			}
+			first = last;
+		}
+	}
+
+	void SimpleDrawImpl::Flush(uint32_t& batchCount)
+	{
+		if (mBatchVertexCount > 0)
+		{
+			const uint32_t offset = mVertexRing.Write(mBatchVertices.get(), mBatchVertexCount * sizeof(VertexPC), sizeof(VertexPC));
+			ASSERT(offset % sizeof(VertexPC) == 0, "SimpleDraw: vertex offset %u is not on a vertex boundary", offset);
+			auto context = GraphicsSystem::Get()->GetContext();
+			context->IASetPrimitiveTopology(mBatchTopology);
+			mVertexRing.BindVertices(sizeof(VertexPC));
+			context->Draw(mBatchVertexCount, offset / sizeof(VertexPC));
+			mBatchVertexCount = 0;
+			++batchCount;
+		}
+	}
+
+	void SimpleDrawImpl::DrawRecorded(std::vector<VertexPC> ThreadRecorder::* vertices, D3D11_PRIMITIVE_TOPOLOGY topology, uint32_t& vertexCount, uint32_t& batchCount)
+	{
+		mBatchTopology = topology;
+		for (const std::unique_ptr<ThreadRecorder>& recorder : mRecorders)
+		{
+			std::vector<VertexPC>& source = (*recorder).*vertices;
+			const uint32_t sourceCount = static_cast<uint32_t>(source.size());
+			uint32_t copied = 0;
+			while (copied < sourceCount)
+			{
+				const uint32_t count = std::min(sourceCount - copied, mBatchCapacity - mBatchVertexCount);
+				std::copy(source.data() + copied, source.data() + copied + count, mBatchVertices.get() + mBatchVertexCount);
+				mBatchVertexCount += count;
+				copied += count;
+				if (mBatchVertexCount == mBatchCapacity)
+				{
+					Flush(batchCount);
+				}
+			}
+			vertexCount += sourceCount;
+			source.clear();
+		}
+		Flush(batchCount);
+	}
+
+	void SimpleDrawImpl::DrawTranslucent(const Matrix4& matView, uint32_t& batchCount)
+	{
+		// view depth of the centroid, scaled by 3 which doesn't change the order
+		const uint32_t faceCount = static_cast<uint32_t>(mTranslucentVertices.size() / 3);
+		mSortKeys.resize(faceCount);
+		mSortOrder.resize(faceCount);
+		for (uint32_t i = 0; i < faceCount; ++i)
+		{
+			const VertexPC* face = &mTranslucentVertices[i * 3];
+			const Vector3 centroid = face[0].position + face[1].position + face[2].position;
+			const float depth = (centroid.x * matView._13) + (centroid.y * matView._23) + (centroid.z * matView._33);
+			mSortKeys[i] = ~GetSortableBits(depth);	// far faces first
+			mSortOrder[i] = i;
+		}
+		RadixSort(mSortKeys, mSortOrder, mSortScratchKeys, mSortScratchOrder);
+
+		mBatchTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+		for (uint32_t face : mSortOrder)
+		{
+			std::copy_n(&mTranslucentVertices[face * 3], 3, mBatchVertices.get() + mBatchVertexCount);
+			mBatchVertexCount += 3;
+			if (mBatchVertexCount == mBatchCapacity)
+			{
+				Flush(batchCount);
+			}
 		}
+		Flush(batchCount);
+		mTranslucentVertices.clear();
 	}
 
 	void SimpleDrawImpl::Render(const Camera& camera)
 	{
 		const Matrix4 matView = camera.GetViewMatrix();
 		const Matrix4 matProj = camera.GetProjectionMatrix();
-		const Matrix4 transform = Transpose(matView * matProj);
-		mConstantBuffer.Update(&transform);
+		mConstantBuffer.Set(Transpose(matView * matProj));	// uploads only when the camera moved
 		mConstantBuffer.BindVS(0);
 
+		mBlendState.Set();
+		mVertexRing.BeginFrame();
+
+		// opaque: depth tested and written
+		mDepthReadWrite.Set();
 		mVertexShader.Bind();
 		mPixelShader.Bind();
 
-		mBlendState.Set();
+		UpdateRetained();
+		if (mRetainedLineVertexCount > 0)
+		{
+			mRetainedLines.Render();
+		}
+		if (mRetainedFaceVertexCount > 0)
+		{
+			mRetainedFaces.Render();
+		}
 
-		mMeshBuffer.Update(mLineVertices.get(), mLineVertexCount);
-		mMeshBuffer.SetTopology(MeshBuffer::Topology::Lines);
-		mMeshBuffer.Render();
+		// recording threads must be done with this frame, only the recorder list is guarded here
+		std::lock_guard<std::mutex> lock(mRecorderMutex);
+		uint32_t lineVertexCount = 0;
+		uint32_t faceVertexCount = 0;
+		uint32_t batchCount = 0;
+		DrawRecorded(&ThreadRecorder::lineVertices, D3D11_PRIMITIVE_TOPOLOGY_LINELIST, lineVertexCount, batchCount);
+		DrawRecorded(&ThreadRecorder::faceVertices, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, faceVertexCount, batchCount);
 
-		mMeshBuffer.Update(mFaceVertices.get(), mFaceVertexCount);
-		mMeshBuffer.SetTopology(MeshBuffer::Topology::Triangles);
-		mMeshBuffer.Render();
+		for (const std::unique_ptr<ThreadRecorder>& recorder : mRecorders)
+		{
+			mInstances.insert(mInstances.end(), recorder->instances.begin(), recorder->instances.end());
+			mTranslucentVertices.insert(mTranslucentVertices.end(), recorder->translucentVertices.begin(), recorder->translucentVertices.end());
+			recorder->instances.clear();
+			recorder->translucentVertices.clear();
+		}
 
+		// grouped by shape with the overlay ones last, stable so instances of one shape keep
+		// the order they were added in
+		std::stable_sort(mInstances.begin(), mInstances.end(), [](const InstanceRecord& a, const InstanceRecord& b)
+		{
+			return a.shapeKey < b.shapeKey;
+		});
+		const size_t overlayInstance = std::partition_point(mInstances.begin(), mInstances.end(), [](const InstanceRecord& record)
+		{
+			return (record.shapeKey & OverlayShapeBit) == 0;
+		}) - mInstances.begin();
+		RenderInstances(0, overlayInstance, batchCount);
+
+		// translucent: depth tested but not written, back to front
+		const uint32_t translucentVertexCount = static_cast<uint32_t>(mTranslucentVertices.size());
+		faceVertexCount += translucentVertexCount;
+		mDepthReadOnly.Set();
+		mVertexShader.Bind();
+		mPixelShader.Bind();
+		DrawTranslucent(matView, batchCount);
+
+		// overlay: on top of everything in submission order
+		mDepthDisabled.Set();
+		DrawRecorded(&ThreadRecorder::overlayLineVertices, D3D11_PRIMITIVE_TOPOLOGY_LINELIST, lineVertexCount, batchCount);
+		DrawRecorded(&ThreadRecorder::overlayFaceVertices, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST, faceVertexCount, batchCount);
+		RenderInstances(overlayInstance, mInstances.size(), batchCount);
+
+		DepthStencilState::ClearState();
 		BlendState::ClearState();
+		mVertexRing.EndFrame();
+
+		const uint32_t instanceCount = static_cast<uint32_t>(mInstances.size());
+		mInstances.clear();
+
+		// every recorder is empty now, back to the pool until some thread adds again
+		for (std::unique_ptr<ThreadRecorder>& recorder : mRecorders)
+		{
+			mFreeRecorders.push_back(std::move(recorder));
+		}
+		mRecorders.clear();
+		mRecorderEpoch = ++sRecorderEpoch;
+
+		mStats.lineCount = lineVertexCount / 2;
+		mStats.faceCount = faceVertexCount / 3;
+		mStats.translucentFaceCount = translucentVertexCount / 3;
+		mStats.peakLineCount = std::max(mStats.peakLineCount, mStats.lineCount);
+		mStats.peakFaceCount = std::max(mStats.peakFaceCount, mStats.faceCount);
+		mStats.droppedLineCount = (mLineVertexCount - lineVertexCount) / 2;
+		mStats.droppedFaceCount = (mFaceVertexCount - faceVertexCount) / 3;
+		mStats.instanceCount = instanceCount;
+		mStats.peakInstanceCount = std::max(mStats.peakInstanceCount, instanceCount);
+		mStats.droppedInstanceCount = mInstanceCount - instanceCount;
+		mStats.retainedLineCount = mRetainedLineVertexCount / 2;
+		mStats.retainedFaceCount = mRetainedFaceVertexCount / 3;
+		mStats.batchCount = batchCount;
 
 		mLineVertexCount = 0;
 		mFaceVertexCount = 0;
+		mInstanceCount = 0;
 	}
 
 	std::unique_ptr<SimpleDrawImpl> sInstance;
 }
 
-void SimpleDraw::StaticInitialize(uint32_t maxVertexCount)
+void SimpleDraw::StaticInitialize(uint32_t batchVertexCount)
 {
 	sInstance = std::make_unique<SimpleDrawImpl>();
-	sInstance->Initialize(maxVertexCount);
+	sInstance->Initialize(batchVertexCount);
 }
 
 void SimpleDraw::StaticTerminate()
@@ -144,35 +822,12 @@ void SimpleDraw::AddAABB(const Math::Vector3& min, const Math::Vector3& max, con
 
 void SimpleDraw::AddAABB(float minX, float minY, float minZ, float maxX, float maxY, float maxZ, const Color& color)
 {
-	const Vector3 blf = { minX, minY, minZ };	// bottom left front
-	const Vector3 tlf = { minX, maxY, minZ };	// top left front
-	const Vector3 trf = { maxX, maxY, minZ };	// top right front
-	const Vector3 brf = { maxX, minY, minZ };	// bottom right front
-
-	const Vector3 blb = { minX, minY, maxZ };	// bottom left back
-	const Vector3 tlb = { minX, maxY, maxZ };	// top left back
-	const Vector3 trb = { maxX, maxY, maxZ };	// top right back
-	const Vector3 brb = { maxX, minY, maxZ };	// bottom right back
-
-	// front
-	AddLine(blf, tlf, color);
-	AddLine(tlf, trf, color);
-	AddLine(trf, brf, color);
-	AddLine(brf, blf, color);
-
-	// back
-	AddLine(blb, tlb, color);
-	AddLine(tlb, trb, color);
-	AddLine(trb, brb, color);
-	AddLine(brb, blb, color);
-
-	// top
-	AddLine(tlf, tlb, color);
-	AddLine(trf, trb, color);
-
-	// bottom
-	AddLine(blf, blb, color);
-	AddLine(brf, brb, color);
+	const Matrix4 world(
+		maxX - minX, 0.0f, 0.0f, 0.0f,
+		0.0f, maxY - minY, 0.0f, 0.0f,
+		0.0f, 0.0f, maxZ - minZ, 0.0f,
+		minX, minY, minZ, 1.0f);
+	sInstance->AddInstance(UnitShape::WireBox, 1, 1, world, color);
 }
 
 void SimpleDraw::AddFilledAABB(const Math::Vector3& min, const Math::Vector3& max, const Color& color)
@@ -219,111 +874,12 @@ void SimpleDraw::AddFilledAABB(float minX, float minY, float minZ, float maxX, f
 
 void SimpleDraw::AddSphere(int slices, int rings, float radius, const Math::Vector3& pos, const Color& color)
 {
-	Vector3 v0 = Vector3::Zero;
-	Vector3 v1 = Vector3::Zero;
-
-	const float vertRot = (Pi / static_cast<float>(rings));
-	const float horzRot = (TwoPi / static_cast<float>(slices));
-	for (int r = 0; r < rings; ++r)
-	{
-		int ring = static_cast<float>(r);
-		float phi = ring * vertRot;
-		for (int s = 0; s < slices; ++s)
-		{
-			float slice0 = static_cast<float>(s);
-			float rot0 = slice0 * horzRot;
-
-			float slice1 = static_cast<float>(s + 1);
-			float rot1 = slice1 * horzRot;
-
-			v0 =
-			{
-				sin(rot0) * sin(phi) * radius,
-				cos(phi) * radius,
-				cos(rot0) * sin(phi) * radius
-			};
-
-			v1 =
-			{
-				sin(rot1) * sin(phi) * radius,
-				cos(phi) * radius,
-				cos(rot1) * sin(phi) * radius
-			};
-			AddLine(v0 + pos, v1 + pos, color);
-
-			v0 =
-			{
-				cos(phi) * radius,
-				cos(rot0) * sin(phi) * radius,
-				sin(rot0) * sin(phi) * radius
-			};
-
-			v1 =
-			{
-				cos(phi) * radius,
-				cos(rot1) * sin(phi) * radius,
-				sin(rot1) * sin(phi) * radius
-			};
-			AddLine(v0 + pos, v1 + pos, color);
-		}
-	}
+	AddOval(slices, rings, radius, radius, pos, color);
 }
 
 void SumEngine::Graphics::SimpleDraw::AddFilledSphere(int slices, int rings, float radius, const Math::Vector3& pos, const Color& color)
 {
-	Vector3 v0 = Vector3::Zero;
-	Vector3 v1 = Vector3::Zero;
-	Vector3 v2 = Vector3::Zero;
-
-	const float vertRot = (Pi / static_cast<float>(rings));
-	const float horzRot = (TwoPi / static_cast<float>(slices));
-	for (int r = 0; r < rings; ++r)
-	{
-		float phi0 = r * vertRot;
-		float phi1 = (r + 1) * vertRot;
-
-		for (int s = 0; s < slices; ++s)
-		{
-			float theta0 = s * horzRot;
-			float theta1 = (s + 1) * horzRot;
-
-			// Calculate the vertices for the current face
-			v0 =
-			{
-				sin(theta0) * sin(phi0) * radius,
-				cos(phi0) * radius,
-				cos(theta0) * sin(phi0) * radius
-			};
-
-			v1 =
-			{
-				sin(theta1) * sin(phi0) * radius,
-				cos(phi0) * radius,
-				cos(theta1) * sin(phi0) * radius
-			};
-
-			v2 =
-			{
-				sin(theta0) * sin(phi1) * radius,
-				cos(phi1) * radius,
-				cos(theta0) * sin(phi1) * radius
-			};
-
-			// Add the first triangular face
-			AddFace(v0 + pos, v1 + pos, v2 + pos, color);
-
-			// Calculate the fourth vertex for the next triangular face
-			v0 =
-			{
-				sin(theta1) * sin(phi1) * radius,
-				cos(phi1) * radius,
-				cos(theta1) * sin(phi1) * radius
-			};
-
-			// Add the second triangular face
-			AddFace(v1 + pos, v0 + pos, v2 + pos, color);
-		}
-	}
+	AddFilledOval(slices, rings, radius, radius, radius, pos, color);
 }
 
 void SimpleDraw::AddGroundCircle(int slices, float radius, const Math::Vector3& pos, const Color& color)
@@ -356,177 +912,51 @@ void SimpleDraw::AddGroundCircle(int slices, float radius, const Math::Vector3&
 
 void SumEngine::Graphics::SimpleDraw::AddOval(int slices, int rings, float r1, float r2, const Math::Vector3& pos, const Color& color)
 {
-	Vector3 v0 = Vector3::Zero;
-	Vector3 v1 = Vector3::Zero;
-
-	const float vertRot = (Pi / static_cast<float>(rings));
-	const float horzRot = (TwoPi / static_cast<float>(slices));
-	for (int r = 0; r < rings; ++r)
-	{
-		int ring = static_cast<float>(r);
-		float phi = ring * vertRot;
-		for (int s = 0; s < slices; ++s)
-		{
-			float slice0 = static_cast<float>(s);
-			float rot0 = slice0 * horzRot;
-
-			float slice1 = static_cast<float>(s + 1);
-			float rot1 = slice1 * horzRot;
-
-			v0 =
-			{
-				sin(rot0) * sin(phi) * r1,
-				cos(phi) * r1,
-				cos(rot0) * sin(phi) * r1
-			};
-
-			v1 =
-			{
-				sin(rot1) * sin(phi) * r1,
-				cos(phi) * r1,
-				cos(rot1) * sin(phi) * r1
-			};
-			AddLine(v0 + pos, v1 + pos, color);
-
-			v0 =
-			{
-				cos(phi) * r2,
-				cos(rot0) * sin(phi) * r2,
-				sin(rot0) * sin(phi) * r2
-			};
-
-			v1 =
-			{
-				cos(phi) * r2,
-				cos(rot1) * sin(phi) * r2,
-				sin(rot1) * sin(phi) * r2
-			};
-			AddLine(v0 + pos, v1 + pos, color);
-		}
-	}
+	// latitude rings scaled by r1, plus the same rings turned around x, (x, y, z) -> (y, z, x), scaled by r2
+	const Matrix4 latitudes(
+		r1, 0.0f, 0.0f, 0.0f,
+		0.0f, r1, 0.0f, 0.0f,
+		0.0f, 0.0f, r1, 0.0f,
+		pos.x, pos.y, pos.z, 1.0f);
+	const Matrix4 meridians(
+		0.0f, 0.0f, r2, 0.0f,
+		r2, 0.0f, 0.0f, 0.0f,
+		0.0f, r2, 0.0f, 0.0f,
+		pos.x, pos.y, pos.z, 1.0f);
+	sInstance->AddInstance(UnitShape::WireSphere, slices, rings, latitudes, color);
+	sInstance->AddInstance(UnitShape::WireSphere, slices, rings, meridians, color);
 }
 
 void SimpleDraw::AddOval(int slices, int rings, float radiusX, float radiusY, float radiusZ, const Math::Vector3& pos, const Color& color)
 {
-	Vector3 v0 = Vector3::Zero;
-	Vector3 v1 = Vector3::Zero;
-
-	const float vertRot = (Pi / static_cast<float>(rings));
-	const float horzRot = (TwoPi / static_cast<float>(slices));
-	for (int r = 0; r < rings; ++r)
-	{
-		int ring = static_cast<float>(r);
-		float phi = ring * vertRot;
-		for (int s = 0; s < slices; ++s)
-		{
-			float slice0 = static_cast<float>(s);
-			float rot0 = slice0 * horzRot;
-
-			float slice1 = static_cast<float>(s + 1);
-			float rot1 = slice1 * horzRot;
-
-			v0 =
-			{
-				sin(rot0) * sin(phi) * radiusX,
-				cos(phi) * radiusY,
-				cos(rot0) * sin(phi) * radiusZ
-			};
-
-			v1 =
-			{
-				sin(rot1) * sin(phi) * radiusX,
-				cos(phi) * radiusY,
-				cos(rot1) * sin(phi) * radiusZ
-			};
-			AddLine(v0 + pos, v1 + pos, color);
-		}
-	}
+	const Matrix4 world(
+		radiusX, 0.0f, 0.0f, 0.0f,
+		0.0f, radiusY, 0.0f, 0.0f,
+		0.0f, 0.0f, radiusZ, 0.0f,
+		pos.x, pos.y, pos.z, 1.0f);
+	sInstance->AddInstance(UnitShape::WireSphere, slices, rings, world, color);
 }
 
 void SimpleDraw::AddFilledOval(int slices, int rings, float radiusX, float radiusY, float radiusZ, const Math::Vector3& pos, const Color& color)
 {
-	Vector3 v0 = Vector3::Zero;
-	Vector3 v1 = Vector3::Zero;
-	Vector3 v2 = Vector3::Zero;
-
-	const float vertRot = (Pi / static_cast<float>(rings));
-	const float horzRot = (TwoPi / static_cast<float>(slices));
-	for (int r = 0; r < rings; ++r)
-	{
-		float phi0 = r * vertRot;
-		float phi1 = (r + 1) * vertRot;
-
-		for (int s = 0; s < slices; ++s)
-		{
-			float theta0 = s * horzRot;
-			float theta1 = (s + 1) * horzRot;
-
-			// Calculate the vertices for the current face
-			v0 =
-			{
-				sin(theta0) * sin(phi0) * radiusX,
-				cos(phi0) * radiusY,
-				cos(theta0) * sin(phi0) * radiusZ
-			};
-
-			v1 =
-			{
-				sin(theta1) * sin(phi0) * radiusX,
-				cos(phi0) * radiusY,
-				cos(theta1) * sin(phi0) * radiusZ
-			};
-
-			v2 =
-			{
-				sin(theta0) * sin(phi1) * radiusX,
-				cos(phi1) * radiusY,
-				cos(theta0) * sin(phi1) * radiusZ
-			};
-
-			// Add the first triangular face
-			AddFace(v0 + pos, v1 + pos, v2 + pos, color);
-
-			// Calculate the fourth vertex for the next triangular face
-			v0 =
-			{
-				sin(theta1) * sin(phi1) * radiusX,
-				cos(phi1) * radiusY,
-				cos(theta1) * sin(phi1) * radiusZ
-			};
-
-			// Add the second triangular face
-			AddFace(v1 + pos, v0 + pos, v2 + pos, color);
-		}
-	}
+	const Matrix4 world(
+		radiusX, 0.0f, 0.0f, 0.0f,
+		0.0f, radiusY, 0.0f, 0.0f,
+		0.0f, 0.0f, radiusZ, 0.0f,
+		pos.x, pos.y, pos.z, 1.0f);
+	sInstance->AddInstance(UnitShape::FilledSphere, slices, rings, world, color);
 }
 
 void SumEngine::Graphics::SimpleDraw::AddCone(int slices, float radius, const Math::Vector3& circlePos, const Math::Vector3& coneTip, const Color& color)
 {
-	Vector3 v0 = Vector3::Zero;
-	Vector3 v1 = Vector3::Zero;
-	const float horzRot = (TwoPi / static_cast<float>(slices));
-	for (int s = 0; s < slices; ++s)
-	{
-		float slice0 = static_cast<float>(s);
-		float rot0 = slice0 * horzRot;
-
-		float slize1 = static_cast<float>(s + 1);
-		float rot1 = slize1 * horzRot;
-
-		v0 = {
-			sin(rot0) * radius,
-			0.0f,
-			cos(rot0) * radius
-		};
-
-		v1 = {
-			sin(rot1) * radius,
-			0.0f,
-			cos(rot1) * radius
-		};
-		//AddLine(v0 + circlePos, v1 + circlePos, color);
-		AddFace(v1 + circlePos, coneTip, v0 + circlePos, color);
-	}
+	// the base stays in the xz plane while the unit tip at (0, 1, 0) is sheared onto coneTip
+	const Vector3 toTip = coneTip - circlePos;
+	const Matrix4 world(
+		radius, 0.0f, 0.0f, 0.0f,
+		toTip.x, toTip.y, toTip.z, 0.0f,
+		0.0f, 0.0f, radius, 0.0f,
+		circlePos.x, circlePos.y, circlePos.z, 1.0f);
+	sInstance->AddInstance(UnitShape::FilledCone, slices, 1, world, color);
 }
 
 void SimpleDraw::AddGroundPlane(float size, const Color& color)
@@ -551,7 +981,37 @@ void SimpleDraw::AddTransform(const Math::Matrix4& m)
 	AddLine(pos, pos + look, Colors::Blue);		// z
 }
 
+void SimpleDraw::SetLayer(Layer layer)
+{
+	sInstance->SetLayer(layer);
+}
+
 void SimpleDraw::Render(const Camera& camera)
 {
 	sInstance->Render(camera);
 }
+
+SimpleDraw::RetainedId SimpleDraw::BeginRetained(RetainedId id, float lifetime)
+{
+	return sInstance->BeginRetained(id, lifetime);
+}
+
+void SimpleDraw::EndRetained()
+{
+	sInstance->EndRetained();
+}
+
+void SimpleDraw::RemoveRetained(RetainedId id)
+{
+	sInstance->RemoveRetained(id);
+}
+
+void SimpleDraw::ClearRetained()
+{
+	sInstance->ClearRetained();
+}
+
+const SimpleDraw::Stats& SimpleDraw::GetStats()
+{
+	return sInstance->GetStats();
+}
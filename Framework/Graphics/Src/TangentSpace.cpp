@@ -0,0 +1,168 @@
+#include "Precompiled.h"
+#include "TangentSpace.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	// small meshes stay on the calling thread
+	constexpr uint32_t MinItemsPerBatch = 4096;
+
+	// the corners (triangle * 3 + k) that touch each vertex, so every vertex can be
+	// gathered independently instead of scattering triangle results across threads
+	struct CornerAdjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> corners;
+
+		CornerAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount)
+			: offsets(vertexCount + 1, 0)
+			, corners(indices.size())
+		{
+			for (uint32_t index : indices)
+			{
+				++offsets[index + 1];
+			}
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				offsets[v + 1] += offsets[v];
+			}
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (uint32_t corner = 0; corner < static_cast<uint32_t>(indices.size()); ++corner)
+			{
+				corners[fill[indices[corner]]++] = corner;
+			}
+		}
+	};
+
+	void ForEach(uint32_t count, const Core::ParallelUtil::RangeFunc& func)
+	{
+		const uint32_t batchSize = std::max(MinItemsPerBatch, count / (Core::ParallelUtil::GetWorkerCount() * 4));
+		Core::ParallelUtil::ParallelFor(count, batchSize, func);
+	}
+
+	Vector3 GetPerpendicular(const Vector3& normal)
+	{
+		const Vector3 axis = (Abs(normal.x) < 0.9f) ? Vector3::XAxis : Vector3::YAxis;
+		return Normalize(Cross(axis, normal));
+	}
+
+	Vector3 ProjectOntoPlane(const Vector3& v, const Vector3& normal)
+	{
+		return v - (normal * Dot(normal, v));
+	}
+}
+
+void TangentSpace::ComputeNormals(Mesh& mesh)
+{
+	ASSERT(mesh.indices.size() % 3 == 0, "TangentSpace: index count must be a multiple of 3");
+	const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	const uint32_t triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+	const Vertex* vertices = mesh.vertices.data();
+	const uint32_t* indices = mesh.indices.data();
+
+	// the cross product's length is twice the triangle's area, which gives the area weighting for free
+	std::vector<Vector3> faceNormals(triangleCount);
+	ForEach(triangleCount, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			const Vector3& p0 = vertices[indices[(t * 3) + 0]].position;
+			const Vector3& p1 = vertices[indices[(t * 3) + 1]].position;
+			const Vector3& p2 = vertices[indices[(t * 3) + 2]].position;
+			faceNormals[t] = Cross(p1 - p0, p2 - p0);
+		}
+	});
+
+	const CornerAdjacency adjacency(mesh.indices, vertexCount);
+	ForEach(vertexCount, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t v = begin; v < end; ++v)
+		{
+			Vector3 normal = Vector3::Zero;
+			for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i)
+			{
+				normal += faceNormals[adjacency.corners[i] / 3];
+			}
+			const float length = Magnitude(normal);
+			mesh.vertices[v].normal = (length > 0.0f) ? normal / length : Vector3::YAxis;
+		}
+	});
+}
+
+void TangentSpace::ComputeTangents(Mesh& mesh)
+{
+	ASSERT(mesh.indices.size() % 3 == 0, "TangentSpace: index count must be a multiple of 3");
+	const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	const uint32_t triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+	const Vertex* vertices = mesh.vertices.data();
+	const uint32_t* indices = mesh.indices.data();
+
+	// direction of increasing u across each face, only the sign of the uv determinant is
+	// kept so large and small uv islands weigh the same
+	std::vector<Vector3> faceTangents(triangleCount);
+	ForEach(triangleCount, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			const Vertex& v0 = vertices[indices[(t * 3) + 0]];
+			const Vertex& v1 = vertices[indices[(t * 3) + 1]];
+			const Vertex& v2 = vertices[indices[(t * 3) + 2]];
+
+			const Vector3 e1 = v1.position - v0.position;
+			const Vector3 e2 = v2.position - v0.position;
+			const float du1 = v1.uvCoord.x - v0.uvCoord.x;
+			const float dv1 = v1.uvCoord.y - v0.uvCoord.y;
+			const float du2 = v2.uvCoord.x - v0.uvCoord.x;
+			const float dv2 = v2.uvCoord.y - v0.uvCoord.y;
+
+			const float determinant = (du1 * dv2) - (du2 * dv1);
+			if (Abs(determinant) <= std::numeric_limits<float>::epsilon())
+			{
+				faceTangents[t] = Vector3::Zero;
+				continue;
+			}
+			const float sign = (determinant > 0.0f) ? 1.0f : -1.0f;
+			faceTangents[t] = ((e1 * dv2) - (e2 * dv1)) * sign;
+		}
+	});
+
+	const CornerAdjacency adjacency(mesh.indices, vertexCount);
+	ForEach(vertexCount, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t v = begin; v < end; ++v)
+		{
+			const Vector3& normal = vertices[v].normal;
+			Vector3 tangent = Vector3::Zero;
+			for (uint32_t i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i)
+			{
+				const uint32_t corner = adjacency.corners[i];
+				const uint32_t triangle = corner / 3;
+				const Vector3 faceTangent = ProjectOntoPlane(faceTangents[triangle], normal);
+				const float faceTangentLength = Magnitude(faceTangent);
+				if (faceTangentLength <= 0.0f)
+				{
+					continue;
+				}
+
+				// weight by the angle the triangle spans at this vertex, measured in the tangent plane
+				const uint32_t base = triangle * 3;
+				const Vector3& p = vertices[v].position;
+				const Vector3 edge0 = ProjectOntoPlane(vertices[indices[base + ((corner - base + 1) % 3)]].position - p, normal);
+				const Vector3 edge1 = ProjectOntoPlane(vertices[indices[base + ((corner - base + 2) % 3)]].position - p, normal);
+				const float edgeLengths = Magnitude(edge0) * Magnitude(edge1);
+				if (edgeLengths <= 0.0f)
+				{
+					continue;
+				}
+				const float angle = acosf(Clamp(Dot(edge0, edge1) / edgeLengths, -1.0f, 1.0f));
+				tangent += faceTangent * (angle / faceTangentLength);
+			}
+
+			const float length = Magnitude(tangent);
+			mesh.vertices[v].tangent = (length > 0.0f) ? tangent / length : GetPerpendicular(normal);
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "Precompiled.h"
+#include "Terrain.h"
+
+#include "Camera.h"
+#include "Frustum.h"
+#include "GraphicsSystem.h"
+#include "VertexPacking.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	constexpr uint32_t EdgeBottom = 1 << 0;	// -z
+	constexpr uint32_t EdgeRight = 1 << 1;	// +x
+	constexpr uint32_t EdgeTop = 1 << 2;	// +z
+	constexpr uint32_t EdgeLeft = 1 << 3;	// -x
+	constexpr uint32_t EdgeMaskCount = 16;
+
+	// resident chunks are only released once they are this much further out than residentDistance
+	constexpr float UnloadHysteresis = 1.25f;
+
+	bool IsPowerOfTwo(uint32_t value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
+	void CreateLodIndices(std::vector<uint16_t>& indices, uint32_t chunkSize, uint32_t lod, uint32_t edgeMask)
+	{
+		const uint32_t step = 1u << lod;
+		const uint32_t coarseStep = step * 2;
+		const uint32_t verticesPerRow = chunkSize + 1;
+
+		auto getIndex = [&](uint32_t c, uint32_t r) -> uint16_t
+		{
+			// odd vertices on a stitched edge collapse onto the coarser neighbour's grid,
+			// corners are always on it so the two checks never touch the same vertex
+			const bool stitchRow = (r == 0 && (edgeMask & EdgeBottom)) || (r == chunkSize && (edgeMask & EdgeTop));
+			const bool stitchColumn = (c == 0 && (edgeMask & EdgeLeft)) || (c == chunkSize && (edgeMask & EdgeRight));
+			if (stitchRow && (c % coarseStep) != 0)
+			{
+				c -= step;
+			}
+			if (stitchColumn && (r % coarseStep) != 0)
+			{
+				r -= step;
+			}
+			return static_cast<uint16_t>((r * verticesPerRow) + c);
+		};
+
+		auto addTriangle = [&](uint16_t a, uint16_t b, uint16_t c)
+		{
+			// snapping turns some triangles into slivers of zero area, those are dropped
+			if (a != b && b != c && a != c)
+			{
+				indices.push_back(a);
+				indices.push_back(b);
+				indices.push_back(c);
+			}
+		};
+
+		// same winding as MeshBuilder's planes, clockwise seen from above
+		for (uint32_t r = 0; r < chunkSize; r += step)
+		{
+			for (uint32_t c = 0; c < chunkSize; c += step)
+			{
+				addTriangle(getIndex(c, r), getIndex(c + step, r + step), getIndex(c + step, r));
+				addTriangle(getIndex(c, r), getIndex(c, r + step), getIndex(c + step, r + step));
+			}
+		}
+	}
+}
+
+void Terrain::Initialize(const std::filesystem::path& heightmapPath, const Desc& desc)
+{
+	ASSERT(IsPowerOfTwo(desc.chunkSize), "Terrain: chunk size must be a power of two");
+	ASSERT(desc.chunkSize < 256, "Terrain: chunk vertices must be addressable with 16 bit indices");
+	ASSERT(desc.lodCount > 0 && (1u << (desc.lodCount - 1)) <= desc.chunkSize, "Terrain: too many LODs for the chunk size");
+
+	mDesc = desc;
+	if (!mHeightmap.Initialize(heightmapPath))
+	{
+		return;
+	}
+
+	mChunkColumns = std::max((mHeightmap.GetColumns() - 1) / mDesc.chunkSize, 1u);
+	mChunkRows = std::max((mHeightmap.GetRows() - 1) / mDesc.chunkSize, 1u);
+	mWidth = static_cast<float>(mChunkColumns * mDesc.chunkSize) * mDesc.cellSize;
+	mLength = static_cast<float>(mChunkRows * mDesc.chunkSize) * mDesc.cellSize;
+
+	mChunks.resize(static_cast<size_t>(mChunkColumns) * mChunkRows);
+	for (uint32_t row = 0; row < mChunkRows; ++row)
+	{
+		for (uint32_t column = 0; column < mChunkColumns; ++column)
+		{
+			Chunk& chunk = mChunks[(row * mChunkColumns) + column];
+			chunk.column = column;
+			chunk.row = row;
+
+			// bounding sphere around the full detail vertices
+			float minHeight = std::numeric_limits<float>::max();
+			float maxHeight = std::numeric_limits<float>::lowest();
+			for (uint32_t z = 0; z <= mDesc.chunkSize; ++z)
+			{
+				for (uint32_t x = 0; x <= mDesc.chunkSize; ++x)
+				{
+					const float height = GetGridVertex((column * mDesc.chunkSize) + x, (row * mDesc.chunkSize) + z).position.y;
+					minHeight = std::min(minHeight, height);
+					maxHeight = std::max(maxHeight, height);
+				}
+			}
+
+			const float chunkWorldSize = static_cast<float>(mDesc.chunkSize) * mDesc.cellSize;
+			chunk.center = {
+				(-mWidth * 0.5f) + ((static_cast<float>(column) + 0.5f) * chunkWorldSize),
+				(minHeight + maxHeight) * 0.5f,
+				(-mLength * 0.5f) + ((static_cast<float>(row) + 0.5f) * chunkWorldSize)
+			};
+			chunk.radius = Magnitude({ chunkWorldSize * 0.5f, (maxHeight - minHeight) * 0.5f, chunkWorldSize * 0.5f });
+		}
+	}
+
+	CreateIndexBuffer();
+}
+
+void Terrain::Terminate()
+{
+	for (Chunk& chunk : mChunks)
+	{
+		UnloadChunk(chunk);
+	}
+	mChunks.clear();
+	mIndexRanges.clear();
+	SafeRelease(mIndexBuffer);
+	mHeightmap.Terminate();
+	mResidentCount = 0;
+	mVisibleCount = 0;
+	mTriangleCount = 0;
+}
+
+void Terrain::Update(const Camera& camera)
+{
+	// chunk bounds are in world space, so the planes come from view * proj alone
+	const Frustum frustum(camera.GetViewMatrix() * camera.GetProjectionMatrix());
+	const Vector3& viewPosition = camera.GetPosition();
+	for (Chunk& chunk : mChunks)
+	{
+		chunk.distance = std::max(Magnitude(viewPosition - chunk.center) - chunk.radius, 0.0f);
+		chunk.visible = frustum.IsSphereVisible(chunk.center, chunk.radius);
+	}
+
+	// LODs still cover every chunk, a hidden neighbour decides the stitching of a visible edge
+	SelectLods();
+
+	// release what moved out of range, then stream in the nearest missing visible chunks.
+	// Chunks that leave the frustum stay resident while in range so turning around does not reload them.
+	std::vector<Chunk*> loadQueue;
+	for (Chunk& chunk : mChunks)
+	{
+		if (chunk.vertexBuffer != nullptr && chunk.distance > mDesc.residentDistance * UnloadHysteresis)
+		{
+			UnloadChunk(chunk);
+		}
+		else if (chunk.vertexBuffer == nullptr && chunk.visible && chunk.distance <= mDesc.residentDistance)
+		{
+			loadQueue.push_back(&chunk);
+		}
+	}
+	std::sort(loadQueue.begin(), loadQueue.end(), [](const Chunk* a, const Chunk* b)
+	{
+		return a->distance < b->distance;
+	});
+	const size_t loadCount = std::min<size_t>(loadQueue.size(), mDesc.maxLoadsPerFrame);
+	for (size_t i = 0; i < loadCount; ++i)
+	{
+		LoadChunk(*loadQueue[i]);
+	}
+
+	mResidentCount = 0;
+	mVisibleCount = 0;
+	mTriangleCount = 0;
+	for (const Chunk& chunk : mChunks)
+	{
+		if (chunk.vertexBuffer != nullptr)
+		{
+			++mResidentCount;
+			if (chunk.visible)
+			{
+				++mVisibleCount;
+				mTriangleCount += GetIndexRange(chunk.lod, chunk.edgeMask).indexCount / 3;
+			}
+		}
+	}
+}
+
+void Terrain::Render() const
+{
+	if (mIndexBuffer == nullptr)
+	{
+		return;
+	}
+
+	auto context = GraphicsSystem::Get()->GetContext();
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context->IASetIndexBuffer(mIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
+
+	const UINT stride = sizeof(PackedVertexPXUNorm);
+	const UINT offset = 0;
+	for (const Chunk& chunk : mChunks)
+	{
+		if (chunk.vertexBuffer == nullptr || !chunk.visible)
+		{
+			continue;
+		}
+
+		const IndexRange& range = GetIndexRange(chunk.lod, chunk.edgeMask);
+		context->IASetVertexBuffers(0, 1, &chunk.vertexBuffer, &stride, &offset);
+		context->DrawIndexed(range.indexCount, range.startIndex, 0);
+	}
+}
+
+float Terrain::GetHeight(float x, float z) const
+{
+	if (!mHeightmap.IsValid())
+	{
+		return 0.0f;
+	}
+	const float u = (x + (mWidth * 0.5f)) / mWidth;
+	const float v = (z + (mLength * 0.5f)) / mLength;
+	return mHeightmap.Sample(u, v) * mDesc.heightScale;
+}
+
+void Terrain::CreateIndexBuffer()
+{
+	std::vector<uint16_t> indices;
+	mIndexRanges.resize(mDesc.lodCount * EdgeMaskCount);
+	for (uint32_t lod = 0; lod < mDesc.lodCount; ++lod)
+	{
+		for (uint32_t edgeMask = 0; edgeMask < EdgeMaskCount; ++edgeMask)
+		{
+			IndexRange& range = mIndexRanges[(lod * EdgeMaskCount) + edgeMask];
+			range.startIndex = static_cast<uint32_t>(indices.size());
+			CreateLodIndices(indices, mDesc.chunkSize, lod, edgeMask);
+			range.indexCount = static_cast<uint32_t>(indices.size()) - range.startIndex;
+		}
+	}
+
+	D3D11_BUFFER_DESC bufferDesc{};
+	bufferDesc.ByteWidth = static_cast<UINT>(indices.size() * sizeof(uint16_t));
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA initData{};
+	initData.pSysMem = indices.data();
+
+	auto device = GraphicsSystem::Get()->GetDevice();
+	HRESULT hr = device->CreateBuffer(&bufferDesc, &initData, &mIndexBuffer);
+	ASSERT(SUCCEEDED(hr), "Terrain: failed to create index buffer");
+}
+
+VertexPX Terrain::GetGridVertex(uint32_t x, uint32_t z) const
+{
+	const float u = static_cast<float>(x) / static_cast<float>(mChunkColumns * mDesc.chunkSize);
+	const float v = static_cast<float>(z) / static_cast<float>(mChunkRows * mDesc.chunkSize);
+
+	VertexPX vertex;
+	vertex.position = {
+		(-mWidth * 0.5f) + (static_cast<float>(x) * mDesc.cellSize),
+		mHeightmap.Sample(u, v) * mDesc.heightScale,
+		(-mLength * 0.5f) + (static_cast<float>(z) * mDesc.cellSize)
+	};
+	vertex.uvCoord = { u, v };
+	return vertex;
+}
+
+void Terrain::LoadChunk(Chunk& chunk)
+{
+	const uint32_t verticesPerRow = mDesc.chunkSize + 1;
+	// grid uvs span [0, 1] over the whole map, so they fit UNORM16 and keep texel precision everywhere
+	std::vector<PackedVertexPXUNorm> vertices(static_cast<size_t>(verticesPerRow) * verticesPerRow);
+	for (uint32_t z = 0; z < verticesPerRow; ++z)
+	{
+		for (uint32_t x = 0; x < verticesPerRow; ++x)
+		{
+			vertices[(z * verticesPerRow) + x] = VertexPacking::PackUNorm(GetGridVertex((chunk.column * mDesc.chunkSize) + x, (chunk.row * mDesc.chunkSize) + z));
+		}
+	}
+
+	D3D11_BUFFER_DESC bufferDesc{};
+	bufferDesc.ByteWidth = static_cast<UINT>(vertices.size() * sizeof(PackedVertexPXUNorm));
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+	D3D11_SUBRESOURCE_DATA initData{};
+	initData.pSysMem = vertices.data();
+
+	auto device = GraphicsSystem::Get()->GetDevice();
+	HRESULT hr = device->CreateBuffer(&bufferDesc, &initData, &chunk.vertexBuffer);
+	if (FAILED(hr))
+	{
+		LOG("Terrain: failed to create vertex buffer for chunk %u, %u", chunk.column, chunk.row);
+		chunk.vertexBuffer = nullptr;
+	}
+}
+
+void Terrain::UnloadChunk(Chunk& chunk)
+{
+	SafeRelease(chunk.vertexBuffer);
+}
+
+void Terrain::SelectLods()
+{
+	const uint32_t maxLod = mDesc.lodCount - 1;
+	for (Chunk& chunk : mChunks)
+	{
+		chunk.lod = 0;
+		while (chunk.lod < maxLod && chunk.distance > mDesc.lodDistance * static_cast<float>(1u << chunk.lod))
+		{
+			++chunk.lod;
+		}
+	}
+
+	// stitching only covers one LOD of difference, so refine chunks until every neighbour is within one.
+	// Each pass settles at least one more LOD level, so this ends after maxLod passes at most.
+	const int32_t offsets[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (Chunk& chunk : mChunks)
+		{
+			for (const auto& offset : offsets)
+			{
+				const Chunk* neighbour = GetChunk(static_cast<int32_t>(chunk.column) + offset[0], static_cast<int32_t>(chunk.row) + offset[1]);
+				if (neighbour != nullptr && chunk.lod > neighbour->lod + 1)
+				{
+					chunk.lod = neighbour->lod + 1;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	const uint32_t edges[4] = { EdgeBottom, EdgeRight, EdgeTop, EdgeLeft };
+	for (Chunk& chunk : mChunks)
+	{
+		chunk.edgeMask = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			const Chunk* neighbour = GetChunk(static_cast<int32_t>(chunk.column) + offsets[i][0], static_cast<int32_t>(chunk.row) + offsets[i][1]);
+			if (neighbour != nullptr && neighbour->lod > chunk.lod)
+			{
+				chunk.edgeMask |= edges[i];
+			}
+		}
+	}
+}
+
+Terrain::Chunk* Terrain::GetChunk(int32_t column, int32_t row)
+{
+	if (column < 0 || row < 0 || column >= static_cast<int32_t>(mChunkColumns) || row >= static_cast<int32_t>(mChunkRows))
+	{
+		return nullptr;
+	}
+	return &mChunks[(row * mChunkColumns) + column];
+}
+
+const Terrain::IndexRange& Terrain::GetIndexRange(uint32_t lod, uint32_t edgeMask) const
+{
+	return mIndexRanges[(lod * EdgeMaskCount) + edgeMask];
+}
\ No newline at end of file
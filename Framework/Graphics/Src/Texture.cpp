@@ -2,11 +2,125 @@
 #include "Texture.h"
 
 #include "GraphicsSystem.h"
+#include "HotReload.h"
+#include "Image.h"
+#include "TextureFile.h"
 #include <DirectXTK/Inc/WICTextureLoader.h>
 
 using namespace SumEngine;
 using namespace SumEngine::Graphics;
 
+namespace
+{
+	// the cooked file wins when it is at least as new as the source image,
+	// or when it is the only file that was shipped
+	bool IsCookedUpToDate(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath)
+	{
+		std::error_code ec;
+		const auto cookedTime = std::filesystem::last_write_time(cookedPath, ec);
+		if (ec)
+		{
+			return false;
+		}
+		const auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+		return ec || cookedTime >= sourceTime;
+	}
+
+	bool CreateCookedTexture(const uint8_t* data, size_t size, ID3D11ShaderResourceView** shaderResourceView)
+	{
+		using namespace TextureFile;
+
+		if (size < sizeof(Header))
+		{
+			return false;
+		}
+
+		const Header* header = reinterpret_cast<const Header*>(data);
+		if (header->magic != Magic || header->version != Version || header->mipCount == 0 || header->mipCount > D3D11_REQ_MIP_LEVELS)
+		{
+			return false;
+		}
+		if (size < sizeof(Header) + (header->mipCount * sizeof(MipDesc)))
+		{
+			return false;
+		}
+
+		const MipDesc* mips = reinterpret_cast<const MipDesc*>(data + sizeof(Header));
+		D3D11_SUBRESOURCE_DATA initData[D3D11_REQ_MIP_LEVELS]{};
+		for (uint32_t i = 0; i < header->mipCount; ++i)
+		{
+			if (mips[i].offset + mips[i].size > size)
+			{
+				return false;
+			}
+			initData[i].pSysMem = data + mips[i].offset;
+			initData[i].SysMemPitch = mips[i].rowPitch;
+			initData[i].SysMemSlicePitch = mips[i].size;
+		}
+
+		D3D11_TEXTURE2D_DESC desc{};
+		desc.Width = header->width;
+		desc.Height = header->height;
+		desc.MipLevels = header->mipCount;
+		desc.ArraySize = 1;
+		desc.Format = GetDXGIFormat(header->compression);
+		desc.SampleDesc.Count = 1;
+		desc.SampleDesc.Quality = 0;
+		desc.Usage = D3D11_USAGE_IMMUTABLE;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		desc.CPUAccessFlags = 0;
+		desc.MiscFlags = 0;
+
+		auto device = GraphicsSystem::Get()->GetDevice();
+		ID3D11Texture2D* texture = nullptr;
+		HRESULT hr = device->CreateTexture2D(&desc, initData, &texture);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		hr = device->CreateShaderResourceView(texture, nullptr, shaderResourceView);
+		SafeRelease(texture);
+		return SUCCEEDED(hr);
+	}
+
+	// same result as the WIC loader with a context: full mip chain generated on the GPU
+	bool CreateImageTexture(const Image& image, ID3D11ShaderResourceView** shaderResourceView)
+	{
+		D3D11_TEXTURE2D_DESC desc{};
+		desc.Width = image.GetWidth();
+		desc.Height = image.GetHeight();
+		desc.MipLevels = 0;
+		desc.ArraySize = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = 1;
+		desc.SampleDesc.Quality = 0;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+		desc.CPUAccessFlags = 0;
+		desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+		auto device = GraphicsSystem::Get()->GetDevice();
+		auto context = GraphicsSystem::Get()->GetContext();
+		ID3D11Texture2D* texture = nullptr;
+		HRESULT hr = device->CreateTexture2D(&desc, nullptr, &texture);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		context->UpdateSubresource(texture, 0, nullptr, image.GetPixels(), image.GetWidth() * 4, 0);
+		hr = device->CreateShaderResourceView(texture, nullptr, shaderResourceView);
+		SafeRelease(texture);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+		context->GenerateMips(*shaderResourceView);
+		return true;
+	}
+}
+
 void Texture::UnbindPS(uint32_t slot)
 {
 	static ID3D11ShaderResourceView* dummy = nullptr;
@@ -20,23 +134,47 @@ Texture::~Texture()
 
 Texture::Texture(Texture&& rhs) noexcept
 	: mShaderResourceView(rhs.mShaderResourceView)
+	, mFileName(std::move(rhs.mFileName))
 {
 	rhs.mShaderResourceView = nullptr;
+	HotReload::Unregister(&rhs);
+	if (!mFileName.empty())
+	{
+		RegisterHotReload();
+	}
 }
 
 Texture& Texture::operator=(Texture&& rhs) noexcept
 {
 	mShaderResourceView = rhs.mShaderResourceView;
 	rhs.mShaderResourceView = nullptr;
+	mFileName = std::move(rhs.mFileName);
+	HotReload::Unregister(&rhs);
+	HotReload::Unregister(this);
+	if (!mFileName.empty())
+	{
+		RegisterHotReload();
+	}
 	return *this;
 }
 
 void Texture::Initialize(const std::filesystem::path& fileName)
 {
-	auto device = GraphicsSystem::Get()->GetDevice();
-	auto context = GraphicsSystem::Get()->GetContext();
-	HRESULT hr = DirectX::CreateWICTextureFromFile(device, context, fileName.c_str(), nullptr, &mShaderResourceView);
-	ASSERT(SUCCEEDED(hr), "Texture: failed to create texture %s", fileName.c_str());
+	const std::filesystem::path cookedPath = TextureFile::GetCookedPath(fileName);
+	if (fileName.extension() == TextureFile::Extension || IsCookedUpToDate(fileName, cookedPath))
+	{
+		InitializeCooked(cookedPath);
+	}
+	else
+	{
+		auto device = GraphicsSystem::Get()->GetDevice();
+		auto context = GraphicsSystem::Get()->GetContext();
+		HRESULT hr = DirectX::CreateWICTextureFromFile(device, context, fileName.c_str(), nullptr, &mShaderResourceView);
+		ASSERT(SUCCEEDED(hr), "Texture: failed to create texture %ls", fileName.c_str());
+	}
+
+	mFileName = fileName;
+	RegisterHotReload();
 }
 
 void Texture::Initialize(uint32_t width, uint32_t height, Format format)
@@ -46,6 +184,8 @@ void Texture::Initialize(uint32_t width, uint32_t height, Format format)
 
 void Texture::Terminate()
 {
+	HotReload::Unregister(this);
+	mFileName.clear();
 	SafeRelease(mShaderResourceView);
 }
 
@@ -66,6 +206,65 @@ void* Texture::GetRawData() const
 	return mShaderResourceView;
 }
 
+void Texture::InitializeCooked(const std::filesystem::path& fileName)
+{
+	// the mip data is uploaded straight from the mapped pages, no staging copy
+	Core::MappedFile file;
+	if (!file.Open(fileName))
+	{
+		ASSERT(false, "Texture: failed to open %ls", fileName.c_str());
+		return;
+	}
+	file.Prefetch();
+
+	const Core::Span<const uint8_t> data = file.GetData();
+	const bool success = CreateCookedTexture(data.data(), data.size(), &mShaderResourceView);
+	ASSERT(success, "Texture: invalid cooked texture %ls", fileName.c_str());
+}
+
+void Texture::RegisterHotReload()
+{
+	const std::filesystem::path fileName = mFileName;
+	const std::filesystem::path cookedPath = TextureFile::GetCookedPath(fileName);
+	HotReload::Register(this, { fileName, cookedPath }, [this, fileName, cookedPath]()
+	{
+		if (fileName.extension() == TextureFile::Extension || IsCookedUpToDate(fileName, cookedPath))
+		{
+			ID3D11ShaderResourceView* shaderResourceView = nullptr;
+			Core::MappedFile file;
+			if (!file.Open(cookedPath) || !CreateCookedTexture(file.GetData().data(), file.GetSize(), &shaderResourceView))
+			{
+				return HotReload::ApplyFunc();
+			}
+			return HotReload::ApplyFunc([this, shaderResourceView](bool commit) mutable
+			{
+				if (commit)
+				{
+					std::swap(mShaderResourceView, shaderResourceView);
+				}
+				SafeRelease(shaderResourceView);
+			});
+		}
+
+		// decoding is the slow part and stays on the reload thread,
+		// the upload needs the immediate context for mip generation
+		auto image = std::make_shared<Image>();
+		if (!image->Load(fileName))
+		{
+			return HotReload::ApplyFunc();
+		}
+		return HotReload::ApplyFunc([this, image](bool commit)
+		{
+			ID3D11ShaderResourceView* shaderResourceView = nullptr;
+			if (commit && CreateImageTexture(*image, &shaderResourceView))
+			{
+				std::swap(mShaderResourceView, shaderResourceView);
+			}
+			SafeRelease(shaderResourceView);
+		});
+	});
+}
+
 DXGI_FORMAT Texture::GetDXGIFormat(Format format)
 {
 	switch (format)
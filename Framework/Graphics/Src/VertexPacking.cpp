@@ -0,0 +1,254 @@
+#include "Precompiled.h"
+#include "VertexPacking.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+
+namespace
+{
+	uint8_t ToUNorm8(float value)
+	{
+		return static_cast<uint8_t>(Clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	float SignNotZero(float value)
+	{
+		return (value >= 0.0f) ? 1.0f : -1.0f;
+	}
+}
+
+uint32_t VertexPacking::PackUNorm8(const Color& color)
+{
+	return static_cast<uint32_t>(ToUNorm8(color.x))
+		| (static_cast<uint32_t>(ToUNorm8(color.y)) << 8)
+		| (static_cast<uint32_t>(ToUNorm8(color.z)) << 16)
+		| (static_cast<uint32_t>(ToUNorm8(color.w)) << 24);
+}
+
+Color VertexPacking::UnpackUNorm8(uint32_t packed)
+{
+	constexpr float scale = 1.0f / 255.0f;
+	return {
+		static_cast<float>(packed & 0xFF) * scale,
+		static_cast<float>((packed >> 8) & 0xFF) * scale,
+		static_cast<float>((packed >> 16) & 0xFF) * scale,
+		static_cast<float>((packed >> 24) & 0xFF) * scale
+	};
+}
+
+uint16_t VertexPacking::FloatToHalf(float value)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF);
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (exponent == 0xFF)
+	{
+		// inf stays inf, nan stays a quiet nan
+		return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+	}
+
+	const int32_t halfExponent = exponent - 127 + 15;
+	if (halfExponent >= 0x1F)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+
+	uint32_t half = 0;
+	uint32_t remainder = 0;
+	uint32_t halfway = 0;
+	if (halfExponent <= 0)
+	{
+		// denormal, or too small for a half
+		if (halfExponent < -10)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x800000;
+		const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+		half = mantissa >> shift;
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+	else
+	{
+		half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+		remainder = mantissa & 0x1FFF;
+		halfway = 0x1000;
+	}
+
+	// a carry out of the mantissa correctly bumps the exponent, up to inf
+	if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+	{
+		++half;
+	}
+	return static_cast<uint16_t>(sign | half);
+}
+
+float VertexPacking::HalfToFloat(uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+
+	uint32_t bits = 0;
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// normalize the denormal
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+		}
+	}
+	else
+	{
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	float result = 0.0f;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+uint16_t VertexPacking::PackUNorm16(float value)
+{
+	return static_cast<uint16_t>(Clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+int16_t VertexPacking::PackSNorm16(float value)
+{
+	return static_cast<int16_t>(std::round(Clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+void VertexPacking::EncodeOctahedral(const Vector3& direction, int16_t encoded[2])
+{
+	const float l1Norm = Abs(direction.x) + Abs(direction.y) + Abs(direction.z);
+	if (l1Norm <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float u = direction.x / l1Norm;
+	float v = direction.y / l1Norm;
+	if (direction.z < 0.0f)
+	{
+		// fold the lower hemisphere over the diagonals
+		const float foldedU = (1.0f - Abs(v)) * SignNotZero(u);
+		const float foldedV = (1.0f - Abs(u)) * SignNotZero(v);
+		u = foldedU;
+		v = foldedV;
+	}
+	encoded[0] = PackSNorm16(u);
+	encoded[1] = PackSNorm16(v);
+}
+
+Vector3 VertexPacking::DecodeOctahedral(const int16_t encoded[2])
+{
+	const float u = Max(static_cast<float>(encoded[0]) / 32767.0f, -1.0f);
+	const float v = Max(static_cast<float>(encoded[1]) / 32767.0f, -1.0f);
+
+	Vector3 direction(u, v, 1.0f - Abs(u) - Abs(v));
+	if (direction.z < 0.0f)
+	{
+		direction.x = (1.0f - Abs(v)) * SignNotZero(u);
+		direction.y = (1.0f - Abs(u)) * SignNotZero(v);
+	}
+	return Normalize(direction);
+}
+
+void VertexPacking::PackBoneWeights(const float weights[Vertex::MaxBoneWeights], uint8_t packed[Vertex::MaxBoneWeights])
+{
+	float total = 0.0f;
+	for (int i = 0; i < Vertex::MaxBoneWeights; ++i)
+	{
+		total += Max(weights[i], 0.0f);
+	}
+	if (total <= 0.0f)
+	{
+		std::fill(packed, packed + Vertex::MaxBoneWeights, static_cast<uint8_t>(0));
+		return;
+	}
+
+	int packedTotal = 0;
+	int largest = 0;
+	for (int i = 0; i < Vertex::MaxBoneWeights; ++i)
+	{
+		packed[i] = ToUNorm8(Max(weights[i], 0.0f) / total);
+		packedTotal += packed[i];
+		if (packed[i] > packed[largest])
+		{
+			largest = i;
+		}
+	}
+
+	// rounding error goes to the largest weight, where it matters least
+	packed[largest] = static_cast<uint8_t>(packed[largest] + (255 - packedTotal));
+}
+
+void VertexPacking::PackBoneIndices(const int indices[Vertex::MaxBoneWeights], uint8_t packed[Vertex::MaxBoneWeights])
+{
+	for (int i = 0; i < Vertex::MaxBoneWeights; ++i)
+	{
+		ASSERT(indices[i] >= 0 && indices[i] <= 0xFF, "VertexPacking: bone index %d does not fit in 8 bits", indices[i]);
+		packed[i] = static_cast<uint8_t>(indices[i]);
+	}
+}
+
+PackedVertexPC VertexPacking::Pack(const VertexPC& vertex)
+{
+	PackedVertexPC packed;
+	packed.position = vertex.position;
+	packed.color = PackUNorm8(vertex.color);
+	return packed;
+}
+
+PackedVertexPX VertexPacking::Pack(const VertexPX& vertex)
+{
+	PackedVertexPX packed;
+	packed.position = vertex.position;
+	packed.uvCoord[0] = FloatToHalf(vertex.uvCoord.x);
+	packed.uvCoord[1] = FloatToHalf(vertex.uvCoord.y);
+	return packed;
+}
+
+PackedVertex VertexPacking::Pack(const Vertex& vertex)
+{
+	PackedVertex packed;
+	packed.position = vertex.position;
+	EncodeOctahedral(vertex.normal, packed.normal);
+	EncodeOctahedral(vertex.tangent, packed.tangent);
+	packed.uvCoord[0] = FloatToHalf(vertex.uvCoord.x);
+	packed.uvCoord[1] = FloatToHalf(vertex.uvCoord.y);
+	PackBoneIndices(vertex.boneIndices, packed.boneIndices);
+	PackBoneWeights(vertex.boneWeights, packed.boneWeights);
+	return packed;
+}
+
+PackedVertexPXUNorm VertexPacking::PackUNorm(const VertexPX& vertex)
+{
+	PackedVertexPXUNorm packed;
+	packed.position = vertex.position;
+	packed.uvCoord[0] = PackUNorm16(vertex.uvCoord.x);
+	packed.uvCoord[1] = PackUNorm16(vertex.uvCoord.y);
+	return packed;
+}
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include "VertexShader.h"
 
 #include "GraphicsSystem.h"
+#include "HotReload.h"
+#include "ShaderArchive.h"
+#include "ShaderCache.h"
 #include "VertexTypes.h"
 
 using namespace SumEngine;
@@ -22,80 +25,147 @@ namespace
         {
             desc.push_back({ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
+        else if (vertexFormat & VE_NormalOct)
+        {
+            desc.push_back({ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
         if (vertexFormat & VE_Tangent)
         {
             desc.push_back({ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
+        else if (vertexFormat & VE_TangentOct)
+        {
+            desc.push_back({ "TANGENT", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
         if (vertexFormat & VE_Color)
         {
             desc.push_back({ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
+        else if (vertexFormat & VE_ColorUNorm8)
+        {
+            desc.push_back({ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
         if (vertexFormat & VE_TexCoord)
         {
             desc.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
+        else if (vertexFormat & VE_TexCoordHalf)
+        {
+            desc.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
+        else if (vertexFormat & VE_TexCoordUNorm16)
+        {
+            desc.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
         if (vertexFormat & VE_BlendIndex)
         {
             desc.push_back({ "BLENDINDICES", 0, DXGI_FORMAT_R32G32B32A32_SINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
+        else if (vertexFormat & VE_BlendIndexUInt8)
+        {
+            desc.push_back({ "BLENDINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
         if (vertexFormat & VE_BlendWeight)
         {
             desc.push_back({ "BLENDWEIGHT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
         }
+        else if (vertexFormat & VE_BlendWeightUNorm8)
+        {
+            desc.push_back({ "BLENDWEIGHT", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 });
+        }
 
         return desc;
     }
+
+    // the device is free threaded, hot reload also calls this from its worker thread
+    bool CreateVertexShader(Core::Span<const uint8_t> bytecode, uint32_t format, ID3D11VertexShader** vertexShader, ID3D11InputLayout** inputLayout)
+    {
+        // create a vertex shader
+
+        auto device = GraphicsSystem::Get()->GetDevice();
+        HRESULT hr = device->CreateVertexShader(
+            bytecode.data(),
+            bytecode.size(),
+            nullptr,
+            vertexShader
+        );
+        if (FAILED(hr))
+        {
+            LOG("VertexShader: failed to create vertex shader");
+            return false;
+        }
+
+        //=================================================
+        // create input layout
+        std::vector<D3D11_INPUT_ELEMENT_DESC> vertexLayout = GetVertexLayout(format);
+
+        hr = device->CreateInputLayout(
+            vertexLayout.data(),
+            (UINT)vertexLayout.size(),
+            bytecode.data(),
+            bytecode.size(),
+            inputLayout
+        );
+        if (FAILED(hr))
+        {
+            LOG("VertexShader: failed to create input layout");
+            SafeRelease(*vertexShader);
+            return false;
+        }
+        return true;
+    }
 }
 
-void VertexShader::Initialize(const std::filesystem::path& filePath, uint32_t format)
+void VertexShader::Initialize(const std::filesystem::path& filePath, uint32_t format, uint32_t permutation)
 {
-    // create a vertex shader
-
-    auto device = GraphicsSystem::Get()->GetDevice();
-    DWORD shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
-    ID3DBlob* shaderBlob = nullptr;
-    ID3DBlob* errorBlob = nullptr;
-    HRESULT hr = D3DCompileFromFile(
-        filePath.c_str(),
-        nullptr,
-        D3D_COMPILE_STANDARD_FILE_INCLUDE,
-        "VS", "vs_5_0",
-        shaderFlags, 0,
-        &shaderBlob,
-        &errorBlob
-    );
-    if (errorBlob != nullptr && errorBlob->GetBufferPointer() != nullptr)
+    ShaderCompileDesc compileDesc;
+    compileDesc.filePath = filePath;
+    compileDesc.entryPoint = "VS";
+    compileDesc.profile = "vs_5_0";
+    compileDesc.permutation = permutation;
+    compileDesc.flags = ShaderCache::GetDefaultFlags();
+    std::vector<uint8_t> bytecode;
+    const bool compiled = ShaderCache::Compile(compileDesc, bytecode);
+    ASSERT(compiled, "Failed to compile vertex shader");
+
+    const bool created = CreateVertexShader(bytecode, format, &mVertexShader, &mInputLayout);
+    ASSERT(created, "Failed to create vertex shader");
+
+    // recompile when the source changes, the new shader is swapped in by HotReload::Update
+    HotReload::Register(this, { filePath }, [this, compileDesc, format]()
     {
-        LOG("%s", static_cast<const char*>(errorBlob->GetBufferPointer()));
-    }
-    ASSERT(SUCCEEDED(hr), "Failed to compile vertex shader");
-
-    hr = device->CreateVertexShader(
-        shaderBlob->GetBufferPointer(),
-        shaderBlob->GetBufferSize(),
-        nullptr,
-        &mVertexShader
-    );
-    ASSERT(SUCCEEDED(hr), "Failed to create vertex shader");
-
-    //=================================================
-    // create input layout
-    std::vector<D3D11_INPUT_ELEMENT_DESC> vertexLayout = GetVertexLayout(format);
-
-    hr = device->CreateInputLayout(
-        vertexLayout.data(),
-        (UINT)vertexLayout.size(),
-        shaderBlob->GetBufferPointer(),
-        shaderBlob->GetBufferSize(),
-        &mInputLayout
-    );
-    ASSERT(SUCCEEDED(hr), "Failed to create input layout");
-    SafeRelease(shaderBlob);
-    SafeRelease(errorBlob);
+        std::vector<uint8_t> bytecode;
+        ID3D11VertexShader* vertexShader = nullptr;
+        ID3D11InputLayout* inputLayout = nullptr;
+        if (!ShaderCache::Compile(compileDesc, bytecode) || !CreateVertexShader(bytecode, format, &vertexShader, &inputLayout))
+        {
+            return HotReload::ApplyFunc();
+        }
+        return HotReload::ApplyFunc([this, vertexShader, inputLayout](bool commit) mutable
+        {
+            if (commit)
+            {
+                std::swap(mVertexShader, vertexShader);
+                std::swap(mInputLayout, inputLayout);
+            }
+            SafeRelease(vertexShader);
+            SafeRelease(inputLayout);
+        });
+    });
+}
+
+void VertexShader::Initialize(const ShaderArchive& archive, uint32_t permutation, uint32_t format)
+{
+    const Core::Span<const uint8_t> bytecode = archive.GetBytecode(ShaderArchiveFile::Stage::Vertex, permutation);
+    ASSERT(!bytecode.empty(), "VertexShader: permutation %u is not in the archive", permutation);
+
+    const bool created = CreateVertexShader(bytecode, format, &mVertexShader, &mInputLayout);
+    ASSERT(created, "Failed to create vertex shader");
 }
 
 void VertexShader::Terminate()
 {
+    HotReload::Unregister(this);
     SafeRelease(mInputLayout);
     SafeRelease(mVertexShader);
 }
@@ -105,4 +175,4 @@ void VertexShader::Bind()
     auto context = GraphicsSystem::Get()->GetContext();
     context->VSSetShader(mVertexShader, nullptr, 0);
     context->IASetInputLayout(mInputLayout);
-}
+}
\ No newline at end of file
@@ -0,0 +1,582 @@
+#include "BlockCompression.h"
+
+#include <cfloat>
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace AssetCooker;
+
+namespace
+{
+	constexpr int kBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	template<int N>
+	float DistanceSqr(const float* a, const float* b)
+	{
+		float result = 0.0f;
+		for (int c = 0; c < N; ++c)
+		{
+			const float d = a[c] - b[c];
+			result += d * d;
+		}
+		return result;
+	}
+
+	// Fits a line through the block using the principal axis of the covariance matrix and
+	// returns the two extremes of the projected pixels as the starting endpoints.
+	template<int N>
+	void ComputePrincipalEndpoints(const float pixels[16][4], float minEnd[N], float maxEnd[N])
+	{
+		float mean[N] = {};
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int c = 0; c < N; ++c)
+			{
+				mean[c] += pixels[i][c] / 16.0f;
+			}
+		}
+
+		float covariance[N][N] = {};
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int r = 0; r < N; ++r)
+			{
+				for (int c = 0; c < N; ++c)
+				{
+					covariance[r][c] += (pixels[i][r] - mean[r]) * (pixels[i][c] - mean[c]);
+				}
+			}
+		}
+
+		// power iteration converges quickly for the dominant axis
+		float axis[N];
+		for (int c = 0; c < N; ++c)
+		{
+			axis[c] = 1.0f;
+		}
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[N] = {};
+			float length = 0.0f;
+			for (int r = 0; r < N; ++r)
+			{
+				for (int c = 0; c < N; ++c)
+				{
+					next[r] += covariance[r][c] * axis[c];
+				}
+				length += next[r] * next[r];
+			}
+			if (length < 1e-8f)
+			{
+				break;
+			}
+			length = sqrtf(length);
+			for (int c = 0; c < N; ++c)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+
+		float minT = FLT_MAX;
+		float maxT = -FLT_MAX;
+		for (int i = 0; i < 16; ++i)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < N; ++c)
+			{
+				t += (pixels[i][c] - mean[c]) * axis[c];
+			}
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for (int c = 0; c < N; ++c)
+		{
+			minEnd[c] = std::clamp(mean[c] + (axis[c] * minT), 0.0f, 255.0f);
+			maxEnd[c] = std::clamp(mean[c] + (axis[c] * maxT), 0.0f, 255.0f);
+		}
+	}
+
+	// Least squares fit of both endpoints for a fixed set of interpolation weights.
+	// Returns false when the system is degenerate (all pixels share one weight).
+	template<int N>
+	bool RefineEndpoints(const float pixels[16][4], const float weights[16], float end0[N], float end1[N])
+	{
+		float aa = 0.0f;
+		float ab = 0.0f;
+		float bb = 0.0f;
+		float ax[N] = {};
+		float bx[N] = {};
+		for (int i = 0; i < 16; ++i)
+		{
+			const float b = weights[i];
+			const float a = 1.0f - b;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < N; ++c)
+			{
+				ax[c] += a * pixels[i][c];
+				bx[c] += b * pixels[i][c];
+			}
+		}
+
+		const float det = (aa * bb) - (ab * ab);
+		if (fabsf(det) < 1e-6f)
+		{
+			return false;
+		}
+
+		const float invDet = 1.0f / det;
+		for (int c = 0; c < N; ++c)
+		{
+			end0[c] = std::clamp(((ax[c] * bb) - (bx[c] * ab)) * invDet, 0.0f, 255.0f);
+			end1[c] = std::clamp(((bx[c] * aa) - (ax[c] * ab)) * invDet, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	void LoadBlock(const uint8_t* rgba, float pixels[16][4])
+	{
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				pixels[i][c] = static_cast<float>(rgba[(i * 4) + c]);
+			}
+		}
+	}
+
+	//--------------------------------------------------------------------------------------------
+	// BC1 color block
+
+	uint16_t PackRGB565(const float color[3])
+	{
+		const uint32_t r = static_cast<uint32_t>(std::clamp((color[0] * 31.0f / 255.0f) + 0.5f, 0.0f, 31.0f));
+		const uint32_t g = static_cast<uint32_t>(std::clamp((color[1] * 63.0f / 255.0f) + 0.5f, 0.0f, 63.0f));
+		const uint32_t b = static_cast<uint32_t>(std::clamp((color[2] * 31.0f / 255.0f) + 0.5f, 0.0f, 31.0f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void UnpackRGB565(uint16_t packed, float color[3])
+	{
+		const uint32_t r = (packed >> 11) & 31;
+		const uint32_t g = (packed >> 5) & 63;
+		const uint32_t b = packed & 31;
+		color[0] = static_cast<float>((r << 3) | (r >> 2));
+		color[1] = static_cast<float>((g << 2) | (g >> 4));
+		color[2] = static_cast<float>((b << 3) | (b >> 2));
+	}
+
+	struct ColorBlockResult
+	{
+		uint16_t color0 = 0;
+		uint16_t color1 = 0;
+		uint32_t indices = 0;
+		float error = 0.0f;
+	};
+
+	// four color mode, color0 > color1
+	ColorBlockResult QuantizeColorBlock(const float pixels[16][4], const float end0[3], const float end1[3])
+	{
+		ColorBlockResult result;
+		result.color0 = PackRGB565(end0);
+		result.color1 = PackRGB565(end1);
+		if (result.color0 < result.color1)
+		{
+			std::swap(result.color0, result.color1);
+		}
+
+		float palette[4][3];
+		UnpackRGB565(result.color0, palette[0]);
+		UnpackRGB565(result.color1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = ((2.0f * palette[0][c]) + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + (2.0f * palette[1][c])) / 3.0f;
+		}
+
+		const int paletteSize = (result.color0 == result.color1) ? 1 : 4;
+		for (int i = 0; i < 16; ++i)
+		{
+			int bestIndex = 0;
+			float bestError = FLT_MAX;
+			for (int p = 0; p < paletteSize; ++p)
+			{
+				const float error = DistanceSqr<3>(pixels[i], palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			result.indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+			result.error += bestError;
+		}
+		return result;
+	}
+
+	// three color mode with index 3 as transparent black, color0 <= color1
+	ColorBlockResult QuantizeColorBlockWithAlpha(const float pixels[16][4], const float end0[3], const float end1[3])
+	{
+		ColorBlockResult result;
+		result.color0 = PackRGB565(end0);
+		result.color1 = PackRGB565(end1);
+		if (result.color0 > result.color1)
+		{
+			std::swap(result.color0, result.color1);
+		}
+
+		float palette[3][3];
+		UnpackRGB565(result.color0, palette[0]);
+		UnpackRGB565(result.color1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) * 0.5f;
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int bestIndex = 3;
+			if (pixels[i][3] >= 128.0f)
+			{
+				float bestError = FLT_MAX;
+				for (int p = 0; p < 3; ++p)
+				{
+					const float error = DistanceSqr<3>(pixels[i], palette[p]);
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = p;
+					}
+				}
+				result.error += bestError;
+			}
+			result.indices |= static_cast<uint32_t>(bestIndex) << (i * 2);
+		}
+		return result;
+	}
+
+	void EncodeColorBlock(const float pixels[16][4], uint8_t* block, bool allowAlpha)
+	{
+		bool hasAlpha = false;
+		if (allowAlpha)
+		{
+			for (int i = 0; i < 16; ++i)
+			{
+				hasAlpha |= (pixels[i][3] < 128.0f);
+			}
+		}
+
+		float end0[3];
+		float end1[3];
+		ComputePrincipalEndpoints<3>(pixels, end1, end0);
+
+		ColorBlockResult result;
+		if (hasAlpha)
+		{
+			result = QuantizeColorBlockWithAlpha(pixels, end0, end1);
+		}
+		else
+		{
+			result = QuantizeColorBlock(pixels, end0, end1);
+
+			// one refinement pass with the weights picked by the first fit
+			constexpr float kIndexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			float weights[16];
+			for (int i = 0; i < 16; ++i)
+			{
+				weights[i] = kIndexWeights[(result.indices >> (i * 2)) & 3];
+			}
+			float refined0[3];
+			float refined1[3];
+			if (RefineEndpoints<3>(pixels, weights, refined0, refined1))
+			{
+				const ColorBlockResult refined = QuantizeColorBlock(pixels, refined0, refined1);
+				if (refined.error < result.error)
+				{
+					result = refined;
+				}
+			}
+		}
+
+		block[0] = static_cast<uint8_t>(result.color0 & 0xff);
+		block[1] = static_cast<uint8_t>(result.color0 >> 8);
+		block[2] = static_cast<uint8_t>(result.color1 & 0xff);
+		block[3] = static_cast<uint8_t>(result.color1 >> 8);
+		for (int i = 0; i < 4; ++i)
+		{
+			block[4 + i] = static_cast<uint8_t>((result.indices >> (i * 8)) & 0xff);
+		}
+	}
+
+	//--------------------------------------------------------------------------------------------
+	// BC4 single channel block, used for BC3 alpha and both BC5 channels
+
+	void EncodeChannelBlock(const float pixels[16][4], int channel, uint8_t* block)
+	{
+		float minValue = 255.0f;
+		float maxValue = 0.0f;
+		for (int i = 0; i < 16; ++i)
+		{
+			minValue = std::min(minValue, pixels[i][channel]);
+			maxValue = std::max(maxValue, pixels[i][channel]);
+		}
+
+		const uint8_t value0 = static_cast<uint8_t>(maxValue + 0.5f);
+		const uint8_t value1 = static_cast<uint8_t>(minValue + 0.5f);
+		block[0] = value0;
+		block[1] = value1;
+
+		uint64_t indices = 0;
+		if (value0 > value1)
+		{
+			// eight value mode: value0, value1 and six interpolated steps
+			float palette[8];
+			palette[0] = value0;
+			palette[1] = value1;
+			for (int p = 2; p < 8; ++p)
+			{
+				palette[p] = ((static_cast<float>(8 - p) * value0) + (static_cast<float>(p - 1) * value1)) / 7.0f;
+			}
+
+			for (int i = 0; i < 16; ++i)
+			{
+				int bestIndex = 0;
+				float bestError = FLT_MAX;
+				for (int p = 0; p < 8; ++p)
+				{
+					const float error = fabsf(pixels[i][channel] - palette[p]);
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = p;
+					}
+				}
+				indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+			}
+		}
+
+		for (int i = 0; i < 6; ++i)
+		{
+			block[2 + i] = static_cast<uint8_t>((indices >> (i * 8)) & 0xff);
+		}
+	}
+
+	//--------------------------------------------------------------------------------------------
+	// BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints with a unique p-bit each, 4 bit indices
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(uint8_t* data) : mData(data) { std::fill(mData, mData + 16, uint8_t(0)); }
+
+		void Write(uint32_t value, uint32_t bitCount)
+		{
+			for (uint32_t i = 0; i < bitCount; ++i, ++mBit)
+			{
+				if (value & (1u << i))
+				{
+					mData[mBit / 8] |= static_cast<uint8_t>(1u << (mBit % 8));
+				}
+			}
+		}
+
+	private:
+		uint8_t* mData = nullptr;
+		uint32_t mBit = 0;
+	};
+
+	struct BC7Endpoint
+	{
+		uint32_t quantized[4] = {};	// 7 bits per channel
+		uint32_t pBit = 0;
+		float value[4] = {};			// reconstructed 8 bit value
+	};
+
+	BC7Endpoint QuantizeBC7Endpoint(const float endpoint[4])
+	{
+		BC7Endpoint best;
+		float bestError = FLT_MAX;
+		for (uint32_t pBit = 0; pBit < 2; ++pBit)
+		{
+			BC7Endpoint candidate;
+			candidate.pBit = pBit;
+			float error = 0.0f;
+			for (int c = 0; c < 4; ++c)
+			{
+				const float scaled = (endpoint[c] - static_cast<float>(pBit)) * 0.5f;
+				candidate.quantized[c] = static_cast<uint32_t>(std::clamp(scaled + 0.5f, 0.0f, 127.0f));
+				candidate.value[c] = static_cast<float>((candidate.quantized[c] << 1) | pBit);
+				const float d = candidate.value[c] - endpoint[c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				best = candidate;
+			}
+		}
+		return best;
+	}
+
+	struct BC7Result
+	{
+		BC7Endpoint end0;
+		BC7Endpoint end1;
+		uint32_t indices[16] = {};
+		float error = 0.0f;
+	};
+
+	BC7Result QuantizeBC7Block(const float pixels[16][4], const float end0[4], const float end1[4])
+	{
+		BC7Result result;
+		result.end0 = QuantizeBC7Endpoint(end0);
+		result.end1 = QuantizeBC7Endpoint(end1);
+
+		float palette[16][4];
+		for (int p = 0; p < 16; ++p)
+		{
+			const int w = kBC7Weights[p];
+			for (int c = 0; c < 4; ++c)
+			{
+				const int e0 = static_cast<int>(result.end0.value[c]);
+				const int e1 = static_cast<int>(result.end1.value[c]);
+				palette[p][c] = static_cast<float>((((64 - w) * e0) + (w * e1) + 32) >> 6);
+			}
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			float bestError = FLT_MAX;
+			for (uint32_t p = 0; p < 16; ++p)
+			{
+				const float error = DistanceSqr<4>(pixels[i], palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					result.indices[i] = p;
+				}
+			}
+			result.error += bestError;
+		}
+		return result;
+	}
+}
+
+void BlockCompression::EncodeBC1(const uint8_t* rgba, uint8_t* block)
+{
+	float pixels[16][4];
+	LoadBlock(rgba, pixels);
+	EncodeColorBlock(pixels, block, true);
+}
+
+void BlockCompression::EncodeBC3(const uint8_t* rgba, uint8_t* block)
+{
+	float pixels[16][4];
+	LoadBlock(rgba, pixels);
+	EncodeChannelBlock(pixels, 3, block);
+	EncodeColorBlock(pixels, block + 8, false);
+}
+
+void BlockCompression::EncodeBC5(const uint8_t* rgba, uint8_t* block)
+{
+	float pixels[16][4];
+	LoadBlock(rgba, pixels);
+	EncodeChannelBlock(pixels, 0, block);
+	EncodeChannelBlock(pixels, 1, block + 8);
+}
+
+void BlockCompression::EncodeBC7(const uint8_t* rgba, uint8_t* block)
+{
+	float pixels[16][4];
+	LoadBlock(rgba, pixels);
+
+	float end0[4];
+	float end1[4];
+	ComputePrincipalEndpoints<4>(pixels, end0, end1);
+	BC7Result result = QuantizeBC7Block(pixels, end0, end1);
+
+	float weights[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		weights[i] = static_cast<float>(kBC7Weights[result.indices[i]]) / 64.0f;
+	}
+	if (RefineEndpoints<4>(pixels, weights, end0, end1))
+	{
+		const BC7Result refined = QuantizeBC7Block(pixels, end0, end1);
+		if (refined.error < result.error)
+		{
+			result = refined;
+		}
+	}
+
+	// the anchor index only stores 3 bits, so its top bit has to be zero
+	if (result.indices[0] & 8)
+	{
+		std::swap(result.end0, result.end1);
+		for (uint32_t& index : result.indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	BitWriter writer(block);
+	writer.Write(1u << 6, 7);	// mode 6
+	for (int c = 0; c < 4; ++c)
+	{
+		writer.Write(result.end0.quantized[c], 7);
+		writer.Write(result.end1.quantized[c], 7);
+	}
+	writer.Write(result.end0.pBit, 1);
+	writer.Write(result.end1.pBit, 1);
+	writer.Write(result.indices[0], 3);
+	for (int i = 1; i < 16; ++i)
+	{
+		writer.Write(result.indices[i], 4);
+	}
+}
+
+std::vector<uint8_t> BlockCompression::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFile::Compression compression)
+{
+	using EncodeFunc = void(*)(const uint8_t*, uint8_t*);
+	EncodeFunc encode = nullptr;
+	switch (compression)
+	{
+	case TextureFile::Compression::BC1: encode = EncodeBC1; break;
+	case TextureFile::Compression::BC3: encode = EncodeBC3; break;
+	case TextureFile::Compression::BC5: encode = EncodeBC5; break;
+	case TextureFile::Compression::BC7: encode = EncodeBC7; break;
+	default:
+		return std::vector<uint8_t>(rgba, rgba + (static_cast<size_t>(width) * height * 4));
+	}
+
+	const uint32_t blockSize = TextureFile::GetBlockSize(compression);
+	const uint32_t rowPitch = TextureFile::GetRowPitch(compression, width);
+	const uint32_t blockRows = TextureFile::GetRowCount(compression, height);
+	const uint32_t blockColumns = rowPitch / blockSize;
+
+	std::vector<uint8_t> blocks(static_cast<size_t>(rowPitch) * blockRows);
+	Core::ParallelUtil::ParallelFor(blockRows, 4, [&](uint32_t begin, uint32_t end)
+	{
+		uint8_t source[64];
+		for (uint32_t by = begin; by < end; ++by)
+		{
+			for (uint32_t bx = 0; bx < blockColumns; ++bx)
+			{
+				// edge blocks repeat the last row/column of the image
+				for (uint32_t py = 0; py < 4; ++py)
+				{
+					const uint32_t y = std::min((by * 4) + py, height - 1);
+					for (uint32_t px = 0; px < 4; ++px)
+					{
+						const uint32_t x = std::min((bx * 4) + px, width - 1);
+						memcpy(&source[((py * 4) + px) * 4], &rgba[((static_cast<size_t>(y) * width) + x) * 4], 4);
+					}
+				}
+				encode(source, &blocks[(static_cast<size_t>(by) * rowPitch) + (bx * blockSize)]);
+			}
+		}
+	});
+	return blocks;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Graphics/Inc/Graphics.h>
+
+namespace AssetCooker::BlockCompression
+{
+	// Each encoder takes a 4x4 block of RGBA8 pixels (64 bytes, row major)
+	// and writes one compressed block.
+	void EncodeBC1(const uint8_t* rgba, uint8_t* block);	// 8 bytes
+	void EncodeBC3(const uint8_t* rgba, uint8_t* block);	// 16 bytes
+	void EncodeBC5(const uint8_t* rgba, uint8_t* block);	// 16 bytes
+	void EncodeBC7(const uint8_t* rgba, uint8_t* block);	// 16 bytes
+
+	// compresses a whole RGBA8 image, block rows are spread across the worker threads
+	std::vector<uint8_t> Compress(const uint8_t* rgba, uint32_t width, uint32_t height, SumEngine::Graphics::TextureFile::Compression compression);
+}
@@ -0,0 +1,215 @@
+#include "MeshCooker.h"
+#include "ShaderCooker.h"
+#include "TextureCooker.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace AssetCooker;
+
+namespace
+{
+	void PrintUsage()
+	{
+		printf(
+			"usage: AssetCooker <command> <input> [options]\n"
+			"\n"
+			"commands:\n"
+			"  texture <image or directory>   cook images into .sumtex containers\n"
+			"  shader <.fx or directory>      compile every shader permutation into a .sumfx archive\n"
+			"  mesh <.obj or directory>       import meshes into .summesh files\n"
+			"  validate <.summesh or directory>  check cooked meshes and print their layout\n"
+			"\n"
+			"texture options:\n"
+			"  --format <rgba8|bc1|bc3|bc5|bc7>   block compression, picked per image when omitted\n"
+			"  --linear                           no gamma correction when building mips\n"
+			"  --bc5-normals                      pick bc5 for *normal* images, needs shaders that rebuild z\n"
+			"  --force                            cook even if the cooked file is up to date\n"
+			"  --output <file>                    output path when cooking a single image\n"
+			"\n"
+			"shader options:\n"
+			"  --debug                            keep debug info and skip optimization\n"
+			"  --output <file>                    output path when cooking a single shader\n"
+			"\n"
+			"mesh options:\n"
+			"  --no-optimize                      keep the source triangle and vertex order\n"
+			"  --force                            cook even if the cooked file is up to date\n"
+			"  --output <file>                    output path when cooking a single mesh\n");
+	}
+
+	std::optional<TextureFile::Compression> ParseCompression(const std::string& name)
+	{
+		if (name == "rgba8") return TextureFile::Compression::None;
+		if (name == "bc1") return TextureFile::Compression::BC1;
+		if (name == "bc3") return TextureFile::Compression::BC3;
+		if (name == "bc5") return TextureFile::Compression::BC5;
+		if (name == "bc7") return TextureFile::Compression::BC7;
+		return std::nullopt;
+	}
+
+	int CookTextures(const std::vector<std::string>& args)
+	{
+		const std::filesystem::path input = args[0];
+		std::filesystem::path output;
+		TextureCookOptions options;
+		for (size_t i = 1; i < args.size(); ++i)
+		{
+			if (args[i] == "--format" && i + 1 < args.size())
+			{
+				options.compression = ParseCompression(args[++i]);
+				if (!options.compression.has_value())
+				{
+					printf("unknown format %s\n", args[i].c_str());
+					return 1;
+				}
+			}
+			else if (args[i] == "--linear")
+			{
+				options.linear = true;
+			}
+			else if (args[i] == "--bc5-normals")
+			{
+				options.normalMapsBC5 = true;
+			}
+			else if (args[i] == "--force")
+			{
+				options.force = true;
+			}
+			else if (args[i] == "--output" && i + 1 < args.size())
+			{
+				output = args[++i];
+			}
+			else
+			{
+				printf("unknown option %s\n", args[i].c_str());
+				return 1;
+			}
+		}
+
+		if (std::filesystem::is_directory(input))
+		{
+			printf("cooking textures in %s\n", input.string().c_str());
+			return CookTextureDirectory(input, options) == 0 ? 0 : 1;
+		}
+
+		if (output.empty())
+		{
+			output = TextureFile::GetCookedPath(input);
+		}
+		return CookTexture(input, output, options) ? 0 : 1;
+	}
+
+	int CookShaders(const std::vector<std::string>& args)
+	{
+		const std::filesystem::path input = args[0];
+		std::filesystem::path output;
+		ShaderCookOptions options;
+		for (size_t i = 1; i < args.size(); ++i)
+		{
+			if (args[i] == "--debug")
+			{
+				options.debug = true;
+			}
+			else if (args[i] == "--output" && i + 1 < args.size())
+			{
+				output = args[++i];
+			}
+			else
+			{
+				printf("unknown option %s\n", args[i].c_str());
+				return 1;
+			}
+		}
+
+		if (std::filesystem::is_directory(input))
+		{
+			printf("cooking shaders in %s\n", input.string().c_str());
+			return CookShaderDirectory(input, options) == 0 ? 0 : 1;
+		}
+
+		if (output.empty())
+		{
+			output = ShaderArchiveFile::GetArchivePath(input);
+		}
+		return CookShader(input, output, options) ? 0 : 1;
+	}
+
+	int CookMeshes(const std::vector<std::string>& args)
+	{
+		const std::filesystem::path input = args[0];
+		std::filesystem::path output;
+		MeshCookOptions options;
+		for (size_t i = 1; i < args.size(); ++i)
+		{
+			if (args[i] == "--no-optimize")
+			{
+				options.noOptimize = true;
+			}
+			else if (args[i] == "--force")
+			{
+				options.force = true;
+			}
+			else if (args[i] == "--output" && i + 1 < args.size())
+			{
+				output = args[++i];
+			}
+			else
+			{
+				printf("unknown option %s\n", args[i].c_str());
+				return 1;
+			}
+		}
+
+		if (std::filesystem::is_directory(input))
+		{
+			printf("cooking meshes in %s\n", input.string().c_str());
+			return CookMeshDirectory(input, options) == 0 ? 0 : 1;
+		}
+
+		if (output.empty())
+		{
+			output = MeshFile::GetCookedPath(input);
+		}
+		return CookMesh(input, output, options) ? 0 : 1;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const std::string command = argv[1];
+	const std::vector<std::string> args(argv + 2, argv + argc);
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	int result = 1;
+	if (command == "texture")
+	{
+		result = CookTextures(args);
+	}
+	else if (command == "shader")
+	{
+		result = CookShaders(args);
+	}
+	else if (command == "mesh")
+	{
+		result = CookMeshes(args);
+	}
+	else if (command == "validate")
+	{
+		printf("validating %s\n", args[0].c_str());
+		result = ValidateMeshes(args[0]) == 0 ? 0 : 1;
+	}
+	else
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime);
+	printf("done in %.2fs\n", duration.count() / 1000.0f);
+	return result;
+}
@@ -0,0 +1,306 @@
+#include "MeshCooker.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Math;
+using namespace AssetCooker;
+
+namespace
+{
+	// position / uv / normal indices of one face corner, -1 when the corner has none
+	struct ObjCorner
+	{
+		int32_t position = -1;
+		int32_t uv = -1;
+		int32_t normal = -1;
+
+		bool operator==(const ObjCorner& rhs) const
+		{
+			return position == rhs.position && uv == rhs.uv && normal == rhs.normal;
+		}
+	};
+
+	struct ObjCornerHash
+	{
+		size_t operator()(const ObjCorner& corner) const
+		{
+			return (static_cast<size_t>(corner.position) * 73856093u) ^ (static_cast<size_t>(corner.uv) * 19349663u) ^ (static_cast<size_t>(corner.normal) * 83492791u);
+		}
+	};
+
+	bool IsMeshFile(const std::filesystem::path& path)
+	{
+		std::wstring extension = path.extension().wstring();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+		return extension == L".obj";
+	}
+
+	const char* SkipSpaces(const char* text)
+	{
+		while (*text != '\0' && isspace(static_cast<unsigned char>(*text)))
+		{
+			++text;
+		}
+		return text;
+	}
+
+	bool IsKeyword(const char* text, const char* keyword)
+	{
+		const size_t length = strlen(keyword);
+		return strncmp(text, keyword, length) == 0 && isspace(static_cast<unsigned char>(text[length]));
+	}
+
+	// reads up to count floats, missing values are left as they are
+	const char* ReadFloats(const char* text, float* values, int count)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			char* end = nullptr;
+			const float value = strtof(text, &end);
+			if (end == text)
+			{
+				break;
+			}
+			values[i] = value;
+			text = end;
+		}
+		return text;
+	}
+
+	// obj indices are 1 based, negative ones count back from the last element read so far
+	int32_t ResolveObjIndex(int32_t index, size_t count)
+	{
+		return (index < 0) ? static_cast<int32_t>(count) + index : index - 1;
+	}
+
+	// "p", "p/t", "p//n" or "p/t/n"
+	bool ParseObjCorner(const char* text, size_t positionCount, size_t uvCount, size_t normalCount, ObjCorner& corner)
+	{
+		int32_t values[3] = { 0, 0, 0 };
+		for (int i = 0; i < 3 && *text != '\0'; ++i)
+		{
+			if (*text != '/')
+			{
+				values[i] = static_cast<int32_t>(strtol(text, nullptr, 10));
+			}
+			while (*text != '\0' && *text != '/')
+			{
+				++text;
+			}
+			if (*text == '/')
+			{
+				++text;
+			}
+		}
+
+		corner.position = ResolveObjIndex(values[0], positionCount);
+		corner.uv = (values[1] != 0) ? ResolveObjIndex(values[1], uvCount) : -1;
+		corner.normal = (values[2] != 0) ? ResolveObjIndex(values[2], normalCount) : -1;
+		return values[0] != 0 &&
+			corner.position >= 0 && corner.position < static_cast<int32_t>(positionCount) &&
+			corner.uv < static_cast<int32_t>(uvCount) &&
+			corner.normal < static_cast<int32_t>(normalCount);
+	}
+
+	// obj is right handed with counter clockwise front faces. Flipping z mirrors the mesh, which
+	// reverses the winding on screen as well, so the triangles are emitted in reverse order to
+	// come out clockwise, front facing in the engine's left handed setup
+	bool LoadObj(const std::filesystem::path& sourcePath, Mesh& mesh, bool& hasNormals)
+	{
+		std::ifstream file(sourcePath);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		std::vector<Vector3> positions;
+		std::vector<Vector2> uvs;
+		std::vector<Vector3> normals;
+		std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> cornerToVertex;
+		std::vector<uint32_t> polygon;
+		hasNormals = true;
+
+		std::string line;
+		uint32_t lineNumber = 0;
+		while (std::getline(file, line))
+		{
+			++lineNumber;
+			const char* text = SkipSpaces(line.c_str());
+			if (IsKeyword(text, "v"))
+			{
+				Vector3& position = positions.emplace_back();
+				ReadFloats(text + 1, &position.x, 3);
+				position.z = -position.z;
+			}
+			else if (IsKeyword(text, "vt"))
+			{
+				Vector2& uv = uvs.emplace_back();
+				ReadFloats(text + 2, &uv.x, 2);
+				uv.y = 1.0f - uv.y;
+			}
+			else if (IsKeyword(text, "vn"))
+			{
+				Vector3& normal = normals.emplace_back();
+				ReadFloats(text + 2, &normal.x, 3);
+				normal.z = -normal.z;
+			}
+			else if (IsKeyword(text, "f"))
+			{
+				polygon.clear();
+				text = SkipSpaces(text + 1);
+				while (*text != '\0')
+				{
+					const char* end = text;
+					while (*end != '\0' && !isspace(static_cast<unsigned char>(*end)))
+					{
+						++end;
+					}
+					const std::string cornerText(text, end);
+					text = SkipSpaces(end);
+
+					ObjCorner corner;
+					if (!ParseObjCorner(cornerText.c_str(), positions.size(), uvs.size(), normals.size(), corner))
+					{
+						printf("  %s(%u): invalid face corner %s\n", sourcePath.filename().string().c_str(), lineNumber, cornerText.c_str());
+						return false;
+					}
+					hasNormals = hasNormals && corner.normal >= 0;
+
+					auto [iter, inserted] = cornerToVertex.emplace(corner, static_cast<uint32_t>(mesh.vertices.size()));
+					if (inserted)
+					{
+						Vertex& vertex = mesh.vertices.emplace_back();
+						vertex.position = positions[corner.position];
+						vertex.normal = (corner.normal >= 0) ? normals[corner.normal] : Vector3::YAxis;
+						vertex.tangent = Vector3::XAxis;
+						vertex.uvCoord = (corner.uv >= 0) ? uvs[corner.uv] : Vector2::Zero;
+					}
+					polygon.push_back(iter->second);
+				}
+
+				// polygons are triangulated as a fan, which is what exporters expect for convex faces
+				for (size_t i = 2; i < polygon.size(); ++i)
+				{
+					mesh.indices.insert(mesh.indices.end(), { polygon[0], polygon[i], polygon[i - 1] });
+				}
+			}
+		}
+		return !mesh.indices.empty();
+	}
+}
+
+bool AssetCooker::CookMesh(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const MeshCookOptions& options)
+{
+	Mesh mesh;
+	bool hasNormals = false;
+	if (!LoadObj(sourcePath, mesh, hasNormals))
+	{
+		printf("  failed to load %s\n", sourcePath.string().c_str());
+		return false;
+	}
+
+	if (hasNormals)
+	{
+		TangentSpace::ComputeTangents(mesh);
+	}
+	else
+	{
+		TangentSpace::Compute(mesh);
+	}
+
+	MeshOptimizeReport report;
+	if (!options.noOptimize)
+	{
+		report = MeshOptimizer::Optimize(mesh);
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(cookedPath.parent_path(), ec);
+	if (!MeshFile::Write(cookedPath, mesh))
+	{
+		printf("  failed to write %s\n", cookedPath.string().c_str());
+		return false;
+	}
+
+	printf("  %s -> %s %zu vertices, %zu triangles, %s indices, acmr %.3f -> %.3f\n",
+		sourcePath.filename().string().c_str(),
+		cookedPath.filename().string().c_str(),
+		mesh.vertices.size(), mesh.indices.size() / 3,
+		(GetIndexFormat(mesh.vertices.size()) == IndexFormat::UInt16) ? "16 bit" : "32 bit",
+		report.before.acmr, report.after.acmr);
+	return true;
+}
+
+uint32_t AssetCooker::CookMeshDirectory(const std::filesystem::path& directory, const MeshCookOptions& options)
+{
+	uint32_t failures = 0;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+	{
+		if (!entry.is_regular_file() || !IsMeshFile(entry.path()))
+		{
+			continue;
+		}
+
+		const std::filesystem::path cookedPath = MeshFile::GetCookedPath(entry.path());
+		std::error_code ec;
+		if (!options.force && std::filesystem::exists(cookedPath, ec) &&
+			std::filesystem::last_write_time(cookedPath, ec) >= entry.last_write_time())
+		{
+			continue;
+		}
+
+		if (!CookMesh(entry.path(), cookedPath, options))
+		{
+			++failures;
+		}
+	}
+	return failures;
+}
+
+uint32_t AssetCooker::ValidateMeshes(const std::filesystem::path& path)
+{
+	std::vector<std::filesystem::path> files;
+	if (std::filesystem::is_directory(path))
+	{
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == MeshFile::Extension)
+			{
+				files.push_back(entry.path());
+			}
+		}
+	}
+	else
+	{
+		files.push_back(path);
+	}
+
+	uint32_t failures = 0;
+	for (const std::filesystem::path& filePath : files)
+	{
+		Core::MappedFile file;
+		if (!file.Open(filePath))
+		{
+			printf("  %s: failed to open\n", filePath.string().c_str());
+			++failures;
+			continue;
+		}
+
+		const uint8_t* data = file.GetData().data();
+		if (const char* error = MeshFile::Validate(data, file.GetSize()))
+		{
+			printf("  %s: %s\n", filePath.string().c_str(), error);
+			++failures;
+			continue;
+		}
+
+		const MeshFile::Header* header = reinterpret_cast<const MeshFile::Header*>(data);
+		printf("  %s: ok, format 0x%04x, %u vertices of %u bytes, %u %s indices, bounds (%.2f, %.2f, %.2f) - (%.2f, %.2f, %.2f)\n",
+			filePath.filename().string().c_str(),
+			header->vertexFormat, header->vertexCount, header->vertexSize,
+			header->indexCount, (header->indexFormat == IndexFormat::UInt16) ? "16 bit" : "32 bit",
+			header->boundsMin.x, header->boundsMin.y, header->boundsMin.z,
+			header->boundsMax.x, header->boundsMax.y, header->boundsMax.z);
+	}
+	return failures;
+}
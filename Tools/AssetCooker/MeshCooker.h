@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Graphics/Inc/Graphics.h>
+
+namespace AssetCooker
+{
+	struct MeshCookOptions
+	{
+		// keep the source triangle order instead of running the MeshOptimizer passes
+		bool noOptimize = false;
+		// cook even when the cooked file is newer than the source
+		bool force = false;
+	};
+
+	// imports a Wavefront .obj into the full Vertex layout, missing normals and all tangents are generated
+	bool CookMesh(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const MeshCookOptions& options);
+
+	// cooks every .obj under the directory next to its source, returns the number of failures
+	uint32_t CookMeshDirectory(const std::filesystem::path& directory, const MeshCookOptions& options);
+
+	// full MeshFile::Validate of a .summesh file or every one under a directory, returns the number of failures
+	uint32_t ValidateMeshes(const std::filesystem::path& path);
+}
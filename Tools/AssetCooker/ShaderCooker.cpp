@@ -0,0 +1,166 @@
+#include "ShaderCooker.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace AssetCooker;
+
+namespace
+{
+	struct StageInfo
+	{
+		ShaderArchiveFile::Stage stage;
+		const char* entryPoint;
+		const char* profile;
+	};
+
+	constexpr StageInfo Stages[] =
+	{
+		{ ShaderArchiveFile::Stage::Vertex, "VS", "vs_5_0" },
+		{ ShaderArchiveFile::Stage::Pixel, "PS", "ps_5_0" }
+	};
+
+	struct CompileJob
+	{
+		ShaderArchiveFile::Entry entry;
+		std::vector<uint8_t> bytecode;
+		bool compiled = false;
+	};
+
+	uint64_t Align(uint64_t offset)
+	{
+		return (offset + ShaderArchiveFile::DataAlignment - 1) & ~static_cast<uint64_t>(ShaderArchiveFile::DataAlignment - 1);
+	}
+}
+
+bool AssetCooker::CookShader(const std::filesystem::path& sourcePath, const std::filesystem::path& archivePath, const ShaderCookOptions& options)
+{
+	Core::MappedFile sourceFile;
+	if (!sourceFile.Open(sourcePath))
+	{
+		printf("  failed to open %s\n", sourcePath.string().c_str());
+		return false;
+	}
+
+	const std::vector<std::string> keywords = ShaderPermutation::ParseKeywords(sourceFile.GetData());
+	const uint32_t permutationCount = ShaderPermutation::GetPermutationCount(keywords);
+	for (const std::string& keyword : keywords)
+	{
+		if (keyword.size() >= ShaderArchiveFile::MaxKeywordLength)
+		{
+			printf("  keyword %s is too long\n", keyword.c_str());
+			return false;
+		}
+	}
+
+	// stage major, permutation minor, which is already the sorted order the archive needs
+	std::vector<CompileJob> jobs(std::size(Stages) * permutationCount);
+	for (size_t s = 0; s < std::size(Stages); ++s)
+	{
+		for (uint32_t p = 0; p < permutationCount; ++p)
+		{
+			CompileJob& job = jobs[(s * permutationCount) + p];
+			job.entry.stage = Stages[s].stage;
+			job.entry.permutation = p;
+		}
+	}
+
+	const uint32_t flags = options.debug ?
+		D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION :
+		D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+
+	Core::ParallelUtil::ParallelFor(static_cast<uint32_t>(jobs.size()), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			CompileJob& job = jobs[i];
+			const StageInfo& stageInfo = Stages[static_cast<uint32_t>(job.entry.stage)];
+
+			ShaderCompileDesc desc;
+			desc.filePath = sourcePath;
+			desc.entryPoint = stageInfo.entryPoint;
+			desc.profile = stageInfo.profile;
+			desc.permutation = job.entry.permutation;
+			desc.flags = flags;
+			job.compiled = ShaderCache::Compile(desc, job.bytecode);
+		}
+	});
+
+	bool success = true;
+	for (const CompileJob& job : jobs)
+	{
+		if (!job.compiled)
+		{
+			printf("  failed to compile %s permutation 0x%x\n", Stages[static_cast<uint32_t>(job.entry.stage)].entryPoint, job.entry.permutation);
+			success = false;
+		}
+	}
+	if (!success)
+	{
+		return false;
+	}
+
+	ShaderArchiveFile::Header header;
+	header.keywordCount = static_cast<uint32_t>(keywords.size());
+	header.entryCount = static_cast<uint32_t>(jobs.size());
+
+	std::vector<ShaderArchiveFile::Keyword> keywordTable(keywords.size());
+	for (size_t i = 0; i < keywords.size(); ++i)
+	{
+		memcpy(keywordTable[i].name, keywords[i].c_str(), keywords[i].size());
+	}
+
+	uint64_t offset = sizeof(header) + (sizeof(ShaderArchiveFile::Keyword) * keywordTable.size()) + (sizeof(ShaderArchiveFile::Entry) * jobs.size());
+	for (CompileJob& job : jobs)
+	{
+		offset = Align(offset);
+		job.entry.offset = offset;
+		job.entry.size = job.bytecode.size();
+		offset += job.entry.size;
+	}
+
+	std::ofstream file(archivePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		printf("  failed to write %s\n", archivePath.string().c_str());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(keywordTable.data()), sizeof(ShaderArchiveFile::Keyword) * keywordTable.size());
+	for (const CompileJob& job : jobs)
+	{
+		file.write(reinterpret_cast<const char*>(&job.entry), sizeof(job.entry));
+	}
+	for (const CompileJob& job : jobs)
+	{
+		const std::streamoff padding = static_cast<std::streamoff>(job.entry.offset) - file.tellp();
+		for (std::streamoff p = 0; p < padding; ++p)
+		{
+			file.put(0);
+		}
+		file.write(reinterpret_cast<const char*>(job.bytecode.data()), job.bytecode.size());
+	}
+
+	printf("  %s -> %s %u keywords, %zu permutations, %.1f KB\n",
+		sourcePath.filename().string().c_str(),
+		archivePath.filename().string().c_str(),
+		header.keywordCount, jobs.size(),
+		static_cast<double>(offset) / 1024.0);
+	return true;
+}
+
+uint32_t AssetCooker::CookShaderDirectory(const std::filesystem::path& directory, const ShaderCookOptions& options)
+{
+	uint32_t failures = 0;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == L".fx")
+		{
+			if (!CookShader(entry.path(), ShaderArchiveFile::GetArchivePath(entry.path()), options))
+			{
+				++failures;
+			}
+		}
+	}
+	return failures;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Graphics/Inc/Graphics.h>
+
+namespace AssetCooker
+{
+	struct ShaderCookOptions
+	{
+		// keep debug info and skip optimization, for stepping through shaders in a graphics debugger
+		bool debug = false;
+	};
+
+	// compiles every keyword permutation of the VS and PS entry points into one archive
+	bool CookShader(const std::filesystem::path& sourcePath, const std::filesystem::path& archivePath, const ShaderCookOptions& options);
+
+	// cooks every .fx file under the directory next to its source, returns the number of failures
+	uint32_t CookShaderDirectory(const std::filesystem::path& directory, const ShaderCookOptions& options);
+}
\ No newline at end of file
@@ -0,0 +1,295 @@
+#include "TextureCooker.h"
+
+#include "BlockCompression.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Graphics;
+using namespace AssetCooker;
+
+namespace
+{
+	struct FloatImage
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<float> pixels;	// RGBA, linear space for color textures
+
+		const float* GetPixel(uint32_t x, uint32_t y) const { return &pixels[((static_cast<size_t>(y) * width) + x) * 4]; }
+		float* GetPixel(uint32_t x, uint32_t y) { return &pixels[((static_cast<size_t>(y) * width) + x) * 4]; }
+	};
+
+	float SRGBToLinear(float value)
+	{
+		return (value <= 0.04045f) ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSRGB(float value)
+	{
+		return (value <= 0.0031308f) ? value * 12.92f : (1.055f * powf(value, 1.0f / 2.4f)) - 0.055f;
+	}
+
+	bool IsImageFile(const std::filesystem::path& path)
+	{
+		std::wstring extension = path.extension().wstring();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+		return extension == L".jpg" || extension == L".jpeg" || extension == L".png" ||
+			extension == L".bmp" || extension == L".tif" || extension == L".tiff";
+	}
+
+	bool IsDataTexture(const std::filesystem::path& path)
+	{
+		const std::string name = path.stem().string();
+		return name.find("normal") != std::string::npos ||
+			name.find("height") != std::string::npos ||
+			name.find("spec") != std::string::npos ||
+			name.find("bump") != std::string::npos;
+	}
+
+	TextureFile::Compression PickCompression(const std::filesystem::path& sourcePath, const Image& image, const TextureCookOptions& options)
+	{
+		if (options.normalMapsBC5 && sourcePath.stem().string().find("normal") != std::string::npos)
+		{
+			return TextureFile::Compression::BC5;
+		}
+
+		const uint8_t* pixels = image.GetPixels();
+		const size_t pixelCount = static_cast<size_t>(image.GetWidth()) * image.GetHeight();
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			if (pixels[(i * 4) + 3] != 255)
+			{
+				return TextureFile::Compression::BC3;
+			}
+		}
+		return TextureFile::Compression::BC1;
+	}
+
+	FloatImage ToFloatImage(const Image& image, bool linear)
+	{
+		float toLinear[256];
+		for (int i = 0; i < 256; ++i)
+		{
+			const float value = static_cast<float>(i) / 255.0f;
+			toLinear[i] = linear ? value : SRGBToLinear(value);
+		}
+
+		FloatImage result;
+		result.width = image.GetWidth();
+		result.height = image.GetHeight();
+		result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+
+		const uint8_t* source = image.GetPixels();
+		for (size_t i = 0; i < result.pixels.size(); i += 4)
+		{
+			result.pixels[i + 0] = toLinear[source[i + 0]];
+			result.pixels[i + 1] = toLinear[source[i + 1]];
+			result.pixels[i + 2] = toLinear[source[i + 2]];
+			result.pixels[i + 3] = static_cast<float>(source[i + 3]) / 255.0f;
+		}
+		return result;
+	}
+
+	std::vector<uint8_t> ToRGBA8(const FloatImage& image, bool linear)
+	{
+		std::vector<uint8_t> result(image.pixels.size());
+		Core::ParallelUtil::ParallelFor(image.height, 16, [&](uint32_t begin, uint32_t end)
+		{
+			for (size_t i = static_cast<size_t>(begin) * image.width * 4; i < static_cast<size_t>(end) * image.width * 4; ++i)
+			{
+				float value = std::clamp(image.pixels[i], 0.0f, 1.0f);
+				if (!linear && (i % 4) != 3)
+				{
+					value = LinearToSRGB(value);
+				}
+				result[i] = static_cast<uint8_t>((value * 255.0f) + 0.5f);
+			}
+		});
+		return result;
+	}
+
+	// bilinear resample, only used to pad block compressed textures to a multiple of 4
+	FloatImage Resample(const FloatImage& image, uint32_t width, uint32_t height)
+	{
+		FloatImage result;
+		result.width = width;
+		result.height = height;
+		result.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+		Core::ParallelUtil::ParallelFor(height, 16, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t y = begin; y < end; ++y)
+			{
+				const float v = std::max(((y + 0.5f) * image.height / height) - 0.5f, 0.0f);
+				const uint32_t y0 = std::min(static_cast<uint32_t>(v), image.height - 1);
+				const uint32_t y1 = std::min(y0 + 1, image.height - 1);
+				const float ty = v - static_cast<float>(y0);
+				for (uint32_t x = 0; x < width; ++x)
+				{
+					const float u = std::max(((x + 0.5f) * image.width / width) - 0.5f, 0.0f);
+					const uint32_t x0 = std::min(static_cast<uint32_t>(u), image.width - 1);
+					const uint32_t x1 = std::min(x0 + 1, image.width - 1);
+					const float tx = u - static_cast<float>(x0);
+
+					float* target = result.GetPixel(x, y);
+					for (int c = 0; c < 4; ++c)
+					{
+						const float top = Math::Lerp(image.GetPixel(x0, y0)[c], image.GetPixel(x1, y0)[c], tx);
+						const float bottom = Math::Lerp(image.GetPixel(x0, y1)[c], image.GetPixel(x1, y1)[c], tx);
+						target[c] = Math::Lerp(top, bottom, ty);
+					}
+				}
+			}
+		});
+		return result;
+	}
+
+	// 2x2 box filter, odd edges reuse the last row/column
+	FloatImage Downsample(const FloatImage& image)
+	{
+		FloatImage result;
+		result.width = std::max(image.width / 2, 1u);
+		result.height = std::max(image.height / 2, 1u);
+		result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+
+		Core::ParallelUtil::ParallelFor(result.height, 16, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t y = begin; y < end; ++y)
+			{
+				const uint32_t y0 = std::min(y * 2, image.height - 1);
+				const uint32_t y1 = std::min((y * 2) + 1, image.height - 1);
+				for (uint32_t x = 0; x < result.width; ++x)
+				{
+					const uint32_t x0 = std::min(x * 2, image.width - 1);
+					const uint32_t x1 = std::min((x * 2) + 1, image.width - 1);
+
+					float* target = result.GetPixel(x, y);
+					for (int c = 0; c < 4; ++c)
+					{
+						target[c] = (image.GetPixel(x0, y0)[c] + image.GetPixel(x1, y0)[c] +
+							image.GetPixel(x0, y1)[c] + image.GetPixel(x1, y1)[c]) * 0.25f;
+					}
+				}
+			}
+		});
+		return result;
+	}
+
+	const char* GetCompressionName(TextureFile::Compression compression)
+	{
+		switch (compression)
+		{
+		case TextureFile::Compression::BC1: return "BC1";
+		case TextureFile::Compression::BC3: return "BC3";
+		case TextureFile::Compression::BC5: return "BC5";
+		case TextureFile::Compression::BC7: return "BC7";
+		default: break;
+		}
+		return "RGBA8";
+	}
+}
+
+bool AssetCooker::CookTexture(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const TextureCookOptions& options)
+{
+	Image image;
+	if (!image.Load(sourcePath))
+	{
+		printf("  failed to load %s\n", sourcePath.string().c_str());
+		return false;
+	}
+
+	const TextureFile::Compression compression = options.compression.value_or(PickCompression(sourcePath, image, options));
+	const bool linear = options.linear || IsDataTexture(sourcePath);
+
+	FloatImage level = ToFloatImage(image, linear);
+	if (TextureFile::IsBlockCompressed(compression) && ((level.width % 4) != 0 || (level.height % 4) != 0))
+	{
+		// D3D11 requires the top level of a block compressed texture to be a multiple of 4
+		level = Resample(level, (level.width + 3) & ~3u, (level.height + 3) & ~3u);
+	}
+
+	TextureFile::Header header;
+	header.compression = compression;
+	header.width = level.width;
+	header.height = level.height;
+	header.mipCount = TextureFile::GetMipCount(level.width, level.height);
+
+	std::vector<TextureFile::MipDesc> mips(header.mipCount);
+	std::vector<std::vector<uint8_t>> mipData(header.mipCount);
+
+	uint64_t offset = sizeof(TextureFile::Header) + (sizeof(TextureFile::MipDesc) * header.mipCount);
+	for (uint32_t i = 0; i < header.mipCount; ++i)
+	{
+		if (i > 0)
+		{
+			level = Downsample(level);
+		}
+
+		const std::vector<uint8_t> pixels = ToRGBA8(level, linear);
+		mipData[i] = BlockCompression::Compress(pixels.data(), level.width, level.height, compression);
+
+		offset = (offset + TextureFile::DataAlignment - 1) & ~static_cast<uint64_t>(TextureFile::DataAlignment - 1);
+		mips[i].offset = offset;
+		mips[i].size = static_cast<uint32_t>(mipData[i].size());
+		mips[i].rowPitch = TextureFile::GetRowPitch(compression, level.width);
+		mips[i].width = level.width;
+		mips[i].height = level.height;
+		offset += mips[i].size;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(cookedPath.parent_path(), ec);
+	std::ofstream file(cookedPath, std::ios::binary);
+	if (!file.is_open())
+	{
+		printf("  failed to write %s\n", cookedPath.string().c_str());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(mips.data()), sizeof(TextureFile::MipDesc) * mips.size());
+	for (uint32_t i = 0; i < header.mipCount; ++i)
+	{
+		const std::streamoff padding = static_cast<std::streamoff>(mips[i].offset) - file.tellp();
+		for (std::streamoff p = 0; p < padding; ++p)
+		{
+			file.put(0);
+		}
+		file.write(reinterpret_cast<const char*>(mipData[i].data()), mipData[i].size());
+	}
+
+	const size_t sourceSize = static_cast<size_t>(image.GetWidth()) * image.GetHeight() * 4;
+	printf("  %s -> %s %ux%u, %u mips, %s, %.2f MB (RGBA8 top level %.2f MB)\n",
+		sourcePath.filename().string().c_str(),
+		cookedPath.filename().string().c_str(),
+		header.width, header.height, header.mipCount,
+		GetCompressionName(compression),
+		static_cast<double>(offset) / (1024.0 * 1024.0),
+		static_cast<double>(sourceSize) / (1024.0 * 1024.0));
+	return true;
+}
+
+uint32_t AssetCooker::CookTextureDirectory(const std::filesystem::path& directory, const TextureCookOptions& options)
+{
+	uint32_t failures = 0;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+	{
+		if (!entry.is_regular_file() || !IsImageFile(entry.path()))
+		{
+			continue;
+		}
+
+		const std::filesystem::path cookedPath = TextureFile::GetCookedPath(entry.path());
+		std::error_code ec;
+		if (!options.force && std::filesystem::exists(cookedPath, ec) &&
+			std::filesystem::last_write_time(cookedPath, ec) >= entry.last_write_time())
+		{
+			continue;
+		}
+
+		if (!CookTexture(entry.path(), cookedPath, options))
+		{
+			++failures;
+		}
+	}
+	return failures;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Graphics/Inc/Graphics.h>
+
+namespace AssetCooker
+{
+	struct TextureCookOptions
+	{
+		// picked from the image content when not set
+		std::optional<SumEngine::Graphics::TextureFile::Compression> compression;
+		// images named *normal* are cooked to BC5 when picked automatically. BC5 only keeps x and y, so
+		// this is for shaders that rebuild z, none of the shipped ones do.
+		bool normalMapsBC5 = false;
+		// data textures (normal, height, spec maps) are filtered without gamma correction
+		bool linear = false;
+		// cook even when the cooked file is newer than the source
+		bool force = false;
+	};
+
+	bool CookTexture(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath, const TextureCookOptions& options);
+
+	// cooks every image under the directory next to its source, returns the number of failures
+	uint32_t CookTextureDirectory(const std::filesystem::path& directory, const TextureCookOptions& options);
+}
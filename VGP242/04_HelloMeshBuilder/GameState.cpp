@@ -13,6 +13,10 @@ void GameState::Initialize()
 	//MeshPX mesh = MeshBuilder::CreatePlanePX(5, 5, 1.0f);
 	//MeshPX mesh = MeshBuilder::CreateSpherePX(60, 60, 1.0f);
 	MeshPX mesh = MeshBuilder::CreateSkySpherePX(50, 50, 100.0f);
+	const MeshWeldReport weldReport = MeshOptimizer::WeldVertices(mesh);
+	LOG("MeshOptimizer: welded %u vertices into %u", weldReport.vertexCountBefore, weldReport.vertexCountAfter);
+	const MeshOptimizeReport report = MeshOptimizer::Optimize(mesh);
+	LOG("MeshOptimizer: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
 	mCamera.SetPosition({ 0.0f, 1.0f, -5.0f });
 	mCamera.SetLookAt({ 0.0f, 0.0f, 0.0f });
 
@@ -186,9 +186,11 @@ float ry = 5.0f;
 float rz = 5.0f;
 
 Color lineColor = Colors::Green;
+bool drawOnTop = false;
 
 void GameState::Render()
 {
+	SimpleDraw::SetLayer(drawOnTop ? SimpleDraw::Layer::Overlay : SimpleDraw::Layer::Scene);
 	if (mDebugDrawType == DebugDrawType::Sphere)
 	{
 		SimpleDraw::AddSphere(30, 30, 2.0f, minExtents, lineColor);
@@ -328,6 +330,13 @@ void GameState::DebugUI()
 	}
 
 	ImGui::ColorEdit4("Color", &lineColor.r);
+	ImGui::Checkbox("DrawOnTop", &drawOnTop);
+
+	const SimpleDraw::Stats& drawStats = SimpleDraw::GetStats();
+	ImGui::Text("Lines: %u (peak %u, dropped %u)", drawStats.lineCount, drawStats.peakLineCount, drawStats.droppedLineCount);
+	ImGui::Text("Faces: %u (peak %u, dropped %u, translucent %u)", drawStats.faceCount, drawStats.peakFaceCount, drawStats.droppedFaceCount, drawStats.translucentFaceCount);
+	ImGui::Text("Instances: %u (peak %u, dropped %u)", drawStats.instanceCount, drawStats.peakInstanceCount, drawStats.droppedInstanceCount);
+	ImGui::Text("Batches: %u", drawStats.batchCount);
 	ImGui::End();
 }
 
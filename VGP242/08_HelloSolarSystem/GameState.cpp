@@ -36,6 +36,29 @@ const char* cTextureLocations[] =
 	"skysphere/space.jpg"
 };
 bool buttonValue = false;
+float totalTime = 0.0f;
+
+Matrix4 GetWorldMatrix(const TexturedObject& object)
+{
+	return Matrix4::RotationY(object.rotationSpeed * totalTime) * Matrix4::Translation(Vector3::ZAxis * object.distanceFromSun) * Matrix4::RotationY(object.orbitSpeed * totalTime / 10.0f);
+}
+
+void InitializeLods(MeshPool& meshPool, TexturedObject& object, const std::vector<MeshLod<ShortIndexMesh<VertexPX>>>& lods, float radius)
+{
+	object.radius = radius;
+	object.mLodMeshes.clear();
+	object.mLodErrors.clear();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(lods.size()); ++i)
+	{
+		ShortIndexMesh<VertexPX> mesh = lods[i].mesh;
+		for (VertexPX& vertex : mesh.vertices)
+		{
+			vertex.position *= radius;
+		}
+		object.mLodMeshes.push_back(meshPool.Add(mesh));
+		object.mLodErrors.push_back(lods[i].error * radius);
+	}
+}
 
 void GameState::Initialize()
 {
@@ -46,20 +69,51 @@ void GameState::Initialize()
 	mRenderTargetCamera.SetLookAt({ 0.0f, 0.0f, 0.0f });
 	mRenderTargetCamera.SetAspectRatio(1.0f);
 
-	// Create Meshes
-	mObjects[(int)SolarSystem::Sun].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 100.0f));
-	mObjects[(int)SolarSystem::Mercury].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 0.38f));
-	mObjects[(int)SolarSystem::Venus].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 0.95f));
-	mObjects[(int)SolarSystem::Earth].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 1.0f));
-	mObjects[(int)SolarSystem::Mars].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 0.53f));
-	mObjects[(int)SolarSystem::Jupiter].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 10.97f));
-	mObjects[(int)SolarSystem::Saturn].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 9.14f));
-	mObjects[(int)SolarSystem::Uranus].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 3.98f));
-	mObjects[(int)SolarSystem::Neptune].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 3.86f));
-	mObjects[(int)SolarSystem::Pluto].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSpherePX(100, 100, 0.18f));
-	mObjects[(int)SolarSystem::Galaxy].mMeshBuffer.Initialize<MeshPX>(MeshBuilder::CreateSkySpherePX(100, 100, 1000.0f));
-
-	mConstantBuffer.Initialize(sizeof(Matrix4));
+	// Create Meshes, every planet scales the same unit sphere lod chain
+	// the pool is 16 bit, so the chain is narrowed here once instead of on every Add
+	std::vector<MeshLod<ShortIndexMesh<VertexPX>>> sphereLods;
+	for (const MeshLod<MeshPX>& lod : MeshSimplifier::BuildLodChain(MeshBuilder::CreateSpherePX(100, 100, 1.0f), TexturedObject::MinLodTriangleCount))
+	{
+		sphereLods.push_back({ NarrowIndices(lod.mesh), lod.error });
+	}
+	const MeshPX skySphere = MeshBuilder::CreateSkySpherePX(100, 100, 1000.0f);
+
+	// all of them share VertexPX, so one pool holds ten planet lod chains and the sky
+	const uint32_t planetCount = (int)SolarSystem::Galaxy;
+	uint32_t vertexCapacity = static_cast<uint32_t>(skySphere.vertices.size());
+	uint32_t indexCapacity = static_cast<uint32_t>(skySphere.indices.size());
+	for (const MeshLod<ShortIndexMesh<VertexPX>>& lod : sphereLods)
+	{
+		vertexCapacity += static_cast<uint32_t>(lod.mesh.vertices.size()) * planetCount;
+		indexCapacity += static_cast<uint32_t>(lod.mesh.indices.size()) * planetCount;
+	}
+	mMeshPool.Initialize(sizeof(VertexPX), vertexCapacity, indexCapacity);
+
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Sun], sphereLods, 100.0f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Mercury], sphereLods, 0.38f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Venus], sphereLods, 0.95f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Earth], sphereLods, 1.0f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Mars], sphereLods, 0.53f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Jupiter], sphereLods, 10.97f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Saturn], sphereLods, 9.14f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Uranus], sphereLods, 3.98f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Neptune], sphereLods, 3.86f);
+	InitializeLods(mMeshPool, mObjects[(int)SolarSystem::Pluto], sphereLods, 0.18f);
+	{
+		TexturedObject& galaxy = mObjects[(int)SolarSystem::Galaxy];
+		galaxy.mLodMeshes = { mMeshPool.Add(NarrowIndices(skySphere)) };
+		galaxy.mLodErrors = { 0.0f };
+		galaxy.radius = 1000.0f;
+		galaxy.mMeshlets = MeshletBuilder::Build(skySphere);
+		galaxy.mCulledMeshBuffer.Initialize(skySphere.vertices.data(), sizeof(VertexPX), static_cast<uint32_t>(skySphere.vertices.size()), static_cast<const uint32_t*>(nullptr), static_cast<uint32_t>(skySphere.indices.size()));
+	}
+
+	// one transform per object per frame, with room for the frames still in flight
+	mConstantBuffer.Initialize(64 * ConstantBufferRing::ConstantAlignment);
+	for (CommandList& commandList : mCommandLists)
+	{
+		commandList.Initialize();
+	}
 
 	filesystem::path shaderFile = L"../../Assets/Shaders/DoTexture.fx";
 	mVertexShader.Initialize<VertexPX>(shaderFile);
@@ -86,6 +140,14 @@ void GameState::Initialize()
 	mObjects[(int)SolarSystem::Pluto].distanceFromSun = 1150;
 	mObjects[(int)SolarSystem::Galaxy].distanceFromSun = 0;
 
+	// the orbits never move, so they are handed to SimpleDraw once
+	mOrbitRingsId = SimpleDraw::BeginRetained();
+	for (int i = 1; i < (int)SolarSystem::Galaxy; i++)
+	{
+		SimpleDraw::AddGroundCircle(100, mObjects[i].distanceFromSun, { 0,0,0 }, Colors::Gray);
+	}
+	SimpleDraw::EndRetained();
+
 	// Set Revolutions (optimized orbit speeds)
 	mObjects[(int)SolarSystem::Sun].orbitSpeed = 0;
 	mObjects[(int)SolarSystem::Mercury].orbitSpeed = 47;
@@ -129,6 +191,7 @@ void GameState::Initialize()
 
 void GameState::Terminate()
 {
+	SimpleDraw::RemoveRetained(mOrbitRingsId);
 	mRenderTarget.Terminate();
 	mSampler.Terminate();
 
@@ -136,12 +199,23 @@ void GameState::Terminate()
 	mPixelShader.Terminate();
 	mVertexShader.Terminate();
 	mConstantBuffer.Terminate();
+	for (CommandList& commandList : mCommandLists)
+	{
+		commandList.Terminate();
+	}
 
-	for (int i = (int)SolarSystem::End - 1; i >= 0; i--){mObjects[i].mMeshBuffer.Terminate();}
+	for (int i = (int)SolarSystem::End - 1; i >= 0; i--)
+	{
+		mObjects[i].mCulledMeshBuffer.Terminate();
+		for (MeshPool::Mesh& mesh : mObjects[i].mLodMeshes)
+		{
+			mMeshPool.Remove(mesh);
+		}
+		mObjects[i].mLodMeshes.clear();
+	}
+	mMeshPool.Terminate();
 }
 
-float totalTime = 0.0f;
-
 void GameState::Update(float deltaTime)
 {
 	totalTime += deltaTime / 10.0f;
@@ -154,13 +228,11 @@ bool ringsToggle = true;
 
 void GameState::Render()
 {
+	mConstantBuffer.BeginFrame();
+
 	// Render Orbit Rings
 	if (ringsToggle)
 	{
-		for (int i = 1; i < (int)SolarSystem::Galaxy; i++)
-		{
-			SimpleDraw::AddGroundCircle(100, mObjects[i].distanceFromSun, { 0,0,0 }, Colors::Gray);
-		}
 		// Saturn Ring
 		{
 			Matrix4 ringWorldPosition = Matrix4::RotationY(mObjects[(int)SolarSystem::Saturn].rotationSpeed * totalTime) * Matrix4::Translation(Vector3::ZAxis * mObjects[(int)SolarSystem::Saturn].distanceFromSun) * Matrix4::RotationY(mObjects[(int)SolarSystem::Saturn].orbitSpeed * totalTime / 10.0f);
@@ -171,21 +243,43 @@ void GameState::Render()
 		SimpleDraw::Render(mCamera);
 	}
 
-	for (TexturedObject& object : mObjects)
+	// ring writes have to stay on the main thread, so every transform goes in up front
+	ConstantBufferRing::Allocation objectConstants[(int)SolarSystem::End];
+	const Matrix4 matViewProj = mCamera.GetViewMatrix() * mCamera.GetProjectionMatrix();
+	for (int i = 0; i < (int)SolarSystem::End; ++i)
 	{
-		mVertexShader.Bind();
-		mPixelShader.Bind();
-		object.mDiffuseTexture.BindPS(0);
-		mSampler.BindPS(0);
-
-		Matrix4 matWorld = Matrix4::RotationY(object.rotationSpeed * totalTime) * Matrix4::Translation(Vector3::ZAxis * object.distanceFromSun) * Matrix4::RotationY(object.orbitSpeed * totalTime / 10.0f);
-		Matrix4 matView = mCamera.GetViewMatrix();
-		Matrix4 matProj = mCamera.GetProjectionMatrix();
-		Matrix4 matFinal = matWorld * matView * matProj;
-		Matrix4 wvp = Transpose(matFinal);
-		mConstantBuffer.Update(&wvp);
-		mConstantBuffer.BindVS(0);
-		object.mMeshBuffer.Render();
+		objectConstants[i] = mConstantBuffer.Write(Transpose(GetWorldMatrix(mObjects[i]) * matViewProj));
+	}
+
+	if (mUseCommandLists)
+	{
+		for (CommandList& commandList : mCommandLists)
+		{
+			commandList.Begin();
+		}
+		Core::ParallelUtil::ParallelFor((int)SolarSystem::End, ObjectsPerCommandList, [&](uint32_t begin, uint32_t end)
+		{
+			mCommandLists[begin / ObjectsPerCommandList].Record([this, &objectConstants, begin, end]()
+			{
+				bool isPoolBound = false;
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					RenderObject(mObjects[i], objectConstants[i], isPoolBound);
+				}
+			});
+		});
+		for (CommandList& commandList : mCommandLists)
+		{
+			commandList.Execute();
+		}
+	}
+	else
+	{
+		bool isPoolBound = false;
+		for (int i = 0; i < (int)SolarSystem::End; ++i)
+		{
+			RenderObject(mObjects[i], objectConstants[i], isPoolBound);
+		}
 	}
 
 	mVertexShader.Bind();
@@ -198,14 +292,49 @@ void GameState::Render()
 	Matrix4 matProj = mRenderTargetCamera.GetProjectionMatrix();
 	Matrix4 matFinal = matWorld * matView * matProj;
 	Matrix4 wvp = Transpose(matFinal);
-	mConstantBuffer.Update(&wvp);
-	mConstantBuffer.BindVS(0);
+	mConstantBuffer.BindVS(mConstantBuffer.Write(wvp), 0);
 
 	mRenderTargetCamera.SetPosition({ 0.0f, 0.0f, mObjects[currentRenderTarget].renderTargetDistance });
 
 	mRenderTarget.BeginRender();
-	mObjects[currentRenderTarget].mMeshBuffer.Render();
+	mMeshPool.Bind();
+	mMeshPool.Render(mObjects[currentRenderTarget].mLodMeshes[0]);
 	mRenderTarget.EndRender();
+
+	mConstantBuffer.EndFrame();
+}
+
+void GameState::RenderObject(TexturedObject& object, const ConstantBufferRing::Allocation& constants, bool& isPoolBound)
+{
+	mVertexShader.Bind();
+	mPixelShader.Bind();
+	object.mDiffuseTexture.BindPS(0);
+	mSampler.BindPS(0);
+	mConstantBuffer.BindVS(constants, 0);
+
+	const Matrix4 matWorld = GetWorldMatrix(object);
+	if (!object.mMeshlets.meshlets.empty())
+	{
+		// mVisibleIndices is shared, fine while the sky is the only meshlet object
+		object.mCullStats = MeshletCuller::Cull(object.mMeshlets, matWorld, mCamera, mVisibleIndices);
+		object.mCulledMeshBuffer.UpdateIndices(mVisibleIndices.data(), static_cast<uint32_t>(mVisibleIndices.size()));
+		object.mCulledMeshBuffer.Render();
+		isPoolBound = false;
+		return;
+	}
+
+	const Vector3 objectPosition = { matWorld._41, matWorld._42, matWorld._43 };
+	const float distance = Magnitude(objectPosition - mCamera.GetPosition()) - object.radius;
+	const float screenScale = MeshSimplifier::GetScreenScale(distance, mCamera.GetFov(), static_cast<float>(GraphicsSystem::Get()->GetBackBufferHeight()));
+	object.mCurrentLod = MeshSimplifier::SelectLod(object.mLodErrors, screenScale);
+
+	// the shared buffers stay bound across objects, only the culled meshes switch them
+	if (!isPoolBound)
+	{
+		mMeshPool.Bind();
+		isPoolBound = true;
+	}
+	mMeshPool.Render(object.mLodMeshes[object.mCurrentLod]);
 }
 
 void GameState::DebugUI()
@@ -230,7 +359,22 @@ void GameState::DebugUI()
 	ImGui::DragFloat("OrbitSpeed", &mObjects[currentDrawType].orbitSpeed);
 	ImGui::DragFloat("RotationSpeed", &mObjects[currentDrawType].rotationSpeed);
 
+	const TexturedObject& selected = mObjects[currentDrawType];
+	if (selected.mMeshlets.meshlets.empty())
+	{
+		ImGui::Text("Lod: %u / %u", selected.mCurrentLod, static_cast<uint32_t>(selected.mLodErrors.size()) - 1);
+	}
+	else
+	{
+		ImGui::Text("Meshlets: %u / %u visible, %u / %u triangles", selected.mCullStats.visibleMeshlets, static_cast<uint32_t>(selected.mMeshlets.meshlets.size()), selected.mCullStats.visibleTriangles, selected.mMeshlets.GetTriangleCount());
+	}
+
 	ImGui::Checkbox("OrbitRings", &ringsToggle);
+	ImGui::Checkbox("MultithreadedSubmission", &mUseCommandLists);
+	if (mUseCommandLists && mCommandLists[0].GetMode() == CommandList::Mode::Replay)
+	{
+		ImGui::Text("No deferred contexts, lists are replayed on the main thread");
+	}
 	ImGui::End();
 }
 
@@ -20,11 +20,24 @@ enum class SolarSystem
 
 struct TexturedObject
 {
+	static constexpr size_t MinLodTriangleCount = 32;
+
 	SumEngine::Math::Matrix4 transform;
 
-	SumEngine::Graphics::MeshBuffer mMeshBuffer;
+	// lod 0 is the full 100x100 sphere, coarser levels are picked by screen size
+	std::vector<SumEngine::Graphics::MeshPool::Mesh> mLodMeshes;
+	std::vector<float> mLodErrors;
+	uint32_t mCurrentLod = 0;
+
+	// large meshes are drawn through per frame meshlet culling instead
+	SumEngine::Graphics::MeshletMesh mMeshlets;
+	SumEngine::Graphics::MeshBuffer mCulledMeshBuffer;
+	SumEngine::Graphics::MeshletCullStats mCullStats;
+
 	SumEngine::Graphics::Texture mDiffuseTexture;
 
+	float radius;
+
 	float orbitSpeed;
 	float rotationSpeed;
 	float distanceFromSun;
@@ -45,18 +58,26 @@ public:
 	void Update(float deltaTime);
 
 protected:
+	static constexpr uint32_t ObjectsPerCommandList = 3;
+	static constexpr uint32_t CommandListCount = ((int)SolarSystem::End + ObjectsPerCommandList - 1) / ObjectsPerCommandList;
+
 	void UpdateCamera(float deltaTime);
+	void RenderObject(TexturedObject& object, const SumEngine::Graphics::ConstantBufferRing::Allocation& constants, bool& isPoolBound);
 
 	TexturedObject mObjects[(int)SolarSystem::End];
 	SumEngine::Graphics::Camera mCamera;
 	SumEngine::Graphics::Camera mRenderTargetCamera;
-	SumEngine::Graphics::ConstantBuffer mConstantBuffer;
-	SumEngine::Graphics::MeshBuffer mMeshBuffer;
+	SumEngine::Graphics::ConstantBufferRing mConstantBuffer;
+	SumEngine::Graphics::MeshPool mMeshPool;	// every lod of every object
+	SumEngine::Graphics::CommandList mCommandLists[CommandListCount];
+	bool mUseCommandLists = false;
 	SumEngine::Graphics::VertexShader mVertexShader;
 	SumEngine::Graphics::PixelShader mPixelShader;
 	SumEngine::Graphics::Texture mDiffuseTexture;
 	SumEngine::Graphics::Sampler mSampler;
 	SumEngine::Graphics::RenderTarget mRenderTarget;
+	std::vector<uint32_t> mVisibleIndices;
+	SumEngine::Graphics::SimpleDraw::RetainedId mOrbitRingsId = SumEngine::Graphics::SimpleDraw::InvalidRetainedId;
 
 	SolarSystem mCurrentTarget = SolarSystem::Sun;
 
@@ -0,0 +1,111 @@
+#include "GameState.h"
+
+using namespace SumEngine;
+using namespace SumEngine::Math;
+using namespace SumEngine::Graphics;
+using namespace SumEngine::Core;
+using namespace SumEngine::Input;
+
+void GameState::Initialize()
+{
+	Terrain::Desc desc;
+	desc.cellSize = 2.0f;
+	desc.heightScale = 120.0f;
+	mTerrain.Initialize("../../Assets/Images/mountain/mountain_height.jpg", desc);
+
+	mCamera.SetPosition({ 0.0f, mTerrain.GetHeight(0.0f, -200.0f) + 40.0f, -200.0f });
+	mCamera.SetLookAt({ 0.0f, 0.0f, 0.0f });
+	mCamera.SetFarPlane(2000.0f);
+
+	mConstantBuffer.Initialize(sizeof(Matrix4));
+
+	std::filesystem::path shaderFile = L"../../Assets/Shaders/DoTexture.fx";
+	mVertexShader.Initialize<PackedVertexPXUNorm>(shaderFile);
+	mPixelShader.Initialize(shaderFile);
+
+	mDiffuseTexture.Initialize("../../Assets/Images/mountain/mountain_texture.jpg");
+	mSampler.Initialize(Sampler::Filter::Linear, Sampler::AddressMode::Wrap);
+}
+
+void GameState::Terminate()
+{
+	mSampler.Terminate();
+	mDiffuseTexture.Terminate();
+	mPixelShader.Terminate();
+	mVertexShader.Terminate();
+	mConstantBuffer.Terminate();
+	mTerrain.Terminate();
+}
+
+void GameState::UpdateCamera(float deltaTime)
+{
+	auto input = InputSystem::Get();
+	const float moveSpeed = (input->IsKeyDown(KeyCode::LSHIFT) ? 100.0f : 20.0f) * deltaTime;
+	const float turnSpeed = 0.1f * deltaTime;
+	if (input->IsKeyDown(KeyCode::W))
+	{
+		mCamera.Walk(moveSpeed);
+	}
+	else if (input->IsKeyDown(KeyCode::S))
+	{
+		mCamera.Walk(-moveSpeed);
+	}
+	if (input->IsKeyDown(KeyCode::D))
+	{
+		mCamera.Strafe(moveSpeed);
+	}
+	else if (input->IsKeyDown(KeyCode::A))
+	{
+		mCamera.Strafe(-moveSpeed);
+	}
+	if (input->IsKeyDown(KeyCode::E))
+	{
+		mCamera.Rise(moveSpeed);
+	}
+	else if (input->IsKeyDown(KeyCode::Q))
+	{
+		mCamera.Rise(-moveSpeed);
+	}
+	if (input->IsMouseDown(MouseButton::RBUTTON))
+	{
+		mCamera.Yaw(input->GetMouseMoveX() * turnSpeed);
+		mCamera.Pitch(input->GetMouseMoveY() * turnSpeed);
+	}
+}
+
+void GameState::Update(float deltaTime)
+{
+	UpdateCamera(deltaTime);
+
+	if (!mFreezeTerrain)
+	{
+		mTerrain.Update(mCamera);
+	}
+}
+
+void GameState::Render()
+{
+	mVertexShader.Bind();
+	mPixelShader.Bind();
+
+	mDiffuseTexture.BindPS(0);
+	mSampler.BindPS(0);
+
+	// the terrain is built in world space
+	Matrix4 matView = mCamera.GetViewMatrix();
+	Matrix4 matProj = mCamera.GetProjectionMatrix();
+	Matrix4 wvp = Transpose(matView * matProj);
+	mConstantBuffer.Update(&wvp);
+	mConstantBuffer.BindVS(0);
+
+	mTerrain.Render();
+}
+
+void GameState::DebugUI()
+{
+	ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+	ImGui::Text("Chunks: %u drawn / %u resident / %u total", mTerrain.GetVisibleChunkCount(), mTerrain.GetResidentChunkCount(), mTerrain.GetChunkCount());
+	ImGui::Text("Triangles: %u", mTerrain.GetTriangleCount());
+	ImGui::Checkbox("FreezeTerrain", &mFreezeTerrain);
+	ImGui::End();
+}
\ No newline at end of file
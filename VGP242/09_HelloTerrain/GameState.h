@@ -0,0 +1,27 @@
+#pragma once
+
+#include <SumEngine/Inc/SumEngine.h>
+
+class GameState : public SumEngine::AppState
+{
+public:
+	void Initialize() override;
+	void Terminate() override;
+	void Update(float deltaTime) override;
+	void Render() override;
+	void DebugUI() override;
+
+protected:
+	void UpdateCamera(float deltaTime);
+
+	SumEngine::Graphics::Camera mCamera;
+	SumEngine::Graphics::ConstantBuffer mConstantBuffer;
+	SumEngine::Graphics::VertexShader mVertexShader;
+	SumEngine::Graphics::PixelShader mPixelShader;
+	SumEngine::Graphics::Texture mDiffuseTexture;
+	SumEngine::Graphics::Sampler mSampler;
+	SumEngine::Graphics::Terrain mTerrain;
+
+	// keeps the last streamed and culled set so the culling can be inspected from outside
+	bool mFreezeTerrain = false;
+};
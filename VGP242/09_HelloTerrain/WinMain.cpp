@@ -0,0 +1,15 @@
+#include <SumEngine/Inc/SumEngine.h>
+#include "GameState.h"
+
+using namespace SumEngine;
+
+int WINAPI WinMain(HINSTANCE instance, HINSTANCE, LPSTR, int)
+{
+	AppConfig config;
+	config.appname = L"Hello Terrain";
+
+	App& myApp = MainApp();
+	myApp.AddState<GameState>("Terrain");
+	myApp.Run(config);
+	return(0);
+}
\ No newline at end of file